@@ -2,6 +2,7 @@ import json
 from airium import Airium
 from itertools import groupby
 import shutil
+import math
 
 a = Airium(
     base_indent='  ',  # str
@@ -12,6 +13,10 @@ a = Airium(
 
 cpp_start_file="void apply_audio_parameter(int adress, int value) {\r\n    switch(adress){\r\n"
 cpp_end_file="  }\r\n}"
+modulatable_start_file="\r\n\r\nbool is_modulatable(int adress) {\r\n    switch(adress){\r\n"
+modulatable_end_file="        return true;\r\n      default:\r\n        return false;\r\n  }\r\n}"
+modulation_range_start_file="\r\n\r\nint constrain_modulated(int adress, int value) {\r\n    switch(adress){\r\n"
+modulation_range_end_file="      default:\r\n        return value;\r\n  }\r\n}"
 id_iterator=0
 
 #Making the HTML file
@@ -342,7 +347,63 @@ with open('parameters.json') as f:
         else:
             print("Missing chord parameters in JSON")
         cpp_output.write(cpp_end_file)
+        #the adresses that the modulation routes can move, the continuous parameters that are cheap to apply at loop rate
+        cpp_output.write(modulatable_start_file)
+        for group in ["global_parameter","harp_parameter","chord_parameter"]:
+            try:
+                for parameter in d.get(group,[]):
+                    if parameter["modulatable"]:
+                        cpp_output.write("      case "+str(parameter["sysex_adress"])+":\r\n")
+            except KeyError:
+                print("Missing entry parameter in the JSON item : ")
+                print(parameter)
+        cpp_output.write(modulatable_end_file)
+        #the range of each of these adresses, as stored in current_sysex_parameters, that a route must not move them out of
+        cpp_output.write(modulation_range_start_file)
+        for group in ["global_parameter","harp_parameter","chord_parameter"]:
+            try:
+                for parameter in d.get(group,[]):
+                    if parameter["modulatable"]:
+                        scale=100 if parameter["data_type"]=="float" else 1
+                        cpp_output.write("      case "+str(parameter["sysex_adress"])+":\r\n")
+                        cpp_output.write("        return constrain(value, "+str(round(parameter["min_value"]*scale))+", "+str(round(parameter["max_value"]*scale))+");\r\n")
+            except KeyError:
+                print("Missing entry parameter in the JSON item : ")
+                print(parameter)
+        cpp_output.write(modulation_range_end_file)
 
     # Copy the parameters.json file to the ../minicontrol/json folder
     destination_folder = "../minicontrol/json"
     shutil.copy('parameters.json', destination_folder)
+
+#Making the factory presets table, kept in flash with PROGMEM (plain const data is copied to RAM on the Teensy 4)
+
+with open('factory_presets.json') as f:
+    d = json.load(f)
+    with open('../include/factory_presets.h', 'w') as cpp_output:
+        presets = d["factory_presets"]
+        cpp_output.write("// generated from generator/factory_presets.json, edit the json and run generate.py\r\n")
+        cpp_output.write("PROGMEM const int16_t factory_bank_sysex_parameters["+str(len(presets))+"]["+str(len(presets[0]))+"] = {\r\n")
+        for preset in presets:
+            cpp_output.write("  {"+",".join(str(value) for value in preset)+"},\r\n")
+        cpp_output.write("};\r\n")
+
+#Making the waveshaper tables, one per crunch type: the input sine folded crunch type more times through sin(x*pi)
+#values as converted by AudioEffectWaveshaper::shape(), the firmware switches between them without computation
+
+with open('parameters.json') as f:
+    d = json.load(f)
+    crunch_types = [parameter["max_value"] for parameter in d["harp_parameter"] + d["chord_parameter"] if parameter["name"] == "crunch type"]
+    with open('../include/waveshaper_tables.h', 'w') as cpp_output:
+        cpp_output.write("// generated by generate.py from the crunch type range of generator/parameters.json\r\n")
+        cpp_output.write("#define WAVESHAPER_TABLE_COUNT "+str(max(crunch_types)+1)+"\r\n")
+        cpp_output.write("PROGMEM const int16_t waveshaper_tables["+str(max(crunch_types)+1)+"][257] = {\r\n")
+        for crunch_type in range(max(crunch_types)+1):
+            table = []
+            for i in range(257):
+                value = math.sin((i/256.0-0.5)*2.0*math.pi)
+                for j in range(crunch_type):
+                    value = math.sin(value*math.pi)
+                table.append(int(32767*value))
+            cpp_output.write("  {"+",".join(str(value) for value in table)+"},\r\n")
+        cpp_output.write("};\r\n")
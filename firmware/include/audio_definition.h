@@ -3,27 +3,42 @@
 #include <SPI.h>
 #include <SD.h>
 #include <SerialFlash.h>
+// SYNTH_FUSED_VOICES runs each chord voice and all the harp strings as single fused objects in place of the library objects
+// they are to be checked against the library with the library_equivalence target of test/host before becoming the default
+#ifdef SYNTH_FUSED_VOICES
+#include "chord_voice.h"
+#include "harp_string_bank.h"
+#endif
+#include "audio_pool_probe.h"
+#include "audio_latency_probe.h"
+#include "table_waveshaper.h"
+#include "feedback_delay.h"
+#include "section_filter.h"
+#include "wide_mixer.h"
+#include "stereo_bus.h"
+#include "modulation_matrix.h"
 
 // GUItool: begin automatically generated code
+audio_pool_probe         pool_probe_start("update start"); // first object, sees the blocks held between updates
+#ifdef AUDIO_LATENCY_BENCHMARK
+audio_latency_probe      latency_probe;  // before the output stage, which it receives at the start of the next update
+#endif
+modulation_matrix        modulation;     // all the LFOs, evaluated once per block
+control_lfo              &chords_vibrato_lfo = modulation.lfo[0];
+control_lfo              &chords_filter_LFO = modulation.lfo[1];
+control_lfo              &chords_tremolo_lfo = modulation.lfo[2];
+control_lfo              &string_vibrato_lfo = modulation.lfo[3];
+control_lfo              &string_tremolo_lfo = modulation.lfo[4];
+control_lfo              &string_filter_lfo = modulation.lfo[5];
 AudioSynthWaveformDc     string_vibrato_dc; //xy=228.10000610351562,909.9999923706055
-AudioSynthWaveform       string_vibrato_lfo; //xy=240.10000610351562,842.9999923706055
 AudioEffectEnvelope      envelope_string_vibrato_dc; //xy=394.1000061035156,945.9999923706055
 AudioEffectEnvelope      envelope_string_vibrato_lfo; //xy=419.1000061035156,886.9999923706055
 AudioSynthWaveformDc     chords_vibrato_dc; //xy=470.1000061035156,1584.9999923706055
-AudioSynthWaveform       chords_vibrato_lfo; //xy=473.1000061035156,1498.9999923706055
-AudioMixer4              string_vibrato_mixer; //xy=594.1000061035156,947.9999923706055
-AudioEffectEnvelope      voice4_vibrato_dc_envelope; //xy=679.1000061035156,2398.9999923706055
-AudioEffectEnvelope      voice3_vibrato_envelope; //xy=683.1000061035156,2068.9999923706055
-AudioEffectEnvelope      voice3_vibrato_dc_envelope; //xy=686.1000061035156,2153.9999923706055
-AudioSynthWaveformDc     voice3_frequency_dc;            //xy=691.2000122070312,2110.3997802734375
-AudioEffectEnvelope      voice4_vibrato_envelope; //xy=692.1000061035156,2332.9999923706055
-AudioSynthWaveformDc     voice4_frequency_dc;            //xy=693.2000122070312,2366.3997802734375
-AudioEffectEnvelope      voice2_vibrato_dc_envelope; //xy=701.1000061035156,1854.9999923706055
-AudioEffectEnvelope      voice2_vibrato_envelope; //xy=702.1000061035156,1780.9999923706055
-AudioSynthWaveformDc     voice2_frequency_dc;            //xy=707.2000122070312,1818.39990234375
-AudioEffectEnvelope      voice1_vibrato_envelope; //xy=716.1000061035156,1498.9999923706055
-AudioEffectEnvelope      voice1_vibrato_dc_envelope; //xy=716.1000061035156,1583.9999923706055
-AudioSynthWaveformDc     voice1_frequency_dc;            //xy=721.2000122070312,1538.39990234375
+wide_mixer<2>            string_vibrato_mixer; //xy=594.1000061035156,947.9999923706055
+AudioSynthWaveformDc     filter_dc;      //xy=806.1000061035156,567.9999923706055
+#ifdef SYNTH_FUSED_VOICES
+HarpStringBank           harp_strings;
+#else
 AudioSynthWaveformModulated waveform_string_4; //xy=780.1000061035156,1101.9999923706055
 AudioSynthWaveformModulated waveform_string_2; //xy=781.1000061035156,1033.9999923706055
 AudioSynthWaveformModulated waveform_string_5; //xy=781.1000061035156,1138.9999923706055
@@ -36,7 +51,6 @@ AudioSynthWaveformModulated waveform_string_8; //xy=782.1000061035156,1245.99999
 AudioSynthWaveformModulated waveform_string_1; //xy=783.1000061035156,998.9999923706055
 AudioSynthWaveformModulated waveform_string_9; //xy=783.1000061035156,1281.9999923706055
 AudioSynthWaveformModulated waveform_string_11; //xy=783.1000061035156,1351.9999923706055
-AudioSynthWaveformDc     filter_dc;      //xy=806.1000061035156,567.9999923706055
 AudioSynthWaveform       waveform_transient_9; //xy=822.1000061035156,410.99999237060547
 AudioSynthWaveform       waveform_transient_5; //xy=823.1000061035156,282.99999237060547
 AudioSynthWaveform       waveform_transient_6; //xy=823.1000061035156,315.99999237060547
@@ -49,10 +63,6 @@ AudioSynthWaveform       waveform_transient_8; //xy=825.1000061035156,378.999992
 AudioSynthWaveform       waveform_transient_11; //xy=826.1000061035156,469.99999237060547
 AudioSynthWaveform       waveform_transient_10; //xy=828.1000061035156,441.99999237060547
 AudioSynthWaveform       waveform_transient_12; //xy=829.1000061035156,501.99999237060547
-AudioMixer4              voice3_vibrato_mixer; //xy=908.1000061035156,2098.9999923706055
-AudioMixer4              voice4_vibrato_mixer; //xy=914.1000061035156,2341.9999923706055
-AudioMixer4              voice2_vibrato_mixer; //xy=939.1000061035156,1807.9999923706055
-AudioMixer4              voice1_vibrato_mixer; //xy=947.1000061035156,1518.9999923706055
 AudioEffectEnvelope      envelope_filter_2; //xy=998.1000061035156,598.9999923706055
 AudioEffectEnvelope      envelope_filter_3; //xy=998.1000061035156,628.9999923706055
 AudioEffectEnvelope      envelope_filter_5; //xy=998.1000061035156,690.9999923706055
@@ -89,6 +99,50 @@ AudioEffectEnvelope      envelope_transient_12; //xy=1052.1000061035156,498.9999
 AudioEffectEnvelope      envelope_transient_1; //xy=1055.1000061035156,151.99999237060547
 AudioEffectEnvelope      envelope_transient_2; //xy=1055.1000061035156,182.99999237060547
 AudioEffectEnvelope      envelope_transient_3; //xy=1055.1000061035156,214.99999237060547
+AudioFilterStateVariable filter_string_4; //xy=1240.1000061035156,1068.9999923706055
+AudioFilterStateVariable filter_string_5; //xy=1240.1000061035156,1114.9999923706055
+AudioFilterStateVariable filter_string_1; //xy=1241.1000061035156,933.9999923706055
+AudioFilterStateVariable filter_string_7; //xy=1240.1000061035156,1206.9999923706055
+AudioFilterStateVariable filter_string_2; //xy=1241.1000061035156,978.9999923706055
+AudioFilterStateVariable filter_string_8; //xy=1241.1000061035156,1253.9999923706055
+AudioFilterStateVariable filter_string_3; //xy=1242.1000061035156,1023.9999923706055
+AudioFilterStateVariable filter_string_6; //xy=1243.1000061035156,1163.9999923706055
+AudioFilterStateVariable filter_string_9; //xy=1243.1000061035156,1298.9999923706055
+AudioFilterStateVariable filter_string_11; //xy=1244.1000061035156,1390.9999923706055
+AudioFilterStateVariable filter_string_12; //xy=1244.1000061035156,1436.9999923706055
+AudioFilterStateVariable filter_string_10; //xy=1245.1000061035156,1343.9999923706055
+AudioMixer4              transient_mix_2; //xy=1272.1000061035156,272.99999237060547
+AudioMixer4              transient_mix_1; //xy=1273.1000061035156,175.99999237060547
+AudioMixer4              transient_mix_3; //xy=1278.1000061035156,374.99999237060547
+AudioMixer4              transient_full_mix; //xy=1502.1000061035156,244.99999237060547
+AudioMixer4              string_mix_3;   //xy=1498.1000061035156,1326.9999923706055
+AudioMixer4              string_mix_1;   //xy=1501.1000061035156,1014.9999923706055
+AudioMixer4              string_mix_2;   //xy=1515.1000061035156,1143.9999923706055
+AudioMixer4              all_string_mix; //xy=1715.1000061035156,1143.9999923706055
+#endif
+audio_pool_probe         pool_probe_strings("harp strings");
+#ifdef SYNTH_FUSED_VOICES
+ChordVoice               voice1;
+ChordVoice               voice2;
+ChordVoice               voice3;
+ChordVoice               voice4;
+#else
+AudioEffectEnvelope      voice4_vibrato_dc_envelope; //xy=679.1000061035156,2398.9999923706055
+AudioEffectEnvelope      voice3_vibrato_envelope; //xy=683.1000061035156,2068.9999923706055
+AudioEffectEnvelope      voice3_vibrato_dc_envelope; //xy=686.1000061035156,2153.9999923706055
+AudioSynthWaveformDc     voice3_frequency_dc;            //xy=691.2000122070312,2110.3997802734375
+AudioEffectEnvelope      voice4_vibrato_envelope; //xy=692.1000061035156,2332.9999923706055
+AudioSynthWaveformDc     voice4_frequency_dc;            //xy=693.2000122070312,2366.3997802734375
+AudioEffectEnvelope      voice2_vibrato_dc_envelope; //xy=701.1000061035156,1854.9999923706055
+AudioEffectEnvelope      voice2_vibrato_envelope; //xy=702.1000061035156,1780.9999923706055
+AudioSynthWaveformDc     voice2_frequency_dc;            //xy=707.2000122070312,1818.39990234375
+AudioEffectEnvelope      voice1_vibrato_envelope; //xy=716.1000061035156,1498.9999923706055
+AudioEffectEnvelope      voice1_vibrato_dc_envelope; //xy=716.1000061035156,1583.9999923706055
+AudioSynthWaveformDc     voice1_frequency_dc;            //xy=721.2000122070312,1538.39990234375
+AudioMixer4              voice3_vibrato_mixer; //xy=908.1000061035156,2098.9999923706055
+AudioMixer4              voice4_vibrato_mixer; //xy=914.1000061035156,2341.9999923706055
+AudioMixer4              voice2_vibrato_mixer; //xy=939.1000061035156,1807.9999923706055
+AudioMixer4              voice1_vibrato_mixer; //xy=947.1000061035156,1518.9999923706055
 AudioSynthNoiseWhite     voice3_noise;   //xy=1102.1000061035156,2167.9999923706055
 AudioSynthWaveformModulated voice3_osc3;    //xy=1105.1000061035156,2133.9999923706055
 AudioSynthNoiseWhite     voice4_noise;   //xy=1105.1000061035156,2444.9999923706055
@@ -97,7 +151,6 @@ AudioSynthWaveformModulated voice4_osc3;    //xy=1107.1000061035156,2407.9999923
 AudioSynthWaveformModulated voice3_osc1;    //xy=1111.1000061035156,2059.9999923706055
 AudioSynthWaveformModulated voice4_osc2;    //xy=1110.1000061035156,2370.9999923706055
 AudioSynthWaveformModulated voice4_osc1;    //xy=1112.1000061035156,2335.9999923706055
-AudioSynthWaveform       chords_filter_LFO; //xy=1125.1000061035156,1690.9999923706055
 AudioSynthNoiseWhite     voice2_noise;   //xy=1128.1000061035156,1890.9999923706055
 AudioSynthWaveformModulated voice2_osc3;    //xy=1130.1000061035156,1853.9999923706055
 AudioSynthWaveformModulated voice2_osc2;    //xy=1132.1000061035156,1817.9999923706055
@@ -106,21 +159,6 @@ AudioSynthNoiseWhite     voice1_noise;   //xy=1141.1000061035156,1608.9999923706
 AudioSynthWaveformModulated voice1_osc3;    //xy=1146.1000061035156,1572.9999923706055
 AudioSynthWaveformModulated voice1_osc1;    //xy=1147.1000061035156,1502.9999923706055
 AudioSynthWaveformModulated voice1_osc2;    //xy=1147.1000061035156,1537.9999923706055
-AudioFilterStateVariable filter_string_4; //xy=1240.1000061035156,1068.9999923706055
-AudioFilterStateVariable filter_string_5; //xy=1240.1000061035156,1114.9999923706055
-AudioFilterStateVariable filter_string_1; //xy=1241.1000061035156,933.9999923706055
-AudioFilterStateVariable filter_string_7; //xy=1240.1000061035156,1206.9999923706055
-AudioFilterStateVariable filter_string_2; //xy=1241.1000061035156,978.9999923706055
-AudioFilterStateVariable filter_string_8; //xy=1241.1000061035156,1253.9999923706055
-AudioFilterStateVariable filter_string_3; //xy=1242.1000061035156,1023.9999923706055
-AudioFilterStateVariable filter_string_6; //xy=1243.1000061035156,1163.9999923706055
-AudioFilterStateVariable filter_string_9; //xy=1243.1000061035156,1298.9999923706055
-AudioFilterStateVariable filter_string_11; //xy=1244.1000061035156,1390.9999923706055
-AudioFilterStateVariable filter_string_12; //xy=1244.1000061035156,1436.9999923706055
-AudioFilterStateVariable filter_string_10; //xy=1245.1000061035156,1343.9999923706055
-AudioMixer4              transient_mix_2; //xy=1272.1000061035156,272.99999237060547
-AudioMixer4              transient_mix_1; //xy=1273.1000061035156,175.99999237060547
-AudioMixer4              transient_mix_3; //xy=1278.1000061035156,374.99999237060547
 AudioEffectEnvelope      voice4_envelope_filter; //xy=1304.1000061035156,2510.9999923706055
 AudioMixer4              voice3_mixer;   //xy=1308.1000061035156,2091.9999923706055
 AudioMixer4              voice4_mixer;   //xy=1309.1000061035156,2354.9999923706055
@@ -129,16 +167,10 @@ AudioEffectEnvelope      voice3_envelope_filter; //xy=1312.1000061035156,2197.99
 AudioEffectEnvelope      voice2_envelope_filter; //xy=1328.1000061035156,1924.9999923706055
 AudioEffectEnvelope      voice1_envelope_filter; //xy=1330.1000061035156,1693.9999923706055
 AudioMixer4              voice1_mixer;   //xy=1332.1000061035156,1536.9999923706055
-AudioMixer4              transient_full_mix; //xy=1502.1000061035156,244.99999237060547
-AudioMixer4              string_mix_3;   //xy=1498.1000061035156,1326.9999923706055
-AudioMixer4              string_mix_1;   //xy=1501.1000061035156,1014.9999923706055
-AudioMixer4              string_mix_2;   //xy=1515.1000061035156,1143.9999923706055
-AudioSynthWaveform       chords_tremolo_lfo; //xy=1580.1000061035156,1694.9999923706055
 AudioFilterStateVariable voice4_filter;  //xy=1613.1000061035156,2358.9999923706055
 AudioFilterStateVariable voice2_filter;  //xy=1621.1000061035156,1811.9999923706055
 AudioFilterStateVariable voice3_filter;  //xy=1620.1000061035156,2087.9999923706055
 AudioFilterStateVariable voice1_filter;  //xy=1642.1000061035156,1543.9999923706055
-AudioMixer4              all_string_mix; //xy=1715.1000061035156,1143.9999923706055
 AudioEffectEnvelope      voice1_envelope; //xy=1798.1000061035156,1694.9999923706055
 AudioEffectEnvelope      voice3_envelope; //xy=1800.1000061035156,2225.9999923706055
 AudioEffectEnvelope      voice2_envelope; //xy=1803.1000061035156,1945.9999923706055
@@ -147,39 +179,82 @@ AudioEffectMultiply      voice2_tremolo_mult; //xy=1846.1000061035156,1807.99999
 AudioEffectMultiply      voice3_tremolo_mult; //xy=1848.1000061035156,2087.9999923706055
 AudioEffectMultiply      voice4_tremolo_mult; //xy=1851.1000061035156,2362.9999923706055
 AudioEffectMultiply      voice1_tremolo_mult; //xy=1856.1000061035156,1537.9999923706055
-AudioEffectWaveshaper    string_waveshape; //xy=1948.1000061035156,961.9999923706055
-AudioMixer4              string_waveshaper_mix; //xy=2000.1000061035156,1139.9999923706055
-AudioMixer4              chord_voice_mixer; //xy=2157.1000061035156,1558.9999923706055
-AudioFilterStateVariable filter_delay_strings; //xy=2184.1000061035156,927.9999923706055
-AudioEffectWaveshaper    chord_waveshape; //xy=2335.1000061035156,1454.9999923706055
-AudioMixer4              string_delay_mix; //xy=2366.1000061035156,1015.9999923706055
-AudioMixer4              chord_waveshaper_mix; //xy=2488.1000061035156,1539.9999923706055
-AudioSynthWaveform       string_tremolo_lfo; //xy=2523.1000061035156,1318.9999923706055
-AudioMixer4              strings_effect_mix; //xy=2570.1000061035156,1196.9999923706055
-AudioFilterStateVariable filter_delay_chords; //xy=2580.1000061035156,1414.9999923706055
-AudioEffectDelay         delay_strings;  //xy=2680.1000061035156,1026.9999923706055
-AudioSynthWaveform       string_filter_lfo; //xy=2776.1000061035156,1365.9999923706055
-AudioMixer4              chord_delay_mix; //xy=2780.1000061035156,1514.9999923706055
+#endif
+audio_pool_probe         pool_probe_chords("chord voices");
+table_waveshaper         string_waveshape; //xy=1948.1000061035156,961.9999923706055
+wide_mixer<2>            string_waveshaper_mix; //xy=2000.1000061035156,1139.9999923706055
+wide_mixer<4>            chord_voice_mixer; //xy=2157.1000061035156,1558.9999923706055
+table_waveshaper         chord_waveshape; //xy=2335.1000061035156,1454.9999923706055
+feedback_delay           delay_strings; //xy=2366.1000061035156,1015.9999923706055
+wide_mixer<2>            chord_waveshaper_mix; //xy=2488.1000061035156,1539.9999923706055
+wide_mixer<2>            strings_effect_mix; //xy=2570.1000061035156,1196.9999923706055
+feedback_delay           delay_chords; //xy=2780.1000061035156,1514.9999923706055
 AudioEffectMultiply      string_multiply; //xy=2797.1000061035156,1277.9999923706055
-AudioMixer4              chords_effect_mix; //xy=2928.1000061035156,1662.9999923706055
-AudioFilterStateVariable string_filter;  //xy=2995.1000061035156,1311.9999923706055
-AudioEffectDelay         delay_chords;   //xy=3078.1000061035156,1534.9999923706055
-AudioInputI2S            i2s1;           //xy=3183.1000061035156,1062.9999923706055
-AudioMixer4              string_filter_mixer; //xy=3200.1000061035156,1312.9999923706055
-AudioFilterStateVariable chords_main_filter; //xy=3246.1000061035156,1595.9999923706055
-AudioMixer4              chords_main_filter_mixer; //xy=3529.1000061035156,1610.9999923706055
+wide_mixer<2>            chords_effect_mix; //xy=2928.1000061035156,1662.9999923706055
+section_filter           string_filter;  //xy=2995.1000061035156,1311.9999923706055
+wide_mixer<3>            string_filter_mixer; //xy=3200.1000061035156,1312.9999923706055
+section_filter           chords_main_filter; //xy=3246.1000061035156,1595.9999923706055
+wide_mixer<3>            chords_main_filter_mixer; //xy=3529.1000061035156,1610.9999923706055
+audio_pool_probe         pool_probe_effects("effects and delays");
 AudioConnection          patchCord1(string_vibrato_dc, envelope_string_vibrato_dc);
-AudioConnection          patchCord2(string_vibrato_lfo, envelope_string_vibrato_lfo);
+AudioConnection          patchCord2(modulation, 3, envelope_string_vibrato_lfo, 0);
 AudioConnection          patchCord3(envelope_string_vibrato_dc, 0, string_vibrato_mixer, 1);
 AudioConnection          patchCord4(envelope_string_vibrato_lfo, 0, string_vibrato_mixer, 0);
+AudioConnection          patchCord186(string_waveshape, 0, string_waveshaper_mix, 1);
+AudioConnection          patchCord187(string_waveshaper_mix, 0, strings_effect_mix, 0);
+AudioConnection          patchCord188(string_waveshaper_mix, 0, delay_strings, 0);
+AudioConnection          patchCord189(chord_voice_mixer, chord_waveshape);
+AudioConnection          patchCord190(chord_voice_mixer, 0, chord_waveshaper_mix, 0);
+AudioConnection          patchCord194(chord_waveshape, 0, chord_waveshaper_mix, 1);
+AudioConnection          patchCord196(delay_strings, 0, strings_effect_mix, 1);
+AudioConnection          patchCord197(chord_waveshaper_mix, 0, delay_chords, 0);
+AudioConnection          patchCord198(chord_waveshaper_mix, 0, chords_effect_mix, 0);
+AudioConnection          patchCord199(modulation, 4, string_multiply, 1);
+AudioConnection          patchCord200(strings_effect_mix, 0, string_multiply, 0);
+AudioConnection          patchCord205(modulation, 5, string_filter, 1);
+AudioConnection          patchCord207(delay_chords, 0, chords_effect_mix, 1);
+AudioConnection          patchCord208(string_multiply, 0, string_filter, 0);
+AudioConnection          patchCord209(chords_effect_mix, 0, chords_main_filter, 0);
+AudioConnection          patchCord210(string_filter, 0, string_filter_mixer, 0);
+AudioConnection          patchCord211(string_filter, 1, string_filter_mixer, 1);
+AudioConnection          patchCord212(string_filter, 2, string_filter_mixer, 2);
+AudioConnection          patchCord214(chords_main_filter, 0, chords_main_filter_mixer, 0);
+AudioConnection          patchCord215(chords_main_filter, 1, chords_main_filter_mixer, 1);
+AudioConnection          patchCord216(chords_main_filter, 2, chords_main_filter_mixer, 2);
+#ifdef SYNTH_FUSED_VOICES
+AudioConnection          patchCord300(modulation, 0, voice1, 0);
+AudioConnection          patchCord301(chords_vibrato_dc, 0, voice1, 1);
+AudioConnection          patchCord302(modulation, 1, voice1, 2);
+AudioConnection          patchCord303(modulation, 2, voice1, 3);
+AudioConnection          patchCord304(voice1, 0, chord_voice_mixer, 0);
+AudioConnection          patchCord305(modulation, 0, voice2, 0);
+AudioConnection          patchCord306(chords_vibrato_dc, 0, voice2, 1);
+AudioConnection          patchCord307(modulation, 1, voice2, 2);
+AudioConnection          patchCord308(modulation, 2, voice2, 3);
+AudioConnection          patchCord309(voice2, 0, chord_voice_mixer, 1);
+AudioConnection          patchCord310(modulation, 0, voice3, 0);
+AudioConnection          patchCord311(chords_vibrato_dc, 0, voice3, 1);
+AudioConnection          patchCord312(modulation, 1, voice3, 2);
+AudioConnection          patchCord313(modulation, 2, voice3, 3);
+AudioConnection          patchCord314(voice3, 0, chord_voice_mixer, 2);
+AudioConnection          patchCord315(modulation, 0, voice4, 0);
+AudioConnection          patchCord316(chords_vibrato_dc, 0, voice4, 1);
+AudioConnection          patchCord317(modulation, 1, voice4, 2);
+AudioConnection          patchCord318(modulation, 2, voice4, 3);
+AudioConnection          patchCord319(voice4, 0, chord_voice_mixer, 3);
+AudioConnection          patchCord400(string_vibrato_mixer, 0, harp_strings, 0);
+AudioConnection          patchCord401(filter_dc, 0, harp_strings, 1);
+AudioConnection          patchCord176(harp_strings, string_waveshape);
+AudioConnection          patchCord177(harp_strings, 0, string_waveshaper_mix, 0);
+#else
 AudioConnection          patchCord5(chords_vibrato_dc, voice1_vibrato_dc_envelope);
 AudioConnection          patchCord6(chords_vibrato_dc, voice2_vibrato_dc_envelope);
 AudioConnection          patchCord7(chords_vibrato_dc, voice3_vibrato_dc_envelope);
 AudioConnection          patchCord8(chords_vibrato_dc, voice4_vibrato_dc_envelope);
-AudioConnection          patchCord9(chords_vibrato_lfo, voice1_vibrato_envelope);
-AudioConnection          patchCord10(chords_vibrato_lfo, voice2_vibrato_envelope);
-AudioConnection          patchCord11(chords_vibrato_lfo, voice3_vibrato_envelope);
-AudioConnection          patchCord12(chords_vibrato_lfo, voice4_vibrato_envelope);
+AudioConnection          patchCord9(modulation, 0, voice1_vibrato_envelope, 0);
+AudioConnection          patchCord10(modulation, 0, voice2_vibrato_envelope, 0);
+AudioConnection          patchCord11(modulation, 0, voice3_vibrato_envelope, 0);
+AudioConnection          patchCord12(modulation, 0, voice4_vibrato_envelope, 0);
 AudioConnection          patchCord13(string_vibrato_mixer, 0, waveform_string_1, 0);
 AudioConnection          patchCord14(string_vibrato_mixer, 0, waveform_string_2, 0);
 AudioConnection          patchCord15(string_vibrato_mixer, 0, waveform_string_3, 0);
@@ -296,10 +371,10 @@ AudioConnection          patchCord125(voice4_osc3, 0, voice4_mixer, 2);
 AudioConnection          patchCord126(voice3_osc1, 0, voice3_mixer, 0);
 AudioConnection          patchCord127(voice4_osc2, 0, voice4_mixer, 1);
 AudioConnection          patchCord128(voice4_osc1, 0, voice4_mixer, 0);
-AudioConnection          patchCord129(chords_filter_LFO, voice1_envelope_filter);
-AudioConnection          patchCord130(chords_filter_LFO, voice2_envelope_filter);
-AudioConnection          patchCord131(chords_filter_LFO, voice3_envelope_filter);
-AudioConnection          patchCord132(chords_filter_LFO, voice4_envelope_filter);
+AudioConnection          patchCord129(modulation, 1, voice1_envelope_filter, 0);
+AudioConnection          patchCord130(modulation, 1, voice2_envelope_filter, 0);
+AudioConnection          patchCord131(modulation, 1, voice3_envelope_filter, 0);
+AudioConnection          patchCord132(modulation, 1, voice4_envelope_filter, 0);
 AudioConnection          patchCord133(voice2_noise, 0, voice2_mixer, 3);
 AudioConnection          patchCord134(voice2_osc3, 0, voice2_mixer, 2);
 AudioConnection          patchCord135(voice2_osc2, 0, voice2_mixer, 1);
@@ -335,10 +410,10 @@ AudioConnection          patchCord164(transient_full_mix, 0, all_string_mix, 3);
 AudioConnection          patchCord165(string_mix_3, 0, all_string_mix, 2);
 AudioConnection          patchCord166(string_mix_1, 0, all_string_mix, 0);
 AudioConnection          patchCord167(string_mix_2, 0, all_string_mix, 1);
-AudioConnection          patchCord168(chords_tremolo_lfo, voice1_envelope);
-AudioConnection          patchCord169(chords_tremolo_lfo, voice2_envelope);
-AudioConnection          patchCord170(chords_tremolo_lfo, voice3_envelope);
-AudioConnection          patchCord171(chords_tremolo_lfo, voice4_envelope);
+AudioConnection          patchCord168(modulation, 2, voice1_envelope, 0);
+AudioConnection          patchCord169(modulation, 2, voice2_envelope, 0);
+AudioConnection          patchCord170(modulation, 2, voice3_envelope, 0);
+AudioConnection          patchCord171(modulation, 2, voice4_envelope, 0);
 AudioConnection          patchCord172(voice4_filter, 0, voice4_tremolo_mult, 0);
 AudioConnection          patchCord173(voice2_filter, 0, voice2_tremolo_mult, 0);
 AudioConnection          patchCord174(voice3_filter, 0, voice3_tremolo_mult, 0);
@@ -353,91 +428,32 @@ AudioConnection          patchCord182(voice2_tremolo_mult, 0, chord_voice_mixer,
 AudioConnection          patchCord183(voice3_tremolo_mult, 0, chord_voice_mixer, 2);
 AudioConnection          patchCord184(voice4_tremolo_mult, 0, chord_voice_mixer, 3);
 AudioConnection          patchCord185(voice1_tremolo_mult, 0, chord_voice_mixer, 0);
-AudioConnection          patchCord186(string_waveshape, 0, string_waveshaper_mix, 1);
-AudioConnection          patchCord187(string_waveshaper_mix, 0, strings_effect_mix, 0);
-AudioConnection          patchCord188(string_waveshaper_mix, 0, string_delay_mix, 0);
-AudioConnection          patchCord189(chord_voice_mixer, chord_waveshape);
-AudioConnection          patchCord190(chord_voice_mixer, 0, chord_waveshaper_mix, 0);
-AudioConnection          patchCord191(filter_delay_strings, 0, string_delay_mix, 1);
-AudioConnection          patchCord192(filter_delay_strings, 1, string_delay_mix, 2);
-AudioConnection          patchCord193(filter_delay_strings, 2, string_delay_mix, 3);
-AudioConnection          patchCord194(chord_waveshape, 0, chord_waveshaper_mix, 1);
-AudioConnection          patchCord195(string_delay_mix, delay_strings);
-AudioConnection          patchCord196(string_delay_mix, 0, strings_effect_mix, 1);
-AudioConnection          patchCord197(chord_waveshaper_mix, 0, chord_delay_mix, 0);
-AudioConnection          patchCord198(chord_waveshaper_mix, 0, chords_effect_mix, 0);
-AudioConnection          patchCord199(string_tremolo_lfo, 0, string_multiply, 1);
-AudioConnection          patchCord200(strings_effect_mix, 0, string_multiply, 0);
-AudioConnection          patchCord201(filter_delay_chords, 0, chord_delay_mix, 1);
-AudioConnection          patchCord202(filter_delay_chords, 1, chord_delay_mix, 2);
-AudioConnection          patchCord203(filter_delay_chords, 2, chord_delay_mix, 3);
-AudioConnection          patchCord204(delay_strings, 0, filter_delay_strings, 0);
-AudioConnection          patchCord205(string_filter_lfo, 0, string_filter, 1);
-AudioConnection          patchCord206(chord_delay_mix, delay_chords);
-AudioConnection          patchCord207(chord_delay_mix, 0, chords_effect_mix, 1);
-AudioConnection          patchCord208(string_multiply, 0, string_filter, 0);
-AudioConnection          patchCord209(chords_effect_mix, 0, chords_main_filter, 0);
-AudioConnection          patchCord210(string_filter, 0, string_filter_mixer, 0);
-AudioConnection          patchCord211(string_filter, 1, string_filter_mixer, 1);
-AudioConnection          patchCord212(string_filter, 2, string_filter_mixer, 2);
-AudioConnection          patchCord213(delay_chords, 0, filter_delay_chords, 0);
-AudioConnection          patchCord214(chords_main_filter, 0, chords_main_filter_mixer, 0);
-AudioConnection          patchCord215(chords_main_filter, 1, chords_main_filter_mixer, 1);
-AudioConnection          patchCord216(chords_main_filter, 2, chords_main_filter_mixer, 2);
+#endif
 // GUItool: end automatically generated code
 
 
 //MANUAL OUTPUT SECTION
 #include "effect_platervbstereo.h"
-AudioSynthWaveformDc     string_gain; 
-AudioEffectMultiply      string_multiplier;  
-AudioAmplifier           string_amplifier; 
-AudioSynthWaveformDc     string_l_stereo_gain;        
-AudioSynthWaveformDc     string_r_stereo_gain;        
-AudioEffectMultiply      string_l_stereo_multiply;  
-AudioEffectMultiply      string_r_stereo_multiply;  
-AudioSynthWaveformDc     chords_gain;        
-AudioEffectMultiply      chords_multiplier;  
-AudioAmplifier           chords_amplifier; 
-AudioSynthWaveformDc     chords_l_stereo_gain;        
-AudioSynthWaveformDc     chords_r_stereo_gain;        
-AudioEffectMultiply      chords_l_stereo_multiply;  
-AudioEffectMultiply      chords_r_stereo_multiply;  
-AudioMixer4              reverb_mixer;   
-AudioEffectPlateReverb   main_reverb;    
-AudioMixer4              stereo_l_mixer;        
-AudioMixer4              stereo_r_mixer;   
+#include "audio_monitor.h"
+AudioEffectPlateReverb   main_reverb;    // not connected, run by output_bus with its send and return in float
+stereo_bus               output_bus;     
+audio_pool_probe         pool_probe_mix("output mix and reverb");
 AudioOutputI2S           DAC_out;    
 AudioOutputUSB           USB_out;      
+audio_monitor            output_monitor; // last object so that it is updated after all the others
 
-AudioConnection          patchCord2000(string_filter_mixer, 0, string_multiplier, 0);
-AudioConnection          patchCord2001(string_gain, 0, string_multiplier, 1);
-AudioConnection          patchCord2002(string_multiplier, 0, string_amplifier, 0);
-AudioConnection          patchCord2003(string_amplifier, 0, string_l_stereo_multiply, 0);
-AudioConnection          patchCord2004(string_l_stereo_gain, 0, string_l_stereo_multiply, 1);
-AudioConnection          patchCord2005(string_amplifier, 0, string_r_stereo_multiply, 0);
-AudioConnection          patchCord2006(string_r_stereo_gain, 0, string_r_stereo_multiply, 1);
-AudioConnection          patchCord2007(string_r_stereo_multiply, 0, stereo_r_mixer, 0);
-AudioConnection          patchCord2008(string_l_stereo_multiply, 0, stereo_l_mixer, 0);
-AudioConnection          patchCord2009(string_amplifier, 0, reverb_mixer, 0);
+AudioConnection          patchCord2000(string_filter_mixer, 0, output_bus, 0);
+AudioConnection          patchCord2010(chords_main_filter_mixer, 0, output_bus, 1);
 
-AudioConnection          patchCord2010(chords_main_filter_mixer, 0, chords_multiplier, 0);
-AudioConnection          patchCord2011(chords_gain, 0, chords_multiplier, 1);
-AudioConnection          patchCord2012(chords_multiplier, 0, chords_amplifier, 0);
-AudioConnection          patchCord2013(chords_amplifier, 0, chords_l_stereo_multiply, 0);
-AudioConnection          patchCord2014(chords_l_stereo_gain, 0, chords_l_stereo_multiply, 1);
-AudioConnection          patchCord2015(chords_amplifier, 0, chords_r_stereo_multiply, 0);
-AudioConnection          patchCord2016(chords_r_stereo_gain, 0, chords_r_stereo_multiply, 1);
-AudioConnection          patchCord2017(chords_r_stereo_multiply, 0, stereo_r_mixer, 1);
-AudioConnection          patchCord2018(chords_l_stereo_multiply, 0, stereo_l_mixer, 1);
-AudioConnection          patchCord2019(chords_amplifier, 0, reverb_mixer, 1);
+AudioConnection          patchCord2023(output_bus, 0, DAC_out, 1);
+AudioConnection          patchCord2024(output_bus, 1, DAC_out, 0);
 
-AudioConnection          patchCord2020(reverb_mixer, 0, main_reverb, 0);
-AudioConnection          patchCord2021(main_reverb, 0, stereo_r_mixer, 2);
-AudioConnection          patchCord2022(main_reverb, 1, stereo_l_mixer, 2);
+AudioConnection          patchCord2025(output_bus, 0, USB_out, 1);
+AudioConnection          patchCord2026(output_bus, 1, USB_out, 0);
 
-AudioConnection          patchCord2023(stereo_l_mixer, 0, DAC_out, 1);
-AudioConnection          patchCord2024(stereo_r_mixer, 0, DAC_out, 0);
+AudioConnection          patchCord2027(output_bus, 0, output_monitor, 0);
+AudioConnection          patchCord2028(output_bus, 1, output_monitor, 1);
 
-AudioConnection          patchCord2025(stereo_l_mixer, 0, USB_out, 1);
-AudioConnection          patchCord2026(stereo_r_mixer, 0, USB_out, 0);
+#ifdef AUDIO_LATENCY_BENCHMARK
+AudioConnection          patchCord2029(output_bus, 0, latency_probe, 0);
+#endif
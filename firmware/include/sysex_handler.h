@@ -54,6 +54,9 @@ void apply_audio_parameter(int adress, int value) {
       case 28:
         main_reverb.diffusion(value/100.0);
         break;
+      case 36:
+        main_reverb.economy(value);
+        break;
       case 29:
         pan=value/100.0;apply_audio_parameter(85, current_sysex_parameters[85]);apply_audio_parameter(184, current_sysex_parameters[184]);
         break;
@@ -81,6 +84,42 @@ void apply_audio_parameter(int adress, int value) {
       case 17:
         mod_pot.set_alternate_range(value);
         break;
+      case 236:
+        modulation.route_source(0,value);
+        break;
+      case 237:
+        modulation.route_destination(0,value);
+        break;
+      case 238:
+        modulation.route_depth(0,value/100.0);
+        break;
+      case 239:
+        modulation.route_source(1,value);
+        break;
+      case 240:
+        modulation.route_destination(1,value);
+        break;
+      case 241:
+        modulation.route_depth(1,value/100.0);
+        break;
+      case 242:
+        modulation.route_source(2,value);
+        break;
+      case 243:
+        modulation.route_destination(2,value);
+        break;
+      case 244:
+        modulation.route_depth(2,value/100.0);
+        break;
+      case 245:
+        modulation.route_source(3,value);
+        break;
+      case 246:
+        modulation.route_destination(3,value);
+        break;
+      case 247:
+        modulation.route_depth(3,value/100.0);
+        break;
       case 4:
         chord_pot.set_alternate_default(value);chord_pot.force_update();
         break;
@@ -94,7 +133,7 @@ void apply_audio_parameter(int adress, int value) {
         current_sysex_parameters[7]=version_ID;
         break;
       case 2:
-        string_gain.amplitude(value/100.0,100);  harp_attack_velocity=value/100.0*127;
+        output_bus.string_gain.amplitude(value/100.0,100);  harp_attack_velocity=value/100.0*127;
         break;
       case 99:
         for (int i=0;i<12;i++){
@@ -280,37 +319,37 @@ void apply_audio_parameter(int adress, int value) {
         }
         break;
       case 77:
-        delay_strings.delay(0,value);
+        delay_strings.delay(value);
         break;
       case 78:
-        filter_delay_strings.frequency(value);
+        delay_strings.filter.frequency(value);
         break;
       case 79:
-        filter_delay_strings.resonance(value/100.0);
+        delay_strings.filter.resonance(value/100.0);
         break;
       case 80:
-        string_delay_mix.gain(1,value/100.0);
+        delay_strings.mix.gain(1,value/100.0);
         break;
       case 81:
-        string_delay_mix.gain(2,value/100.0);
+        delay_strings.mix.gain(2,value/100.0);
         break;
       case 82:
-        string_delay_mix.gain(3,value/100.0);
+        delay_strings.mix.gain(3,value/100.0);
         break;
       case 83:
         strings_effect_mix.gain(0,value/100.0);
         break;
       case 84:
-        strings_effect_mix.gain(1,value/100.0);
+        AudioNoInterrupts();strings_effect_mix.gain(1,value/100.0);prune_audio_sections();AudioInterrupts();
         break;
       case 85:
-        reverb_mixer.gain(0,value/100.0);string_r_stereo_gain.amplitude((1-reverb_dry_proportion*value/100.0)*pan,100);string_l_stereo_gain.amplitude(1-reverb_dry_proportion*value/100.0,100);
+        output_bus.reverb_mixer.gain(0,value/100.0);output_bus.string_r_stereo_gain.amplitude((1-reverb_dry_proportion*value/100.0)*pan,100);output_bus.string_l_stereo_gain.amplitude(1-reverb_dry_proportion*value/100.0,100);
         break;
       case 86:
-        string_waveshaper_mix.gain(0,1-value/100.0);string_waveshaper_mix.gain(1,value/100.0);
+        AudioNoInterrupts();string_waveshaper_mix.gain(0,1-value/100.0);string_waveshaper_mix.gain(1,value/100.0);prune_audio_sections();AudioInterrupts();
         break;
       case 87:
-        ws_sin_param=value;calculate_ws_array(); string_waveshape.shape(wave_shape,257);
+        ws_sin_param=constrain(value,0,WAVESHAPER_TABLE_COUNT-1); string_waveshape.shape(waveshaper_tables[ws_sin_param]);
         break;
       case 88:
         string_filter.frequency(value);
@@ -319,13 +358,13 @@ void apply_audio_parameter(int adress, int value) {
         string_filter.resonance(value/100.0);
         break;
       case 90:
-        string_filter_mixer.gain(0,value/100.0);
+        AudioNoInterrupts();string_filter_mixer.gain(0,value/100.0);prune_audio_sections();AudioInterrupts();
         break;
       case 91:
-        string_filter_mixer.gain(1,value/100.0);
+        AudioNoInterrupts();string_filter_mixer.gain(1,value/100.0);prune_audio_sections();AudioInterrupts();
         break;
       case 92:
-        string_filter_mixer.gain(2,value/100.0);
+        AudioNoInterrupts();string_filter_mixer.gain(2,value/100.0);prune_audio_sections();AudioInterrupts();
         break;
       case 93:
         string_filter_lfo.begin(waveform_array[value]);
@@ -340,10 +379,10 @@ void apply_audio_parameter(int adress, int value) {
         string_filter.octaveControl(value/100.0);
         break;
       case 97:
-        string_amplifier.gain(value/100.0);
+        output_bus.string_amplifier.gain(value/100.0);
         break;
       case 3:
-        chords_gain.amplitude(value/100.0,100); chord_attack_velocity=value/100.0*127;
+        output_bus.chords_gain.amplitude(value/100.0,100); chord_attack_velocity=value/100.0*127;
         break;
       case 120:
         for (int i=0;i<7;i++){
@@ -598,37 +637,37 @@ void apply_audio_parameter(int adress, int value) {
         }
         break;
       case 176:
-        delay_chords.delay(0,value);
+        delay_chords.delay(value);
         break;
       case 177:
-        filter_delay_chords.frequency(value);
+        delay_chords.filter.frequency(value);
         break;
       case 178:
-        filter_delay_chords.resonance(value/100.0);
+        delay_chords.filter.resonance(value/100.0);
         break;
       case 179:
-        chord_delay_mix.gain(1,value/100.0);
+        delay_chords.mix.gain(1,value/100.0);
         break;
       case 180:
-        chord_delay_mix.gain(2,value/100.0);
+        delay_chords.mix.gain(2,value/100.0);
         break;
       case 181:
-        chord_delay_mix.gain(3,value/100.0);
+        delay_chords.mix.gain(3,value/100.0);
         break;
       case 182:
         chords_effect_mix.gain(0,value/100.0);
         break;
       case 183:
-        chords_effect_mix.gain(1,value/100.0);
+        AudioNoInterrupts();chords_effect_mix.gain(1,value/100.0);prune_audio_sections();AudioInterrupts();
         break;
       case 184:
-        reverb_mixer.gain(1,value/100.0);chords_r_stereo_gain.amplitude(1.0-reverb_dry_proportion*value/100.0,100);chords_l_stereo_gain.amplitude((1.0-reverb_dry_proportion*value/100.0)*pan,100);
+        output_bus.reverb_mixer.gain(1,value/100.0);output_bus.chords_r_stereo_gain.amplitude(1.0-reverb_dry_proportion*value/100.0,100);output_bus.chords_l_stereo_gain.amplitude((1.0-reverb_dry_proportion*value/100.0)*pan,100);
         break;
       case 185:
-        chord_waveshaper_mix.gain(0,1-value/100.0);chord_waveshaper_mix.gain(1,value/100.0);
+        AudioNoInterrupts();chord_waveshaper_mix.gain(0,1-value/100.0);chord_waveshaper_mix.gain(1,value/100.0);prune_audio_sections();AudioInterrupts();
         break;
       case 186:
-        ws_sin_param=value;calculate_ws_array(); chord_waveshape.shape(wave_shape,257);
+        ws_sin_param=constrain(value,0,WAVESHAPER_TABLE_COUNT-1); chord_waveshape.shape(waveshaper_tables[ws_sin_param]);
         break;
       case 187:
         rythm_bpm=value;recalculate_timer();
@@ -700,16 +739,466 @@ void apply_audio_parameter(int adress, int value) {
         chords_main_filter.resonance(value/100.0);
         break;
       case 194:
-        chords_main_filter_mixer.gain(0,value/100.0);
+        AudioNoInterrupts();chords_main_filter_mixer.gain(0,value/100.0);prune_audio_sections();AudioInterrupts();
         break;
       case 195:
-        chords_main_filter_mixer.gain(1,value/100.0);
+        AudioNoInterrupts();chords_main_filter_mixer.gain(1,value/100.0);prune_audio_sections();AudioInterrupts();
         break;
       case 196:
-        chords_main_filter_mixer.gain(2,value/100.0);
+        AudioNoInterrupts();chords_main_filter_mixer.gain(2,value/100.0);prune_audio_sections();AudioInterrupts();
         break;
       case 197:
-        chords_amplifier.gain(value/100.0);
+        output_bus.chords_amplifier.gain(value/100.0);
         break;
   }
+}
+
+bool is_modulatable(int adress) {
+    switch(adress){
+      case 24:
+      case 25:
+      case 26:
+      case 27:
+      case 28:
+      case 29:
+      case 10:
+      case 11:
+      case 12:
+      case 13:
+      case 14:
+      case 15:
+      case 16:
+      case 17:
+      case 4:
+      case 5:
+      case 6:
+      case 7:
+      case 2:
+      case 41:
+      case 43:
+      case 44:
+      case 45:
+      case 46:
+      case 47:
+      case 48:
+      case 49:
+      case 50:
+      case 51:
+      case 52:
+      case 53:
+      case 54:
+      case 55:
+      case 56:
+      case 57:
+      case 58:
+      case 101:
+      case 102:
+      case 103:
+      case 104:
+      case 60:
+      case 61:
+      case 63:
+      case 64:
+      case 65:
+      case 66:
+      case 67:
+      case 68:
+      case 69:
+      case 70:
+      case 71:
+      case 72:
+      case 73:
+      case 74:
+      case 75:
+      case 76:
+      case 77:
+      case 78:
+      case 79:
+      case 80:
+      case 81:
+      case 82:
+      case 83:
+      case 84:
+      case 85:
+      case 86:
+      case 88:
+      case 89:
+      case 90:
+      case 91:
+      case 92:
+      case 94:
+      case 95:
+      case 96:
+      case 97:
+      case 3:
+      case 199:
+      case 121:
+      case 123:
+      case 124:
+      case 126:
+      case 127:
+      case 129:
+      case 130:
+      case 131:
+      case 132:
+      case 133:
+      case 134:
+      case 135:
+      case 136:
+      case 137:
+      case 138:
+      case 139:
+      case 140:
+      case 141:
+      case 142:
+      case 143:
+      case 144:
+      case 145:
+      case 146:
+      case 147:
+      case 148:
+      case 149:
+      case 150:
+      case 151:
+      case 153:
+      case 154:
+      case 155:
+      case 157:
+      case 158:
+      case 159:
+      case 161:
+      case 162:
+      case 163:
+      case 164:
+      case 165:
+      case 166:
+      case 167:
+      case 168:
+      case 169:
+      case 170:
+      case 171:
+      case 172:
+      case 173:
+      case 174:
+      case 175:
+      case 176:
+      case 177:
+      case 178:
+      case 179:
+      case 180:
+      case 181:
+      case 182:
+      case 183:
+      case 184:
+      case 185:
+      case 187:
+      case 190:
+      case 191:
+      case 192:
+      case 193:
+      case 194:
+      case 195:
+      case 196:
+      case 197:
+        return true;
+      default:
+        return false;
+  }
+}
+
+int constrain_modulated(int adress, int value) {
+    switch(adress){
+      case 24:
+        return constrain(value, 0, 100);
+      case 25:
+        return constrain(value, 0, 100);
+      case 26:
+        return constrain(value, 0, 100);
+      case 27:
+        return constrain(value, 0, 100);
+      case 28:
+        return constrain(value, 0, 100);
+      case 29:
+        return constrain(value, 0, 100);
+      case 10:
+        return constrain(value, 21, 219);
+      case 11:
+        return constrain(value, 0, 100);
+      case 12:
+        return constrain(value, 21, 219);
+      case 13:
+        return constrain(value, 0, 100);
+      case 14:
+        return constrain(value, 21, 219);
+      case 15:
+        return constrain(value, 0, 100);
+      case 16:
+        return constrain(value, 21, 219);
+      case 17:
+        return constrain(value, 0, 100);
+      case 4:
+        return constrain(value, 0, 1024);
+      case 5:
+        return constrain(value, 0, 1024);
+      case 6:
+        return constrain(value, 0, 1024);
+      case 7:
+        return constrain(value, 0, 1000);
+      case 2:
+        return constrain(value, 0, 100);
+      case 41:
+        return constrain(value, 0, 100);
+      case 43:
+        return constrain(value, 0, 5000);
+      case 44:
+        return constrain(value, 0, 5000);
+      case 45:
+        return constrain(value, 0, 5000);
+      case 46:
+        return constrain(value, 0, 100);
+      case 47:
+        return constrain(value, 0, 5000);
+      case 48:
+        return constrain(value, 0, 10);
+      case 49:
+        return constrain(value, 0, 2000);
+      case 50:
+        return constrain(value, 0, 300);
+      case 51:
+        return constrain(value, 70, 500);
+      case 52:
+        return constrain(value, 0, 5000);
+      case 53:
+        return constrain(value, 0, 5000);
+      case 54:
+        return constrain(value, 0, 5000);
+      case 55:
+        return constrain(value, 0, 100);
+      case 56:
+        return constrain(value, 0, 5000);
+      case 57:
+        return constrain(value, 0, 100);
+      case 58:
+        return constrain(value, 0, 500);
+      case 101:
+        return constrain(value, 0, 100);
+      case 102:
+        return constrain(value, 0, 5000);
+      case 103:
+        return constrain(value, 0, 5000);
+      case 104:
+        return constrain(value, 0, 5000);
+      case 60:
+        return constrain(value, 0, 2000);
+      case 61:
+        return constrain(value, 0, 100);
+      case 63:
+        return constrain(value, 0, 2000);
+      case 64:
+        return constrain(value, 0, 100);
+      case 65:
+        return constrain(value, 0, 5000);
+      case 66:
+        return constrain(value, 0, 5000);
+      case 67:
+        return constrain(value, 0, 5000);
+      case 68:
+        return constrain(value, 0, 100);
+      case 69:
+        return constrain(value, 0, 5000);
+      case 70:
+        return constrain(value, 0, 100);
+      case 71:
+        return constrain(value, 0, 200);
+      case 72:
+        return constrain(value, 0, 5000);
+      case 73:
+        return constrain(value, 0, 5000);
+      case 74:
+        return constrain(value, 0, 5000);
+      case 75:
+        return constrain(value, 0, 5000);
+      case 76:
+        return constrain(value, 0, 100);
+      case 77:
+        return constrain(value, 0, 600);
+      case 78:
+        return constrain(value, 0, 5000);
+      case 79:
+        return constrain(value, 70, 500);
+      case 80:
+        return constrain(value, 0, 100);
+      case 81:
+        return constrain(value, 0, 100);
+      case 82:
+        return constrain(value, 0, 100);
+      case 83:
+        return constrain(value, 0, 100);
+      case 84:
+        return constrain(value, 0, 100);
+      case 85:
+        return constrain(value, 0, 100);
+      case 86:
+        return constrain(value, 0, 100);
+      case 88:
+        return constrain(value, 0, 5000);
+      case 89:
+        return constrain(value, 70, 500);
+      case 90:
+        return constrain(value, 0, 100);
+      case 91:
+        return constrain(value, 0, 100);
+      case 92:
+        return constrain(value, 0, 100);
+      case 94:
+        return constrain(value, 0, 2000);
+      case 95:
+        return constrain(value, 0, 100);
+      case 96:
+        return constrain(value, 0, 500);
+      case 97:
+        return constrain(value, 0, 200);
+      case 3:
+        return constrain(value, 0, 100);
+      case 199:
+        return constrain(value, 0, 1500);
+      case 121:
+        return constrain(value, 0, 100);
+      case 123:
+        return constrain(value, 50, 200);
+      case 124:
+        return constrain(value, 0, 100);
+      case 126:
+        return constrain(value, 50, 200);
+      case 127:
+        return constrain(value, 0, 100);
+      case 129:
+        return constrain(value, 50, 200);
+      case 130:
+        return constrain(value, 0, 100);
+      case 131:
+        return constrain(value, 0, 100);
+      case 132:
+        return constrain(value, 0, 100);
+      case 133:
+        return constrain(value, 0, 100);
+      case 134:
+        return constrain(value, 0, 100);
+      case 135:
+        return constrain(value, 0, 100);
+      case 136:
+        return constrain(value, 0, 100);
+      case 137:
+        return constrain(value, 0, 5000);
+      case 138:
+        return constrain(value, 0, 5000);
+      case 139:
+        return constrain(value, 0, 5000);
+      case 140:
+        return constrain(value, 0, 100);
+      case 141:
+        return constrain(value, 0, 5000);
+      case 142:
+        return constrain(value, 0, 100);
+      case 143:
+        return constrain(value, 0, 5000);
+      case 144:
+        return constrain(value, 0, 100);
+      case 145:
+        return constrain(value, 70, 500);
+      case 146:
+        return constrain(value, 0, 5000);
+      case 147:
+        return constrain(value, 0, 5000);
+      case 148:
+        return constrain(value, 0, 5000);
+      case 149:
+        return constrain(value, 0, 100);
+      case 150:
+        return constrain(value, 0, 5000);
+      case 151:
+        return constrain(value, 0, 100);
+      case 153:
+        return constrain(value, 0, 2000);
+      case 154:
+        return constrain(value, 0, 100);
+      case 155:
+        return constrain(value, 0, 500);
+      case 157:
+        return constrain(value, 0, 2000);
+      case 158:
+        return constrain(value, 0, 500);
+      case 159:
+        return constrain(value, 0, 100);
+      case 161:
+        return constrain(value, 0, 2000);
+      case 162:
+        return constrain(value, 0, 100);
+      case 163:
+        return constrain(value, 0, 100);
+      case 164:
+        return constrain(value, 0, 5000);
+      case 165:
+        return constrain(value, 0, 5000);
+      case 166:
+        return constrain(value, 0, 5000);
+      case 167:
+        return constrain(value, 0, 100);
+      case 168:
+        return constrain(value, 0, 5000);
+      case 169:
+        return constrain(value, 0, 100);
+      case 170:
+        return constrain(value, 0, 200);
+      case 171:
+        return constrain(value, 0, 5000);
+      case 172:
+        return constrain(value, 0, 5000);
+      case 173:
+        return constrain(value, 0, 5000);
+      case 174:
+        return constrain(value, 0, 100);
+      case 175:
+        return constrain(value, 0, 100);
+      case 176:
+        return constrain(value, 0, 600);
+      case 177:
+        return constrain(value, 0, 5000);
+      case 178:
+        return constrain(value, 70, 500);
+      case 179:
+        return constrain(value, 0, 100);
+      case 180:
+        return constrain(value, 0, 100);
+      case 181:
+        return constrain(value, 0, 100);
+      case 182:
+        return constrain(value, 0, 100);
+      case 183:
+        return constrain(value, 0, 100);
+      case 184:
+        return constrain(value, 0, 100);
+      case 185:
+        return constrain(value, 0, 100);
+      case 187:
+        return constrain(value, 30, 300);
+      case 190:
+        return constrain(value, 50, 150);
+      case 191:
+        return constrain(value, 20, 1000);
+      case 192:
+        return constrain(value, 0, 5000);
+      case 193:
+        return constrain(value, 70, 500);
+      case 194:
+        return constrain(value, 0, 100);
+      case 195:
+        return constrain(value, 0, 100);
+      case 196:
+        return constrain(value, 0, 100);
+      case 197:
+        return constrain(value, 0, 200);
+      default:
+        return value;
+  }
 }
\ No newline at end of file
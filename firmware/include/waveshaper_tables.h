@@ -0,0 +1,7 @@
+// generated by generate.py from the crunch type range of generator/parameters.json
+#define WAVESHAPER_TABLE_COUNT 3
+PROGMEM const int16_t waveshaper_tables[3][257] = {
+  {0,-804,-1607,-2410,-3211,-4011,-4807,-5601,-6392,-7179,-7961,-8739,-9511,-10278,-11038,-11792,-12539,-13278,-14009,-14732,-15446,-16150,-16845,-17530,-18204,-18867,-19519,-20159,-20787,-21402,-22004,-22594,-23169,-23731,-24278,-24811,-25329,-25831,-26318,-26789,-27244,-27683,-28105,-28510,-28897,-29268,-29621,-29955,-30272,-30571,-30851,-31113,-31356,-31580,-31785,-31970,-32137,-32284,-32412,-32520,-32609,-32678,-32727,-32757,-32767,-32757,-32727,-32678,-32609,-32520,-32412,-32284,-32137,-31970,-31785,-31580,-31356,-31113,-30851,-30571,-30272,-29955,-29621,-29268,-28897,-28510,-28105,-27683,-27244,-26789,-26318,-25831,-25329,-24811,-24278,-23731,-23169,-22594,-22004,-21402,-20787,-20159,-19519,-18867,-18204,-17530,-16845,-16150,-15446,-14732,-14009,-13278,-12539,-11792,-11038,-10278,-9511,-8739,-7961,-7179,-6392,-5601,-4807,-4011,-3211,-2410,-1607,-804,0,804,1607,2410,3211,4011,4807,5601,6392,7179,7961,8739,9511,10278,11038,11792,12539,13278,14009,14732,15446,16150,16845,17530,18204,18867,19519,20159,20787,21402,22004,22594,23169,23731,24278,24811,25329,25831,26318,26789,27244,27683,28105,28510,28897,29268,29621,29955,30272,30571,30851,31113,31356,31580,31785,31970,32137,32284,32412,32520,32609,32678,32727,32757,32767,32757,32727,32678,32609,32520,32412,32284,32137,31970,31785,31580,31356,31113,30851,30571,30272,29955,29621,29268,28897,28510,28105,27683,27244,26789,26318,25831,25329,24811,24278,23731,23169,22594,22004,21402,20787,20159,19519,18867,18204,17530,16845,16150,15446,14732,14009,13278,12539,11792,11038,10278,9511,8739,7961,7179,6392,5601,4807,4011,3211,2410,1607,804,0},
+  {0,-2523,-5031,-7505,-9931,-12292,-14575,-16764,-18848,-20815,-22653,-24353,-25908,-27312,-28558,-29643,-30566,-31325,-31922,-32357,-32634,-32758,-32734,-32569,-32268,-31842,-31297,-30643,-29889,-29045,-28121,-27127,-26072,-24966,-23818,-22639,-21435,-20217,-18991,-17766,-16549,-15345,-14162,-13005,-11878,-10786,-9734,-8724,-7761,-6846,-5983,-5173,-4419,-3720,-3080,-2498,-1976,-1514,-1113,-774,-495,-278,-123,-31,0,-31,-123,-278,-495,-774,-1113,-1514,-1976,-2498,-3080,-3720,-4419,-5173,-5983,-6846,-7761,-8724,-9734,-10786,-11878,-13005,-14162,-15345,-16549,-17766,-18991,-20217,-21435,-22639,-23818,-24966,-26072,-27127,-28121,-29045,-29889,-30643,-31297,-31842,-32268,-32569,-32734,-32758,-32634,-32357,-31922,-31325,-30566,-29643,-28558,-27312,-25908,-24353,-22653,-20815,-18848,-16764,-14575,-12292,-9931,-7505,-5031,-2523,0,2523,5031,7505,9931,12292,14575,16764,18848,20815,22653,24353,25908,27312,28558,29643,30566,31325,31922,32357,32634,32758,32734,32569,32268,31842,31297,30643,29889,29045,28121,27127,26072,24966,23818,22639,21435,20217,18991,17766,16549,15345,14162,13005,11878,10786,9734,8724,7761,6846,5983,5173,4419,3720,3080,2498,1976,1514,1113,774,495,278,123,31,0,31,123,278,495,774,1113,1514,1976,2498,3080,3720,4419,5173,5983,6846,7761,8724,9734,10786,11878,13005,14162,15345,16549,17766,18991,20217,21435,22639,23818,24966,26072,27127,28121,29045,29889,30643,31297,31842,32268,32569,32734,32758,32634,32357,31922,31325,30566,29643,28558,27312,25908,24353,22653,20815,18848,16764,14575,12292,9931,7505,5031,2523,0},
+  {0,-7851,-15199,-21596,-26694,-30278,-32275,-32745,-31855,-29853,-27023,-23656,-20025,-16366,-12866,-9665,-6861,-4513,-2651,-1286,-415,-25,-101,-621,-1564,-2901,-4602,-6625,-8925,-11443,-14115,-16866,-19616,-22284,-24787,-27048,-28997,-30578,-31747,-32479,-32762,-32605,-32027,-31063,-29757,-28161,-26330,-24323,-22194,-19998,-17784,-15595,-13471,-11443,-9537,-7775,-6173,-4742,-3492,-2429,-1556,-876,-389,-97,0,-97,-389,-876,-1556,-2429,-3492,-4742,-6173,-7775,-9537,-11443,-13471,-15595,-17784,-19998,-22194,-24323,-26330,-28161,-29757,-31063,-32027,-32605,-32762,-32479,-31747,-30578,-28997,-27048,-24787,-22284,-19616,-16866,-14115,-11443,-8925,-6625,-4602,-2901,-1564,-621,-101,-25,-415,-1286,-2651,-4513,-6861,-9665,-12866,-16366,-20025,-23656,-27023,-29853,-31855,-32745,-32275,-30278,-26694,-21596,-15199,-7851,0,7851,15199,21596,26694,30278,32275,32745,31855,29853,27023,23656,20025,16366,12866,9665,6861,4513,2651,1286,415,25,101,621,1564,2901,4602,6625,8925,11443,14115,16866,19616,22284,24787,27048,28997,30578,31747,32479,32762,32605,32027,31063,29757,28161,26330,24323,22194,19998,17784,15595,13471,11443,9537,7775,6173,4742,3492,2429,1556,876,389,97,0,97,389,876,1556,2429,3492,4742,6173,7775,9537,11443,13471,15595,17784,19998,22194,24323,26330,28161,29757,31063,32027,32605,32762,32479,31747,30578,28997,27048,24787,22284,19616,16866,14115,11443,8925,6625,4602,2901,1564,621,101,25,415,1286,2651,4513,6861,9665,12866,16366,20025,23656,27023,29853,31855,32745,32275,30278,26694,21596,15199,7851,0},
+};
@@ -50,54 +50,24 @@
 
 #define RV_MASTER_LOWPASS_F (0.6f)                           // master lowpass scaled frequency coeff. 
 
+#define RV_SLEEP_INPUT_PEAK (2)                             // input blocks with a peak below this are silent
+#define RV_SLEEP_LOOP_PEAK  (1.0f/131072.0f)                // loop samples below this give less than 1 LSB at the output
+#define RV_SLEEP_BLOCKS     (8192 / AUDIO_BLOCK_SAMPLES)    // 8192 samples, longer than the longest delay and allpass of the loop, about 190ms, at a size scale up to 1
+
 extern "C" {
 extern const int16_t AudioWaveformSine[257];
 }
 
-#ifdef REVERB_USE_DMAMEM
-
-float32_t DMAMEM input_blockL[AUDIO_BLOCK_SAMPLES];
-float32_t DMAMEM input_blockR[AUDIO_BLOCK_SAMPLES];
-
-float32_t DMAMEM in_allp1_bufL[224]; // input allpass buffers
-float32_t DMAMEM in_allp2_bufL[420];
-float32_t DMAMEM in_allp3_bufL[856];
-float32_t DMAMEM in_allp4_bufL[1089];
-
-float32_t DMAMEM in_allp1_bufR[156]; // input allpass buffers
-float32_t DMAMEM in_allp2_bufR[520];
-float32_t DMAMEM in_allp3_bufR[956];
-float32_t DMAMEM in_allp4_bufR[1289];
-
-float32_t DMAMEM lp_allp1_buf[2303]; // loop allpass buffers
-float32_t DMAMEM lp_allp2_buf[2905];
-float32_t DMAMEM lp_allp3_buf[3175];
-float32_t DMAMEM lp_allp4_buf[2398];
-
-float32_t DMAMEM lp_dly1_buf[3423];
-float32_t DMAMEM lp_dly2_buf[4589];
-float32_t DMAMEM lp_dly3_buf[4365];
-float32_t DMAMEM lp_dly4_buf[3698];
-#endif
-
 AudioEffectPlateReverb::AudioEffectPlateReverb() : AudioStream(2, inputQueueArray)
 {
     input_attn = 0.5f;
     in_allp_k = INP_ALLP_COEFF;
 
-    memset(in_allp1_bufL, 0, sizeof(in_allp1_bufL));
-	memset(in_allp2_bufL, 0, sizeof(in_allp2_bufL));
-	memset(in_allp3_bufL, 0, sizeof(in_allp3_bufL));
-	memset(in_allp4_bufL, 0, sizeof(in_allp4_bufL));
     in_allp1_idxL = 0;
     in_allp2_idxL = 0;
     in_allp3_idxL = 0;
     in_allp4_idxL = 0;
 
-    memset(in_allp1_bufR, 0, sizeof(in_allp1_bufR));
-	memset(in_allp2_bufR, 0, sizeof(in_allp2_bufR));
-	memset(in_allp3_bufR, 0, sizeof(in_allp3_bufR));
-	memset(in_allp4_bufR, 0, sizeof(in_allp4_bufR));
     in_allp1_idxR = 0;
     in_allp2_idxR = 0;
     in_allp3_idxR = 0;
@@ -105,10 +75,6 @@ AudioEffectPlateReverb::AudioEffectPlateReverb() : AudioStream(2, inputQueueArra
 
     in_allp_out_R = 0.0f;
 
-    memset(lp_allp1_buf, 0, sizeof(lp_allp1_buf));
-    memset(lp_allp2_buf, 0, sizeof(lp_allp2_buf));
-    memset(lp_allp3_buf, 0, sizeof(lp_allp3_buf));
-    memset(lp_allp4_buf, 0, sizeof(lp_allp4_buf));
     lp_allp1_idx = 0;
     lp_allp2_idx = 0;
     lp_allp3_idx = 0;
@@ -116,10 +82,6 @@ AudioEffectPlateReverb::AudioEffectPlateReverb() : AudioStream(2, inputQueueArra
     loop_allp_k = LOOP_ALLOP_COEFF;
     lp_allp_out = 0.0f;
 
-    memset(lp_dly1_buf, 0, sizeof(lp_dly1_buf));
-    memset(lp_dly2_buf, 0, sizeof(lp_dly2_buf));
-    memset(lp_dly3_buf, 0, sizeof(lp_dly3_buf));
-    memset(lp_dly4_buf, 0, sizeof(lp_dly4_buf));
     lp_dly1_idx = 0;
     lp_dly2_idx = 0;
     lp_dly3_idx = 0;
@@ -146,116 +108,556 @@ AudioEffectPlateReverb::AudioEffectPlateReverb() : AudioStream(2, inputQueueArra
     master_lowpass_r = 0.0f;
 
     lfo1_phase_acc = 0;
-    lfo1_adder = (UINT32_MAX + 1)/(AUDIO_SAMPLE_RATE_EXACT * LFO1_FREQ_HZ);
+    lfo1_adder = 4294967296.0 / (AUDIO_SAMPLE_RATE_EXACT * LFO1_FREQ_HZ); // 2^32 in double, (UINT32_MAX + 1) wrapped to 0 and froze the LFOs
     lfo2_phase_acc = 0;
-    lfo2_adder = (UINT32_MAX + 1)/(AUDIO_SAMPLE_RATE_EXACT * LFO2_FREQ_HZ);  
+    lfo2_adder = 4294967296.0 / (AUDIO_SAMPLE_RATE_EXACT * LFO2_FREQ_HZ);
+}
+
+// tap offsets of the loop delays at a size scale of 1, L then R
+static const uint16_t tap_offsets[8] = {201, 145, 1897, 280, 1897, 1245, 487, 780};
+
+// scale the lines and carve them from the arena, they are cleared before the reverb starts using them
+size_t AudioEffectPlateReverb::begin(void *arena, size_t arena_size, float scale)
+{
+    if (!(scale >= min_scale && scale <= max_scale)) return 0;
+#ifndef REVERB_REFERENCE_KERNEL
+    // the stage by stage kernel needs every tap to read more than a block ahead of the write index, LFO included
+    for (uint16_t offset : tap_offsets)
+    {
+        if (scaled_len(offset, scale) < AUDIO_BLOCK_SAMPLES + LFO_READ_OFFSET) return 0;
+    }
+#endif
+    uintptr_t start = ((uintptr_t)arena + alignof(reverb_sample_t) - 1) & ~(uintptr_t)(alignof(reverb_sample_t) - 1);
+    size_t used = start - (uintptr_t)arena + memory_size(scale);
+    if (!arena || used > arena_size) return 0;
+    reverb_sample_t *p = (reverb_sample_t *)start;
+    __disable_irq();
+    in_allp1_lenL = scaled_len(line_lengths[0], scale);
+    in_allp2_lenL = scaled_len(line_lengths[1], scale);
+    in_allp3_lenL = scaled_len(line_lengths[2], scale);
+    in_allp4_lenL = scaled_len(line_lengths[3], scale);
+    in_allp1_lenR = scaled_len(line_lengths[4], scale);
+    in_allp2_lenR = scaled_len(line_lengths[5], scale);
+    in_allp3_lenR = scaled_len(line_lengths[6], scale);
+    in_allp4_lenR = scaled_len(line_lengths[7], scale);
+    lp_allp1_len = scaled_len(line_lengths[8], scale);
+    lp_allp2_len = scaled_len(line_lengths[9], scale);
+    lp_allp3_len = scaled_len(line_lengths[10], scale);
+    lp_allp4_len = scaled_len(line_lengths[11], scale);
+    lp_dly1_len = scaled_len(line_lengths[12], scale);
+    lp_dly2_len = scaled_len(line_lengths[13], scale);
+    lp_dly3_len = scaled_len(line_lengths[14], scale);
+    lp_dly4_len = scaled_len(line_lengths[15], scale);
+    lp_dly1_offset_L = scaled_len(tap_offsets[0], scale);
+    lp_dly2_offset_L = scaled_len(tap_offsets[1], scale);
+    lp_dly3_offset_L = scaled_len(tap_offsets[2], scale);
+    lp_dly4_offset_L = scaled_len(tap_offsets[3], scale);
+    lp_dly1_offset_R = scaled_len(tap_offsets[4], scale);
+    lp_dly2_offset_R = scaled_len(tap_offsets[5], scale);
+    lp_dly3_offset_R = scaled_len(tap_offsets[6], scale);
+    lp_dly4_offset_R = scaled_len(tap_offsets[7], scale);
+    sleep_blocks = (uint16_t)ceilf(RV_SLEEP_BLOCKS * max(scale, 1.0f));
+    in_allp1_bufL = p; p += carved_len(in_allp1_lenL);
+    in_allp2_bufL = p; p += carved_len(in_allp2_lenL);
+    in_allp3_bufL = p; p += carved_len(in_allp3_lenL);
+    in_allp4_bufL = p; p += carved_len(in_allp4_lenL);
+    in_allp1_bufR = p; p += carved_len(in_allp1_lenR);
+    in_allp2_bufR = p; p += carved_len(in_allp2_lenR);
+    in_allp3_bufR = p; p += carved_len(in_allp3_lenR);
+    in_allp4_bufR = p; p += carved_len(in_allp4_lenR);
+    lp_allp1_buf = p; p += carved_len(lp_allp1_len);
+    lp_allp2_buf = p; p += carved_len(lp_allp2_len);
+    lp_allp3_buf = p; p += carved_len(lp_allp3_len);
+    lp_allp4_buf = p; p += carved_len(lp_allp4_len);
+    lp_dly1_buf = p; p += carved_len(lp_dly1_len);
+    lp_dly2_buf = p; p += carved_len(lp_dly2_len);
+    lp_dly3_buf = p; p += carved_len(lp_dly3_len);
+    lp_dly4_buf = p;
+    reset_loop();
+    __enable_irq();
+    return used;
 }
 
 // #define sat16(n, rshift) signed_saturate_rshift((n), 16, (rshift))
 
 // TODO: move this to one of the data files, use in output_adat.cpp, output_tdm.cpp, etc
-static const audio_block_t zeroblock = {
-0, 0, 0, {
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-#if AUDIO_BLOCK_SAMPLES > 16
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-#endif
-#if AUDIO_BLOCK_SAMPLES > 32
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-#endif
-#if AUDIO_BLOCK_SAMPLES > 48
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-#endif
-#if AUDIO_BLOCK_SAMPLES > 64
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-#endif
-#if AUDIO_BLOCK_SAMPLES > 80
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+static const audio_block_t zeroblock = {}; // all zero whatever AUDIO_BLOCK_SAMPLES is
+
+#if defined(REVERB_ECONOMY_LINES) && defined(REVERB_REFERENCE_KERNEL)
+#error "REVERB_ECONOMY_LINES needs the stage by stage kernel, define REVERB_STAGE_KERNEL"
 #endif
-#if AUDIO_BLOCK_SAMPLES > 96
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+
+#ifdef REVERB_INT16_STORAGE
+#ifdef REVERB_REFERENCE_KERNEL
+#error "REVERB_INT16_STORAGE needs the stage by stage kernel, define REVERB_STAGE_KERNEL"
 #endif
-#if AUDIO_BLOCK_SAMPLES > 112
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+#define RV_INT16_RANGE      (4.0f)                          // the loop goes above 2 with full scale input and the largest size
+#define RV_INT16_SCALE      (32768.0f / RV_INT16_RANGE)
+
+// rounded, except for the last few LSB which are truncated toward 0,
+// otherwise the rounding keeps a limit cycle going in the loop and the tail never decays to 0
+static inline reverb_sample_t to_storage(float32_t x)
+{
+    x = constrain(x * RV_INT16_SCALE, -32768.0f, 32767.0f);
+    if (fabsf(x) < 4.0f) return (int16_t)x;
+    return (int16_t)(x + (x < 0.0f ? -0.5f : 0.5f));
+}
+
+static inline float32_t from_storage(reverb_sample_t x)
+{
+    return x * (1.0f / RV_INT16_SCALE);
+}
+#else
+static inline reverb_sample_t to_storage(float32_t x) {return x;}
+static inline float32_t from_storage(reverb_sample_t x) {return x;}
 #endif
-} };
 
-void AudioEffectPlateReverb::update()
+void AudioEffectPlateReverb::clear_buffers()
 {
-    const audio_block_t *blockL, *blockR;
+    memset(in_allp1_bufL, 0, carved_len(in_allp1_lenL) * sizeof(reverb_sample_t));
+    memset(in_allp2_bufL, 0, carved_len(in_allp2_lenL) * sizeof(reverb_sample_t));
+    memset(in_allp3_bufL, 0, carved_len(in_allp3_lenL) * sizeof(reverb_sample_t));
+    memset(in_allp4_bufL, 0, carved_len(in_allp4_lenL) * sizeof(reverb_sample_t));
+    memset(in_allp1_bufR, 0, carved_len(in_allp1_lenR) * sizeof(reverb_sample_t));
+    memset(in_allp2_bufR, 0, carved_len(in_allp2_lenR) * sizeof(reverb_sample_t));
+    memset(in_allp3_bufR, 0, carved_len(in_allp3_lenR) * sizeof(reverb_sample_t));
+    memset(in_allp4_bufR, 0, carved_len(in_allp4_lenR) * sizeof(reverb_sample_t));
+    memset(lp_allp1_buf, 0, carved_len(lp_allp1_len) * sizeof(reverb_sample_t));
+    memset(lp_allp2_buf, 0, carved_len(lp_allp2_len) * sizeof(reverb_sample_t));
+    memset(lp_allp3_buf, 0, carved_len(lp_allp3_len) * sizeof(reverb_sample_t));
+    memset(lp_allp4_buf, 0, carved_len(lp_allp4_len) * sizeof(reverb_sample_t));
+    memset(lp_dly1_buf, 0, carved_len(lp_dly1_len) * sizeof(reverb_sample_t));
+    memset(lp_dly2_buf, 0, carved_len(lp_dly2_len) * sizeof(reverb_sample_t));
+    memset(lp_dly3_buf, 0, carved_len(lp_dly3_len) * sizeof(reverb_sample_t));
+    memset(lp_dly4_buf, 0, carved_len(lp_dly4_len) * sizeof(reverb_sample_t));
+}
 
-#if defined(__ARM_ARCH_7EM__)
-    audio_block_t *outblockL;
-	audio_block_t *outblockR;
-	int i;
-	float32_t input, acc, temp1, temp2;
-    uint16_t temp16;
-    float32_t rv_time;
+// empty loop, also moving every index back to the start of its buffer
+void AudioEffectPlateReverb::reset_loop()
+{
+    clear_buffers();
+    in_allp1_idxL = in_allp2_idxL = in_allp3_idxL = in_allp4_idxL = 0;
+    in_allp1_idxR = in_allp2_idxR = in_allp3_idxR = in_allp4_idxR = 0;
+    lp_allp1_idx = lp_allp2_idx = lp_allp3_idx = lp_allp4_idx = 0;
+    lp_dly1_idx = lp_dly2_idx = lp_dly3_idx = lp_dly4_idx = 0;
+    lpf1 = lpf2 = lpf3 = lpf4 = 0.0f;
+    hpf1 = hpf2 = hpf3 = hpf4 = 0.0f;
+    in_allp_out_L = in_allp_out_R = lp_allp_out = 0.0f;
+    memset(decimate_histL, 0, sizeof(decimate_histL));
+    memset(decimate_histR, 0, sizeof(decimate_histR));
+    memset(interpolate_histL, 0, sizeof(interpolate_histL));
+    memset(interpolate_histR, 0, sizeof(interpolate_histR));
+    silent_blocks = 0;
+}
 
-    // for LFOs:
-    int16_t lfo1_out_sin, lfo1_out_cos, lfo2_out_sin, lfo2_out_cos;
+// peak of an input block, in int16 units, 0 for a missing block
+static inline float32_t input_peak(const float32_t *block)
+{
+    float32_t peak = 0.0f;
+    if (!block) return 0.0f;
+    for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++)
+    {
+        float32_t sample = fabsf(block[i]);
+        if (sample > peak) peak = sample;
+    }
+    return peak * 32768.0f;
+}
+
+static const float32_t silence[AUDIO_BLOCK_SAMPLES] = {};
+
+// peak of the last n samples written to a delay line, ending just before its write index
+static inline float32_t delay_block_peak(const reverb_sample_t *buf, uint16_t len, uint16_t idx, int n)
+{
+    float32_t peak = 0.0f;
+    for (int i=0; i < n; i++)
+    {
+        idx = idx ? idx - 1 : len - 1;
+        float32_t sample = fabsf(from_storage(buf[idx]));
+        if (sample > peak) peak = sample;
+    }
+    return peak;
+}
+
+#ifndef REVERB_REFERENCE_KERNEL
+// LFO sin and cos outputs for a phase
+static inline void lfo_value(uint32_t phase_acc, int16_t *out_sin, int16_t *out_cos)
+{
     int32_t y0, y1;
     int64_t y;
     uint32_t idx;
-    static bool cleanup_done = false;
-    // handle bypass, 1st call will clean the buffers to avoid continuing the previous reverb tail
-    if (bypass)
+    idx = phase_acc >> 24;     // 8bit lookup table address
+    y0 =  AudioWaveformSine[idx];
+    y1 = AudioWaveformSine[idx+1];
+    idx = phase_acc & 0x00FFFFFF;   // lower 24 bit = fractional part
+    y = (int64_t)y0 * (0x00FFFFFF - idx);
+    y += (int64_t)y1 * idx;
+    *out_sin = (int32_t) (y >> (32-8)); // 16bit output
+    idx = ((phase_acc >> 24)+64) & 0xFF;
+    y0 = AudioWaveformSine[idx];
+    y1 = AudioWaveformSine[idx + 1];
+    y = (int64_t)y0 * (0x00FFFFFF - idx);
+    y += (int64_t)y1 * idx;
+    *out_cos = (int32_t) (y >> (32-8)); // 16bit output
+}
+
+// LFO sin and cos outputs for a whole block of n samples, the phase always moves by a full audio block
+static inline void lfo_block(uint32_t &phase_acc, uint32_t adder, int n, int16_t *out_sin, int16_t *out_cos)
+{
+#ifdef REVERB_LFO_BLOCK_RATE
+    // the LFOs run below 2Hz, a block is a small fraction of their period so a linear ramp from the end of the previous block is enough
+    int16_t start_sin, start_cos, end_sin, end_cos;
+    lfo_value(phase_acc, &start_sin, &start_cos);
+    phase_acc += adder * AUDIO_BLOCK_SAMPLES;
+    lfo_value(phase_acc, &end_sin, &end_cos);
+    int32_t step_sin = end_sin - start_sin;
+    int32_t step_cos = end_cos - start_cos;
+    for (int i=0; i < n; i++)
     {
-        if (!cleanup_done)
+        out_sin[i] = start_sin + step_sin * (i + 1) / n;
+        out_cos[i] = start_cos + step_cos * (i + 1) / n;
+    }
+#else
+    adder *= AUDIO_BLOCK_SAMPLES / n;
+    for (int i=0; i < n; i++)
+    {
+        phase_acc += adder;
+        lfo_value(phase_acc, &out_sin[i], &out_cos[i]);
+    }
+#endif
+}
+
+// allpass over a block, the index wraps at most once so the block is split in two spans at most
+static inline void allpass_span(reverb_sample_t *buf, uint16_t len, uint16_t &idx, float32_t k, const float32_t *in, float32_t *out, int n)
+{
+    float32_t acc;
+    while (n > 0)
+    {
+        int span = min(n, len - idx);
+        reverb_sample_t *p = buf + idx;
+        for (int j=0; j < span; j++)
         {
-            memset(in_allp1_bufL, 0, sizeof(in_allp1_bufL));
-            memset(in_allp2_bufL, 0, sizeof(in_allp2_bufL));
-            memset(in_allp3_bufL, 0, sizeof(in_allp3_bufL));
-            memset(in_allp4_bufL, 0, sizeof(in_allp4_bufL));
-            memset(in_allp1_bufR, 0, sizeof(in_allp1_bufR));
-            memset(in_allp2_bufR, 0, sizeof(in_allp2_bufR));
-            memset(in_allp3_bufR, 0, sizeof(in_allp3_bufR));
-            memset(in_allp4_bufR, 0, sizeof(in_allp4_bufR));
-            memset(lp_allp1_buf, 0, sizeof(lp_allp1_buf));
-            memset(lp_allp2_buf, 0, sizeof(lp_allp2_buf));
-            memset(lp_allp3_buf, 0, sizeof(lp_allp3_buf));
-            memset(lp_allp4_buf, 0, sizeof(lp_allp4_buf));
-            memset(lp_dly1_buf, 0, sizeof(lp_dly1_buf));
-            memset(lp_dly2_buf, 0, sizeof(lp_dly2_buf));
-            memset(lp_dly3_buf, 0, sizeof(lp_dly3_buf));
-            memset(lp_dly4_buf, 0, sizeof(lp_dly4_buf));
+            acc = from_storage(p[j]) + in[j] * k;
+            p[j] = to_storage(in[j] - k * acc);
+            out[j] = acc;
+        }
+        idx += span;
+        if (idx >= len) idx = 0;
+        in += span;
+        out += span;
+        n -= span;
+    }
+}
 
-            cleanup_done = true;
+// write a block at the end of a delay line, the samples it replaces must have been read before
+static inline void delay_write_span(reverb_sample_t *buf, uint16_t len, uint16_t &idx, const float32_t *in, int n)
+{
+    while (n > 0)
+    {
+        int span = min(n, len - idx);
+#ifdef REVERB_INT16_STORAGE
+        for (int j=0; j < span; j++) buf[idx + j] = to_storage(in[j]);
+#else
+        memcpy(buf + idx, in, span * sizeof(float32_t));
+#endif
+        idx += span;
+        if (idx >= len) idx = 0;
+        in += span;
+        n -= span;
+    }
+}
+
+// linear interpolated read of a delay line tap, position is below twice the length so a single wrap is enough
+static inline float32_t modulated_tap(const reverb_sample_t *buf, uint16_t len, uint32_t position, int16_t lfo)
+{
+    float32_t temp1, temp2, k;
+    uint32_t idx = position + (lfo>>LFO_FRAC_BITS);
+    if (idx >= len) idx -= len;
+    temp1 = from_storage(buf[idx++]);    // sample now
+    if (idx >= len) idx = 0;
+    temp2 = from_storage(buf[idx]);      // sample next
+    k = (float32_t)(lfo & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
+    return temp1*(1.0f-k) + temp2*k;
+}
+
+// one pole coefficient giving the same cutoff at half the sample rate
+static inline float32_t half_rate_coeff(float32_t f)
+{
+    return 1.0f - (1.0f - f) * (1.0f - f);
+}
+
+// halfband lowpass (-1 0 9 16 9 0 -1)/32 keeping every other sample, history holds the last 6 input samples
+static void decimate_block(const float32_t *in, float32_t *history, float32_t *out)
+{
+    float32_t ext[AUDIO_BLOCK_SAMPLES + 6];
+    memcpy(ext, history, 6 * sizeof(float32_t));
+    memcpy(ext + 6, in, AUDIO_BLOCK_SAMPLES * sizeof(float32_t));
+    for (int i=0; i < AUDIO_BLOCK_SAMPLES / 2; i++)
+    {
+        const float32_t *x = ext + 2 * i;
+        out[i] = (16.0f * x[3] + 9.0f * (x[2] + x[4]) - (x[0] + x[6])) * (1.0f / 32.0f);
+    }
+    memcpy(history, ext + AUDIO_BLOCK_SAMPLES, 6 * sizeof(float32_t));
+}
+
+// inverse of the above, the even samples are copied and the odd ones interpolated, history holds the last 3 input samples
+static void interpolate_block(const float32_t *in, float32_t *history, float32_t *out)
+{
+    float32_t ext[AUDIO_BLOCK_SAMPLES / 2 + 3];
+    memcpy(ext, history, 3 * sizeof(float32_t));
+    memcpy(ext + 3, in, AUDIO_BLOCK_SAMPLES / 2 * sizeof(float32_t));
+    for (int i=0; i < AUDIO_BLOCK_SAMPLES / 2; i++)
+    {
+        const float32_t *x = ext + i;
+        out[2 * i] = x[1];
+        out[2 * i + 1] = (9.0f * (x[1] + x[2]) - (x[0] + x[3])) * (1.0f / 16.0f);
+    }
+    memcpy(history, ext + AUDIO_BLOCK_SAMPLES / 2, 3 * sizeof(float32_t));
+}
+
+// hi/lo shelving filter on the samples read from the end of a loop delay, the delay index is left untouched
+void AudioEffectPlateReverb::loop_filter_span(const reverb_sample_t *buf, uint16_t len, uint16_t idx, float32_t &lpf, float32_t &hpf, float32_t rv_time, float32_t lowpass_f, float32_t hipass_f, float32_t *out, int n)
+{
+    float32_t input, acc, temp1, temp2;
+    for (int i=0; i < n; i++)
+    {
+        input = from_storage(buf[idx]);
+        if (++idx >= len) idx = 0;
+        temp1 = input - lpf;
+        lpf += temp1 * lowpass_f;
+        temp2 = input - lpf;
+        temp1 = lpf - hpf;
+        hpf += temp1 * hipass_f;
+        acc = lpf + temp2*lp_hidamp_k + hpf*lp_lodamp_k;
+        out[i] = acc * rv_time * rv_time_scaler;                                       // scale by the reveb time
+    }
+}
+
+// stage by stage kernel, same arithmetic as the reference one but the samples are processed one stage at a time
+// every delay line is longer than a block and every tap reads more than a block ahead of the write index,
+// so nothing read during a block was written during it and each stage can run over the whole block
+// with a rate shift of 1 the n samples are at half the rate, using the first half of every buffer and tap offset
+void AudioEffectPlateReverb::process_loop(const float32_t *inL, const float32_t *inR, float32_t *outL, float32_t *outR, int n, uint8_t rate_shift)
+{
+    int i;
+    float32_t acc;
+    float32_t rv_time = rv_time_k;
+    float32_t lowpass_f = rate_shift ? half_rate_coeff(lp_lowpass_f) : lp_lowpass_f;
+    float32_t hipass_f = rate_shift ? half_rate_coeff(lp_hipass_f) : lp_hipass_f;
+    int16_t lfo1_sin[AUDIO_BLOCK_SAMPLES], lfo1_cos[AUDIO_BLOCK_SAMPLES];
+    int16_t lfo2_sin[AUDIO_BLOCK_SAMPLES], lfo2_cos[AUDIO_BLOCK_SAMPLES];
+    float32_t in_allp_out_blockL[AUDIO_BLOCK_SAMPLES];
+    float32_t in_allp_out_blockR[AUDIO_BLOCK_SAMPLES];
+    float32_t stage_in[AUDIO_BLOCK_SAMPLES];
+    float32_t stage_out[4][AUDIO_BLOCK_SAMPLES];
+    const uint16_t dly1_len = lp_dly1_len >> rate_shift;
+    const uint16_t dly2_len = lp_dly2_len >> rate_shift;
+    const uint16_t dly3_len = lp_dly3_len >> rate_shift;
+    const uint16_t dly4_len = lp_dly4_len >> rate_shift;
+    uint16_t dly1_idx = lp_dly1_idx;
+    uint16_t dly2_idx = lp_dly2_idx;
+    uint16_t dly3_idx = lp_dly3_idx;
+    uint16_t dly4_idx = lp_dly4_idx;
+
+    lfo_block(lfo1_phase_acc, lfo1_adder, n, lfo1_sin, lfo1_cos);
+    lfo_block(lfo2_phase_acc, lfo2_adder, n, lfo2_sin, lfo2_cos);
+    if (rate_shift)
+    {
+        // same modulation depth in time, so half the samples
+        for (i=0; i < n; i++)
+        {
+            lfo1_sin[i] >>= rate_shift;
+            lfo1_cos[i] >>= rate_shift;
+            lfo2_sin[i] >>= rate_shift;
+            lfo2_cos[i] >>= rate_shift;
         }
-        blockL = receiveReadOnly(0);
-        blockR = receiveReadOnly(1);
+    }
+
+    // chained input allpasses, channel L
+    for (i=0; i < n; i++) stage_in[i] = inL[i] * input_attn;
+    allpass_span(in_allp1_bufL, in_allp1_lenL >> rate_shift, in_allp1_idxL, in_allp_k, stage_in, stage_in, n);
+    allpass_span(in_allp2_bufL, in_allp2_lenL >> rate_shift, in_allp2_idxL, in_allp_k, stage_in, stage_in, n);
+    allpass_span(in_allp3_bufL, in_allp3_lenL >> rate_shift, in_allp3_idxL, in_allp_k, stage_in, stage_in, n);
+    allpass_span(in_allp4_bufL, in_allp4_lenL >> rate_shift, in_allp4_idxL, in_allp_k, stage_in, in_allp_out_blockL, n);
+    in_allp_out_L = in_allp_out_blockL[n - 1];
+
+    // chained input allpasses, channel R
+    for (i=0; i < n; i++) stage_in[i] = inR[i] * input_attn;
+    allpass_span(in_allp1_bufR, in_allp1_lenR >> rate_shift, in_allp1_idxR, in_allp_k, stage_in, stage_in, n);
+    allpass_span(in_allp2_bufR, in_allp2_lenR >> rate_shift, in_allp2_idxR, in_allp_k, stage_in, stage_in, n);
+    allpass_span(in_allp3_bufR, in_allp3_lenR >> rate_shift, in_allp3_idxR, in_allp_k, stage_in, stage_in, n);
+    allpass_span(in_allp4_bufR, in_allp4_lenR >> rate_shift, in_allp4_idxR, in_allp_k, stage_in, in_allp_out_blockR, n);
+    in_allp_out_R = in_allp_out_blockR[n - 1];
+
+    // end of the loop delays through the hi/lo shelving filters, scaled by the reverb time
+    loop_filter_span(lp_dly1_buf, dly1_len, lp_dly1_idx, lpf1, hpf1, rv_time, lowpass_f, hipass_f, stage_out[0], n);
+    loop_filter_span(lp_dly2_buf, dly2_len, lp_dly2_idx, lpf2, hpf2, rv_time, lowpass_f, hipass_f, stage_out[1], n);
+    loop_filter_span(lp_dly3_buf, dly3_len, lp_dly3_idx, lpf3, hpf3, rv_time, lowpass_f, hipass_f, stage_out[2], n);
+    loop_filter_span(lp_dly4_buf, dly4_len, lp_dly4_idx, lpf4, hpf4, rv_time, lowpass_f, hipass_f, stage_out[3], n);
+
+    // loop allpasses, each one feeding its delay line, the 1st one is fed by the output of the 4th
+    stage_in[0] = lp_allp_out + in_allp_out_blockR[0];
+    for (i=1; i < n; i++) stage_in[i] = stage_out[3][i-1] + in_allp_out_blockR[i];
+    allpass_span(lp_allp1_buf, lp_allp1_len >> rate_shift, lp_allp1_idx, loop_allp_k, stage_in, stage_in, n);
+    delay_write_span(lp_dly1_buf, dly1_len, lp_dly1_idx, stage_in, n);
+
+    for (i=0; i < n; i++) stage_in[i] = stage_out[0][i] + in_allp_out_blockL[i];
+    allpass_span(lp_allp2_buf, lp_allp2_len >> rate_shift, lp_allp2_idx, loop_allp_k, stage_in, stage_in, n);
+    delay_write_span(lp_dly2_buf, dly2_len, lp_dly2_idx, stage_in, n);
+
+    for (i=0; i < n; i++) stage_in[i] = stage_out[1][i] + in_allp_out_blockR[i];
+    allpass_span(lp_allp3_buf, lp_allp3_len >> rate_shift, lp_allp3_idx, loop_allp_k, stage_in, stage_in, n);
+    delay_write_span(lp_dly3_buf, dly3_len, lp_dly3_idx, stage_in, n);
+
+    for (i=0; i < n; i++) stage_in[i] = stage_out[2][i] + in_allp_out_blockL[i];
+    allpass_span(lp_allp4_buf, lp_allp4_len >> rate_shift, lp_allp4_idx, loop_allp_k, stage_in, stage_in, n);
+    delay_write_span(lp_dly4_buf, dly4_len, lp_dly4_idx, stage_in, n);
+
+    lp_allp_out = stage_out[3][n - 1];
+
+    // output taps, read from the index following the write of each sample like in the reference kernel
+    for (i=0; i < n; i++)
+    {
+        if (++dly1_idx >= dly1_len) dly1_idx = 0;
+        if (++dly2_idx >= dly2_len) dly2_idx = 0;
+        if (++dly3_idx >= dly3_len) dly3_idx = 0;
+        if (++dly4_idx >= dly4_len) dly4_idx = 0;
+
+        // channel L:
+#ifdef TAP1_MODULATED
+        acc = modulated_tap(lp_dly1_buf, dly1_len, dly1_idx + (lp_dly1_offset_L >> rate_shift), lfo1_cos[i]) * 0.8f;
+#else
+        acc = modulated_tap(lp_dly1_buf, dly1_len, dly1_idx + (lp_dly1_offset_L >> rate_shift), 0) * 0.8f;
+#endif
+#ifdef TAP2_MODULATED
+        acc += modulated_tap(lp_dly2_buf, dly2_len, dly2_idx + (lp_dly2_offset_L >> rate_shift), lfo1_sin[i]) * 0.7f;
+#else
+        acc += modulated_tap(lp_dly2_buf, dly2_len, dly2_idx + (lp_dly2_offset_L >> rate_shift), 0) * 0.6f;
+#endif
+        acc += modulated_tap(lp_dly3_buf, dly3_len, dly3_idx + (lp_dly3_offset_L >> rate_shift), lfo2_cos[i]) * 0.6f;
+        acc += modulated_tap(lp_dly4_buf, dly4_len, dly4_idx + (lp_dly4_offset_L >> rate_shift), lfo2_sin[i]) * 0.5f;
+        outL[i] = acc;
+
+        // Channel R
+#ifdef TAP1_MODULATED
+        acc = modulated_tap(lp_dly1_buf, dly1_len, dly1_idx + (lp_dly1_offset_R >> rate_shift), lfo1_sin[i]) * 0.8f;
+#else
+        acc = modulated_tap(lp_dly1_buf, dly1_len, dly1_idx + (lp_dly1_offset_R >> rate_shift), 0) * 0.8f;
+#endif
+#ifdef TAP2_MODULATED
+        acc += modulated_tap(lp_dly2_buf, dly2_len, dly2_idx + (lp_dly2_offset_R >> rate_shift), lfo1_cos[i]) * 0.7f;
+#else
+        acc += modulated_tap(lp_dly2_buf, dly2_len, dly2_idx + (lp_dly2_offset_R >> rate_shift), 0) * 0.7f;
+#endif
+        acc += modulated_tap(lp_dly3_buf, dly3_len, dly3_idx + (lp_dly3_offset_R >> rate_shift), lfo2_sin[i]) * 0.6f;
+        acc += modulated_tap(lp_dly4_buf, dly4_len, dly4_idx + (lp_dly4_offset_R >> rate_shift), lfo2_cos[i]) * 0.5f;
+        outR[i] = acc;
+    }
+}
+#endif
+
+// float to the int16 of the output blocks, saturated as a loud tail would otherwise wrap around
+static inline int16_t output_sample(float32_t x)
+{
+    x *= 32767.0f;
+    if (x > 32767.0f) return 32767;
+    if (x < -32768.0f) return -32768;
+    return (int16_t)x;
+}
+
+void AudioEffectPlateReverb::update()
+{
+    const audio_block_t *blockL, *blockR;
+    blockL = receiveReadOnly(0);
+    blockR = receiveReadOnly(1);
+
+#if defined(__ARM_ARCH_7EM__)
+    // handle bypass, the blocks are passed through without conversion
+    if (bypass && lp_dly4_buf)
+    {
+        process(nullptr, nullptr, nullptr, nullptr);
         if (!blockL) blockL = &zeroblock;
         if (!blockR) blockR = &zeroblock;
         transmit((audio_block_t *)blockL,0);
         transmit((audio_block_t *)blockR,1);
         if (blockL != &zeroblock) release((audio_block_t *)blockL);
         if (blockR != &zeroblock) release((audio_block_t *)blockR);
-
         return;
     }
-    cleanup_done = false;
-
+    float32_t input_blockL[AUDIO_BLOCK_SAMPLES];
+    float32_t input_blockR[AUDIO_BLOCK_SAMPLES];
+    float32_t output_blockL[AUDIO_BLOCK_SAMPLES];
+    float32_t output_blockR[AUDIO_BLOCK_SAMPLES];
+    // convert data to float32
+    if (blockL) arm_q15_to_float((q15_t *)blockL->data, input_blockL, AUDIO_BLOCK_SAMPLES);
+    if (blockR) arm_q15_to_float((q15_t *)blockR->data, input_blockR, AUDIO_BLOCK_SAMPLES);
+    if (process(blockL ? input_blockL : nullptr, blockR ? input_blockR : nullptr, output_blockL, output_blockR))
+    {
+        audio_block_t *outblockL = allocate();
+        audio_block_t *outblockR = allocate();
+        if (outblockL && outblockR)
+        {
+            for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++)
+            {
+                outblockL->data[i] = output_sample(output_blockL[i]);
+                outblockR->data[i] = output_sample(output_blockR[i]);
+            }
+            transmit(outblockL, 0);
+            transmit(outblockR, 1);
+        }
+        if (outblockL) release(outblockL);
+        if (outblockR) release(outblockR);
+    }
+#endif
+    if (blockL) release((audio_block_t *)blockL);
+    if (blockR) release((audio_block_t *)blockR);
+}
 
-    blockL = receiveReadOnly(0);
-    blockR = receiveReadOnly(1);
-	outblockL = allocate();
-	outblockR = allocate();
-	if (!outblockL || !outblockR) {
-		if (outblockL) release(outblockL);
-		if (outblockR) release(outblockR);
-		if (blockL) release((audio_block_t *)blockL);
-        if (blockR) release((audio_block_t *)blockR);
-		return;
-	}
+bool AudioEffectPlateReverb::process(const float32_t *input_blockL, const float32_t *input_blockR, float32_t *output_blockL, float32_t *output_blockR)
+{
+#if defined(__ARM_ARCH_7EM__)
+	int i;
+	float32_t temp1;
+    uint8_t rate_shift = 0;
+    // no lines yet, begin() was not called
+    if (!lp_dly4_buf) return false;
+    // handle bypass, 1st call will clean the buffers to avoid continuing the previous reverb tail
+    if (bypass)
+    {
+        if (!cleanup_done)
+        {
+            clear_buffers();
+            cleanup_done = true;
+        }
+        if (!output_blockL || !output_blockR) return true;
+        for (i=0; i < AUDIO_BLOCK_SAMPLES; i++)
+        {
+            output_blockL[i] = input_blockL ? input_blockL[i] : 0.0f;
+            output_blockR[i] = input_blockR ? input_blockR[i] : 0.0f;
+        }
+        return true;
+    }
+    cleanup_done = false;
 
-	if (!blockL) blockL = &zeroblock;
-    if (!blockR) blockR = &zeroblock;
+    bool input_silent = input_peak(input_blockL) < RV_SLEEP_INPUT_PEAK && input_peak(input_blockR) < RV_SLEEP_INPUT_PEAK;
+    // asleep, no output until the input comes back, which wakes the reverb on the same block
+    if (asleep)
+    {
+        if (input_silent) return false;
+        asleep = false;
+    }
+    if (!input_blockL) input_blockL = silence;
+    if (!input_blockR) input_blockR = silence;
 
-    // convert data to float32
-    arm_q15_to_float((q15_t *)blockL->data, input_blockL, AUDIO_BLOCK_SAMPLES);
-    arm_q15_to_float((q15_t *)blockR->data, input_blockR, AUDIO_BLOCK_SAMPLES);
+#ifdef REVERB_REFERENCE_KERNEL
+	float32_t input, acc, temp2;
+    float32_t rv_time = rv_time_k;
+    uint16_t temp16;
 
-    rv_time = rv_time_k;
+    // for LFOs:
+    int16_t lfo1_out_sin, lfo1_out_cos, lfo2_out_sin, lfo2_out_cos;
+    int32_t y0, y1;
+    int64_t y;
+    uint32_t idx;
 
 	for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
     {
@@ -295,22 +697,22 @@ void AudioEffectPlateReverb::update()
         acc = in_allp1_bufL[in_allp1_idxL]  + input * in_allp_k;  
         in_allp1_bufL[in_allp1_idxL] = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp1_idxL >= sizeof(in_allp1_bufL)/sizeof(float32_t)) in_allp1_idxL = 0;
+        if (++in_allp1_idxL >= in_allp1_lenL) in_allp1_idxL = 0;
 
         acc = in_allp2_bufL[in_allp2_idxL]  + input * in_allp_k;  
         in_allp2_bufL[in_allp2_idxL] = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp2_idxL >= sizeof(in_allp2_bufL)/sizeof(float32_t)) in_allp2_idxL = 0;
+        if (++in_allp2_idxL >= in_allp2_lenL) in_allp2_idxL = 0;
 
         acc = in_allp3_bufL[in_allp3_idxL]  + input * in_allp_k;  
         in_allp3_bufL[in_allp3_idxL] = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp3_idxL >= sizeof(in_allp3_bufL)/sizeof(float32_t)) in_allp3_idxL = 0;
+        if (++in_allp3_idxL >= in_allp3_lenL) in_allp3_idxL = 0;
 
         acc = in_allp4_bufL[in_allp4_idxL]  + input * in_allp_k;  
         in_allp4_bufL[in_allp4_idxL] = input - in_allp_k * acc;
         in_allp_out_L = acc;
-        if (++in_allp4_idxL >= sizeof(in_allp4_bufL)/sizeof(float32_t)) in_allp4_idxL = 0;
+        if (++in_allp4_idxL >= in_allp4_lenL) in_allp4_idxL = 0;
 
         input = input_blockR[i] * input_attn;
 
@@ -318,34 +720,34 @@ void AudioEffectPlateReverb::update()
         acc = in_allp1_bufR[in_allp1_idxR]  + input * in_allp_k;  
         in_allp1_bufR[in_allp1_idxR] = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp1_idxR >= sizeof(in_allp1_bufR)/sizeof(float32_t)) in_allp1_idxR = 0;
+        if (++in_allp1_idxR >= in_allp1_lenR) in_allp1_idxR = 0;
 
         acc = in_allp2_bufR[in_allp2_idxR]  + input * in_allp_k;  
         in_allp2_bufR[in_allp2_idxR] = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp2_idxR >= sizeof(in_allp2_bufR)/sizeof(float32_t)) in_allp2_idxR = 0;
+        if (++in_allp2_idxR >= in_allp2_lenR) in_allp2_idxR = 0;
 
         acc = in_allp3_bufR[in_allp3_idxR]  + input * in_allp_k;  
         in_allp3_bufR[in_allp3_idxR] = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp3_idxR >= sizeof(in_allp3_bufR)/sizeof(float32_t)) in_allp3_idxR = 0;
+        if (++in_allp3_idxR >= in_allp3_lenR) in_allp3_idxR = 0;
 
         acc = in_allp4_bufR[in_allp4_idxR]  + input * in_allp_k;  
         in_allp4_bufR[in_allp4_idxR] = input - in_allp_k * acc;
         in_allp_out_R = acc;
-        if (++in_allp4_idxR >= sizeof(in_allp4_bufR)/sizeof(float32_t)) in_allp4_idxR = 0;
+        if (++in_allp4_idxR >= in_allp4_lenR) in_allp4_idxR = 0;
 
         // input allpases done, start loop allpases
         input = lp_allp_out + in_allp_out_R; 
         acc = lp_allp1_buf[lp_allp1_idx] + input * loop_allp_k;                  // input is the lp allpass chain output
         lp_allp1_buf[lp_allp1_idx] = input - loop_allp_k * acc;
         input = acc;
-        if (++lp_allp1_idx >= sizeof(lp_allp1_buf)/sizeof(float32_t)) lp_allp1_idx = 0;
+        if (++lp_allp1_idx >= lp_allp1_len) lp_allp1_idx = 0;
         
         acc = lp_dly1_buf[lp_dly1_idx];                                                   // read the end of the delay
         lp_dly1_buf[lp_dly1_idx] = input;                                                 // write new sample
         input = acc;
-        if (++lp_dly1_idx >= sizeof(lp_dly1_buf)/sizeof(float32_t)) lp_dly1_idx = 0;     // update index
+        if (++lp_dly1_idx >= lp_dly1_len) lp_dly1_idx = 0;     // update index
 
         // hi/lo shelving filter
         temp1 = input - lpf1;
@@ -361,11 +763,11 @@ void AudioEffectPlateReverb::update()
         acc = lp_allp2_buf[lp_allp2_idx] + input * loop_allp_k;                  
         lp_allp2_buf[lp_allp2_idx] = input - loop_allp_k * acc;
         input = acc;
-        if (++lp_allp2_idx >= sizeof(lp_allp2_buf)/sizeof(float32_t)) lp_allp2_idx = 0;
+        if (++lp_allp2_idx >= lp_allp2_len) lp_allp2_idx = 0;
         acc = lp_dly2_buf[lp_dly2_idx];                                                   // read the end of the delay
         lp_dly2_buf[lp_dly2_idx] = input;                                                 // write new sample
         input = acc;
-        if (++lp_dly2_idx >= sizeof(lp_dly2_buf)/sizeof(float32_t)) lp_dly2_idx = 0;     // update index
+        if (++lp_dly2_idx >= lp_dly2_len) lp_dly2_idx = 0;     // update index
         // hi/lo shelving filter
         temp1 = input - lpf2;
         lpf2 += temp1 * lp_lowpass_f;
@@ -380,11 +782,11 @@ void AudioEffectPlateReverb::update()
         acc = lp_allp3_buf[lp_allp3_idx] + input * loop_allp_k;                  
         lp_allp3_buf[lp_allp3_idx] = input - loop_allp_k * acc;
         input = acc;
-        if (++lp_allp3_idx >= sizeof(lp_allp3_buf)/sizeof(float32_t)) lp_allp3_idx = 0;
+        if (++lp_allp3_idx >= lp_allp3_len) lp_allp3_idx = 0;
         acc = lp_dly3_buf[lp_dly3_idx];                                                   // read the end of the delay
         lp_dly3_buf[lp_dly3_idx] = input;                                                 // write new sample
         input = acc;
-        if (++lp_dly3_idx >= sizeof(lp_dly3_buf)/sizeof(float32_t)) lp_dly3_idx = 0;     // update index
+        if (++lp_dly3_idx >= lp_dly3_len) lp_dly3_idx = 0;     // update index
         // hi/lo shelving filter
         temp1 = input - lpf3;
         lpf3 += temp1 * lp_lowpass_f;
@@ -399,11 +801,11 @@ void AudioEffectPlateReverb::update()
         acc = lp_allp4_buf[lp_allp4_idx] + input * loop_allp_k;                  
         lp_allp4_buf[lp_allp4_idx] = input - loop_allp_k * acc;
         input = acc;
-        if (++lp_allp4_idx >= sizeof(lp_allp4_buf)/sizeof(float32_t)) lp_allp4_idx = 0;
+        if (++lp_allp4_idx >= lp_allp4_len) lp_allp4_idx = 0;
         acc = lp_dly4_buf[lp_dly4_idx];                                                   // read the end of the delay
         lp_dly4_buf[lp_dly4_idx] = input;                                                 // write new sample
         input = acc;
-        if (++lp_dly4_idx >= sizeof(lp_dly4_buf)/sizeof(float32_t)) lp_dly4_idx= 0;     // update index
+        if (++lp_dly4_idx >= lp_dly4_len) lp_dly4_idx= 0;     // update index
         // hi/lo shelving filter
         temp1 = input - lpf4;
         lpf4 += temp1 * lp_lowpass_f;
@@ -417,40 +819,40 @@ void AudioEffectPlateReverb::update()
 
         // channel L:
 #ifdef TAP1_MODULATED
-        temp16 = (lp_dly1_idx + lp_dly1_offset_L + (lfo1_out_cos>>LFO_FRAC_BITS)) %  (sizeof(lp_dly1_buf)/sizeof(float32_t));
+        temp16 = (lp_dly1_idx + lp_dly1_offset_L + (lfo1_out_cos>>LFO_FRAC_BITS)) %  (lp_dly1_len);
         temp1 = lp_dly1_buf[temp16++];    // sample now
-        if (temp16  >= sizeof(lp_dly1_buf)/sizeof(float32_t)) temp16 = 0;
+        if (temp16  >= lp_dly1_len) temp16 = 0;
         temp2 = lp_dly1_buf[temp16];    // sample next
         input = (float32_t)(lfo1_out_cos & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
         acc = (temp1*(1.0f-input) + temp2*input)* 0.8f;
 #else
-        temp16 = (lp_dly1_idx + lp_dly1_offset_L) %  (sizeof(lp_dly1_buf)/sizeof(float32_t));
+        temp16 = (lp_dly1_idx + lp_dly1_offset_L) %  (lp_dly1_len);
         acc = lp_dly1_buf[temp16]* 0.8f;
 #endif
 
 
 #ifdef TAP2_MODULATED
-        temp16 = (lp_dly2_idx + lp_dly2_offset_L + (lfo1_out_sin>>LFO_FRAC_BITS)) % (sizeof(lp_dly2_buf)/sizeof(float32_t));
+        temp16 = (lp_dly2_idx + lp_dly2_offset_L + (lfo1_out_sin>>LFO_FRAC_BITS)) % (lp_dly2_len);
         temp1 = lp_dly2_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly2_buf)/sizeof(float32_t)) temp16 = 0;
+        if (temp16  >= lp_dly2_len) temp16 = 0;
         temp2 = lp_dly2_buf[temp16]; 
         input = (float32_t)(lfo1_out_sin & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
         acc += (temp1*(1.0f-input) + temp2*input)* 0.7f;
 #else
-        temp16 = (lp_dly2_idx + lp_dly2_offset_L) % (sizeof(lp_dly2_buf)/sizeof(float32_t));
+        temp16 = (lp_dly2_idx + lp_dly2_offset_L) % (lp_dly2_len);
         acc += (temp1*(1.0f-input) + temp2*input)* 0.6f;
 #endif
 
-        temp16 = (lp_dly3_idx + lp_dly3_offset_L + (lfo2_out_cos>>LFO_FRAC_BITS)) % (sizeof(lp_dly3_buf)/sizeof(float32_t));
+        temp16 = (lp_dly3_idx + lp_dly3_offset_L + (lfo2_out_cos>>LFO_FRAC_BITS)) % (lp_dly3_len);
         temp1 = lp_dly3_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly3_buf)/sizeof(float32_t)) temp16 = 0;
+        if (temp16  >= lp_dly3_len) temp16 = 0;
         temp2 = lp_dly3_buf[temp16]; 
         input = (float32_t)(lfo2_out_cos & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
         acc += (temp1*(1.0f-input) + temp2*input)* 0.6f;
 
-        temp16 = (lp_dly4_idx + lp_dly4_offset_L + (lfo2_out_sin>>LFO_FRAC_BITS)) % (sizeof(lp_dly4_buf)/sizeof(float32_t));
+        temp16 = (lp_dly4_idx + lp_dly4_offset_L + (lfo2_out_sin>>LFO_FRAC_BITS)) % (lp_dly4_len);
         temp1 = lp_dly4_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly4_buf)/sizeof(float32_t)) temp16 = 0;
+        if (temp16  >= lp_dly4_len) temp16 = 0;
         temp2 = lp_dly4_buf[temp16]; 
         input = (float32_t)(lfo2_out_sin & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
         acc += (temp1*(1.0f-input) + temp2*input)* 0.5f;
@@ -459,42 +861,42 @@ void AudioEffectPlateReverb::update()
         temp1 = acc - master_lowpass_l;
         master_lowpass_l += temp1 * master_lowpass_f;
 
-        outblockL->data[i] =(int16_t)(master_lowpass_l * 32767.0f); //sat16(output * 30, 0);
+        output_blockL[i] = master_lowpass_l;
 
         // Channel R
 #ifdef TAP1_MODULATED
-        temp16 = (lp_dly1_idx + lp_dly1_offset_R + (lfo1_out_sin>>LFO_FRAC_BITS)) %  (sizeof(lp_dly1_buf)/sizeof(float32_t));
+        temp16 = (lp_dly1_idx + lp_dly1_offset_R + (lfo1_out_sin>>LFO_FRAC_BITS)) %  (lp_dly1_len);
         temp1 = lp_dly1_buf[temp16++];    // sample now
-        if (temp16  >= sizeof(lp_dly1_buf)/sizeof(float32_t)) temp16 = 0;
+        if (temp16  >= lp_dly1_len) temp16 = 0;
         temp2 = lp_dly1_buf[temp16];    // sample next
         input = (float32_t)(lfo1_out_sin & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
 
         acc = (temp1*(1.0f-input) + temp2*input)* 0.8f;
 #else
-        temp16 = (lp_dly1_idx + lp_dly1_offset_R) %  (sizeof(lp_dly1_buf)/sizeof(float32_t));
+        temp16 = (lp_dly1_idx + lp_dly1_offset_R) %  (lp_dly1_len);
         acc = lp_dly1_buf[temp16] * 0.8f;
 #endif
 #ifdef TAP2_MODULATED
-        temp16 = (lp_dly2_idx + lp_dly2_offset_R + (lfo1_out_cos>>LFO_FRAC_BITS)) % (sizeof(lp_dly2_buf)/sizeof(float32_t));
+        temp16 = (lp_dly2_idx + lp_dly2_offset_R + (lfo1_out_cos>>LFO_FRAC_BITS)) % (lp_dly2_len);
         temp1 = lp_dly2_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly2_buf)/sizeof(float32_t)) temp16 = 0;
+        if (temp16  >= lp_dly2_len) temp16 = 0;
         temp2 = lp_dly2_buf[temp16]; 
         input = (float32_t)(lfo1_out_cos & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
         acc += (temp1*(1.0f-input) + temp2*input)* 0.7f;
 #else
-        temp16 = (lp_dly2_idx + lp_dly2_offset_R) % (sizeof(lp_dly2_buf)/sizeof(float32_t));
+        temp16 = (lp_dly2_idx + lp_dly2_offset_R) % (lp_dly2_len);
         acc += (temp1*(1.0f-input) + temp2*input)* 0.7f;
 #endif
-        temp16 = (lp_dly3_idx + lp_dly3_offset_R + (lfo2_out_sin>>LFO_FRAC_BITS)) % (sizeof(lp_dly3_buf)/sizeof(float32_t));
+        temp16 = (lp_dly3_idx + lp_dly3_offset_R + (lfo2_out_sin>>LFO_FRAC_BITS)) % (lp_dly3_len);
         temp1 = lp_dly3_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly3_buf)/sizeof(float32_t)) temp16 = 0;
+        if (temp16  >= lp_dly3_len) temp16 = 0;
         temp2 = lp_dly3_buf[temp16]; 
         input = (float32_t)(lfo2_out_sin & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
         acc += (temp1*(1.0f-input) + temp2*input)* 0.6f;
 
-        temp16 = (lp_dly4_idx + lp_dly4_offset_R + (lfo2_out_cos>>LFO_FRAC_BITS)) % (sizeof(lp_dly4_buf)/sizeof(float32_t));
+        temp16 = (lp_dly4_idx + lp_dly4_offset_R + (lfo2_out_cos>>LFO_FRAC_BITS)) % (lp_dly4_len);
         temp1 = lp_dly4_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly4_buf)/sizeof(float32_t)) temp16 = 0;
+        if (temp16  >= lp_dly4_len) temp16 = 0;
         temp2 = lp_dly4_buf[temp16]; 
         input = (float32_t)(lfo2_out_cos & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
         acc += (temp1*(1.0f-input) + temp2*input)* 0.5f;
@@ -502,20 +904,60 @@ void AudioEffectPlateReverb::update()
         // Master lowpass filter
         temp1 = acc - master_lowpass_r;
         master_lowpass_r += temp1 * master_lowpass_f;
-        outblockR->data[i] =(int16_t)(master_lowpass_r * 32767.0f);
+        output_blockR[i] = master_lowpass_r;
 		
 	}
-    transmit(outblockL, 0);
-	transmit(outblockR, 1);
-	release(outblockL);
-	release(outblockR);
-	if (blockL != &zeroblock) release((audio_block_t *)blockL);
-    if (blockR != &zeroblock) release((audio_block_t *)blockR);
-
-#elif defined(KINETISL)
-	blockL = receiveReadOnly(0);
-	if (blockL) release(blockL);
-    blockR = receiveReadOnly(1);
-    if (blockR) release(blockR);
+#else
+    float32_t wetL[AUDIO_BLOCK_SAMPLES], wetR[AUDIO_BLOCK_SAMPLES];
+    if (economy_active != economy_mode)
+    {
+        // the buffers are not used the same way at both rates, start again from silence
+        reset_loop();
+        economy_active = economy_mode;
+    }
+    if (economy_active)
+    {
+        float32_t halfL[AUDIO_BLOCK_SAMPLES / 2], halfR[AUDIO_BLOCK_SAMPLES / 2];
+        rate_shift = 1;
+        decimate_block(input_blockL, decimate_histL, halfL);
+        decimate_block(input_blockR, decimate_histR, halfR);
+        process_loop(halfL, halfR, halfL, halfR, AUDIO_BLOCK_SAMPLES / 2, rate_shift);
+        interpolate_block(halfL, interpolate_histL, wetL);
+        interpolate_block(halfR, interpolate_histR, wetR);
+    }
+    else process_loop(input_blockL, input_blockR, wetL, wetR, AUDIO_BLOCK_SAMPLES, rate_shift);
+
+    for (i=0; i < AUDIO_BLOCK_SAMPLES; i++)
+    {
+        // Master lowpass filter
+        temp1 = wetL[i] - master_lowpass_l;
+        master_lowpass_l += temp1 * master_lowpass_f;
+        output_blockL[i] = master_lowpass_l;
+
+        temp1 = wetR[i] - master_lowpass_r;
+        master_lowpass_r += temp1 * master_lowpass_f;
+        output_blockR[i] = master_lowpass_r;
+    }
+#endif
+    // tail tracking, the reverb goes to sleep once the input is silent and every sample written to the loop delays
+    // has stayed below RV_SLEEP_LOOP_PEAK for sleep_blocks blocks, what is left in the loop is then inaudible
+    float32_t loop_peak = delay_block_peak(lp_dly1_buf, lp_dly1_len >> rate_shift, lp_dly1_idx, AUDIO_BLOCK_SAMPLES >> rate_shift);
+    loop_peak = max(loop_peak, delay_block_peak(lp_dly2_buf, lp_dly2_len >> rate_shift, lp_dly2_idx, AUDIO_BLOCK_SAMPLES >> rate_shift));
+    loop_peak = max(loop_peak, delay_block_peak(lp_dly3_buf, lp_dly3_len >> rate_shift, lp_dly3_idx, AUDIO_BLOCK_SAMPLES >> rate_shift));
+    loop_peak = max(loop_peak, delay_block_peak(lp_dly4_buf, lp_dly4_len >> rate_shift, lp_dly4_idx, AUDIO_BLOCK_SAMPLES >> rate_shift));
+    if (input_silent && loop_peak < RV_SLEEP_LOOP_PEAK)
+    {
+        if (++silent_blocks >= sleep_blocks)
+        {
+            // what is left is inaudible, start from a clean state on wake up
+            reset_loop();
+            master_lowpass_l = master_lowpass_r = 0.0f;
+            asleep = true;
+        }
+    }
+    else silent_blocks = 0;
+    return true;
+#else
+    return false;
 #endif
 }
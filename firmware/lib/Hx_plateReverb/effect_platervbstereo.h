@@ -49,10 +49,6 @@
 #include "arm_math.h"
 
 
-// if uncommented will place all the buffers in the DMAMEM section ofd the memory
-// works with single instance of the reverb only
-#define REVERB_USE_DMAMEM
-
 /***
  * Loop delay modulation: comment/uncomment to switch sin/cos 
  * modulation for the 1st or 2nd tap, 3rd tap is always modulated
@@ -61,12 +57,88 @@
 //#define TAP1_MODULATED
 #define TAP2_MODULATED
 
+// the original per sample kernel is used unless REVERB_STAGE_KERNEL is defined in the build flags
+// the stage by stage kernel gives the same output and is needed by the economy mode, the int16 storage and the block rate LFOs,
+// it measured slower than the original one on the host, it stays opt-in until a measurement on the Teensy shows it is faster
+#ifndef REVERB_STAGE_KERNEL
+#define REVERB_REFERENCE_KERNEL
+#endif
+
+// uncomment, or define REVERB_LFO_BLOCK_RATE in the build flags, to compute the LFOs at the start and end of each block
+// and linearly ramp them in between instead of for every sample, only used by the stage by stage kernel
+// no cpu saving has been measured for it yet, the exact per sample LFOs stay the default
+//#define REVERB_LFO_BLOCK_RATE
+
+// uncomment to store the allpass and delay lines as 16 bit fixed point instead of float, halving their memory
+// the arithmetic stays in float, only used by the stage by stage kernel
+//#define REVERB_INT16_STORAGE
+
+// uncomment, or define REVERB_ECONOMY_LINES in the build flags, to carve every line at half its length and always run
+// the loop at half the sample rate, halving memory_size(), economy(false) is then ignored, needs the stage by stage kernel
+//#define REVERB_ECONOMY_LINES
+
+#ifdef REVERB_ECONOMY_LINES
+#define REVERB_LINE_SHIFT   1
+#else
+#define REVERB_LINE_SHIFT   0
+#endif
+
+
+#ifdef REVERB_INT16_STORAGE
+typedef int16_t reverb_sample_t;
+#else
+typedef float32_t reverb_sample_t;
+#endif
+
 class AudioEffectPlateReverb : public AudioStream
 {
 public:
     AudioEffectPlateReverb();
     virtual void update();
 
+    // length of each line in samples at the full rate and a size scale of 1, in the order they are carved from the arena:
+    // input allpasses L then R, loop allpasses, loop delays
+    static constexpr uint16_t line_lengths[16] = {224, 420, 856, 1089, 156, 520, 956, 1289,
+                                                  2303, 2905, 3175, 2398, 3423, 4589, 4365, 3698};
+    // size scales accepted by begin()
+    static constexpr float min_scale = 0.25f;
+    static constexpr float max_scale = 2.0f;
+    // samples of a line at a size scale
+    static constexpr uint16_t scaled_len(uint16_t len, float scale) {return (uint16_t)(len * scale + 0.5f);}
+    // samples carved for a line, half of them with REVERB_ECONOMY_LINES
+    static constexpr size_t carved_len(uint16_t len) {return len >> REVERB_LINE_SHIFT;}
+    /**
+    * Bytes needed by one instance
+    * @param scale of the line lengths, as given to begin()
+    */
+    static constexpr size_t memory_size(float scale = 1.0f)
+    {
+        size_t samples = 0;
+        for (uint16_t len : line_lengths) samples += carved_len(scaled_len(len, scale));
+        return samples * sizeof(reverb_sample_t);
+    }
+
+    /**
+    * Give its lines to the reverb, which stays silent until then
+    * several instances can share an arena, each one starting where the previous one stopped
+    * @param arena memory for the lines, DMAMEM or EXTMEM
+    * @param arena_size in bytes
+    * @param scale of the line and tap lengths, from min_scale to max_scale, a smaller plate below 1
+    * with the stage by stage kernel every tap must still read more than a block ahead, which rules out scales below 1 at 128 samples per block
+    * @return the bytes used from the arena, 0 if it is too small or the scale is not accepted
+    */
+    size_t begin(void *arena, size_t arena_size, float scale = 1.0f);
+    /**
+    * Reverb of one block kept in float, for an object that calls the reverb itself instead of connecting it
+    * update() is this with the conversions from and to the int16 blocks of the graph
+    * @param input_blockL left input, +-1.0 full scale, nullptr for silence
+    * @param input_blockR right input, nullptr for silence
+    * @param output_blockL left output, +-1.0 full scale, not saturated
+    * @param output_blockR right output
+    * @return false when there is no output: no lines yet or asleep
+    */
+    bool process(const float32_t *input_blockL, const float32_t *input_blockR, float32_t *output_blockL, float32_t *output_blockR);
+
     void size(float n)
     {
         n = constrain(n, 0.0f, 1.0f);
@@ -116,70 +188,78 @@ public:
     bool get_bypass(void) {return bypass;}
     void set_bypass(bool state) {bypass = state;};
     void tgl_bypass(void) {bypass ^=1;}
+    bool get_asleep(void) {return asleep;}
+    // runs the loop at half the sample rate on half of each buffer, only used by the stage by stage kernel
+    // always on with REVERB_ECONOMY_LINES, the lines are too short for the full rate
+    void economy(bool state) {economy_mode = state || REVERB_LINE_SHIFT;}
+    bool get_economy(void) {return economy_mode;}
 private:
     bool bypass = false;
+    bool cleanup_done = false;      // buffers cleared since bypass was set
+    bool asleep = false;            // input and tail silent, nothing is computed until the input comes back
+    uint16_t silent_blocks = 0;     // consecutive blocks with a silent input and a loop below the sleep threshold
+    uint16_t sleep_blocks = 0;      // silent blocks before sleeping, longer than the longest loop line, set by begin()
+    bool economy_mode = REVERB_LINE_SHIFT;      // requested
+    bool economy_active = REVERB_LINE_SHIFT;    // used by the loop, changed between two blocks
+    float32_t decimate_histL[6] = {0};
+    float32_t decimate_histR[6] = {0};
+    float32_t interpolate_histL[3] = {0};
+    float32_t interpolate_histR[3] = {0};
+    void clear_buffers();
+    void reset_loop();
     audio_block_t *inputQueueArray[2];
-#ifndef REVERB_USE_DMAMEM
-    float32_t input_blockL[AUDIO_BLOCK_SAMPLES];
-    float32_t input_blockR[AUDIO_BLOCK_SAMPLES];
+#ifndef REVERB_REFERENCE_KERNEL
+    void loop_filter_span(const reverb_sample_t *buf, uint16_t len, uint16_t idx, float32_t &lpf, float32_t &hpf, float32_t rv_time, float32_t lowpass_f, float32_t hipass_f, float32_t *out, int n);
+    void process_loop(const float32_t *inL, const float32_t *inR, float32_t *outL, float32_t *outR, int n, uint8_t rate_shift);
 #endif
     float32_t input_attn;
 
     float32_t in_allp_k;            // input allpass coeff 
-#ifndef REVERB_USE_DMAMEM
-    float32_t in_allp1_bufL[224];   // input allpass buffers
-    float32_t in_allp2_bufL[420];
-    float32_t in_allp3_bufL[856];
-    float32_t in_allp4_bufL[1089];
-#endif
+    // line lengths at the full rate, set by begin() from line_lengths and the scale
+    uint16_t in_allp1_lenL, in_allp2_lenL, in_allp3_lenL, in_allp4_lenL;
+    uint16_t in_allp1_lenR, in_allp2_lenR, in_allp3_lenR, in_allp4_lenR;
+    uint16_t lp_allp1_len, lp_allp2_len, lp_allp3_len, lp_allp4_len;
+    uint16_t lp_dly1_len, lp_dly2_len, lp_dly3_len, lp_dly4_len;
+    reverb_sample_t *in_allp1_bufL = nullptr;   // input allpass buffers
+    reverb_sample_t *in_allp2_bufL = nullptr;
+    reverb_sample_t *in_allp3_bufL = nullptr;
+    reverb_sample_t *in_allp4_bufL = nullptr;
     uint16_t in_allp1_idxL;
     uint16_t in_allp2_idxL;
     uint16_t in_allp3_idxL;
     uint16_t in_allp4_idxL;
     float32_t in_allp_out_L;    // L allpass chain output
-#ifndef REVERB_USE_DMAMEM
-    float32_t in_allp1_bufR[156]; // input allpass buffers
-    float32_t in_allp2_bufR[520];
-    float32_t in_allp3_bufR[956];
-    float32_t in_allp4_bufR[1289];
-#endif
+    reverb_sample_t *in_allp1_bufR = nullptr; // input allpass buffers
+    reverb_sample_t *in_allp2_bufR = nullptr;
+    reverb_sample_t *in_allp3_bufR = nullptr;
+    reverb_sample_t *in_allp4_bufR = nullptr;
     uint16_t in_allp1_idxR;
     uint16_t in_allp2_idxR;
     uint16_t in_allp3_idxR;
     uint16_t in_allp4_idxR;
     float32_t in_allp_out_R;    // R allpass chain output
-#ifndef REVERB_USE_DMAMEM
-    float32_t lp_allp1_buf[2303]; // loop allpass buffers
-    float32_t lp_allp2_buf[2905];
-    float32_t lp_allp3_buf[3175];
-    float32_t lp_allp4_buf[2398];
-#endif
+    reverb_sample_t *lp_allp1_buf = nullptr; // loop allpass buffers
+    reverb_sample_t *lp_allp2_buf = nullptr;
+    reverb_sample_t *lp_allp3_buf = nullptr;
+    reverb_sample_t *lp_allp4_buf = nullptr;
     uint16_t lp_allp1_idx;
     uint16_t lp_allp2_idx;
     uint16_t lp_allp3_idx;
     uint16_t lp_allp4_idx;
     float32_t loop_allp_k;         // loop allpass coeff
     float32_t lp_allp_out;
-#ifndef REVERB_USE_DMAMEM
-    float32_t lp_dly1_buf[3423];
-    float32_t lp_dly2_buf[4589];
-    float32_t lp_dly3_buf[4365];
-    float32_t lp_dly4_buf[3698];
-#endif
+    reverb_sample_t *lp_dly1_buf = nullptr;
+    reverb_sample_t *lp_dly2_buf = nullptr;
+    reverb_sample_t *lp_dly3_buf = nullptr;
+    reverb_sample_t *lp_dly4_buf = nullptr;
     uint16_t lp_dly1_idx;
     uint16_t lp_dly2_idx;
     uint16_t lp_dly3_idx;
     uint16_t lp_dly4_idx;
 
-    const uint16_t lp_dly1_offset_L = 201;      // delay line tap offets
-    const uint16_t lp_dly2_offset_L = 145;
-    const uint16_t lp_dly3_offset_L = 1897;
-    const uint16_t lp_dly4_offset_L = 280;
-
-    const uint16_t lp_dly1_offset_R = 1897;
-    const uint16_t lp_dly2_offset_R = 1245;
-    const uint16_t lp_dly3_offset_R = 487;
-    const uint16_t lp_dly4_offset_R = 780;  
+    // delay line tap offets, at a size scale of 1: 201, 145, 1897, 280 for L and 1897, 1245, 487, 780 for R, scaled by begin()
+    uint16_t lp_dly1_offset_L, lp_dly2_offset_L, lp_dly3_offset_L, lp_dly4_offset_L;
+    uint16_t lp_dly1_offset_R, lp_dly2_offset_R, lp_dly3_offset_R, lp_dly4_offset_R;
 
     float32_t lp_hidamp_k;       // loop high band damping coeff
     float32_t lp_lodamp_k;       // loop low baand damping coeff
@@ -0,0 +1,42 @@
+#include "audio_latency_probe.h"
+
+audio_latency_probe::audio_latency_probe() : AudioStream(1, inputQueueArray){
+}
+
+void audio_latency_probe::update(void){
+    audio_block_t *block=receiveReadOnly();
+    if(!block){
+        return;
+    }
+    if(armed){
+        for(int i=0;i<AUDIO_BLOCK_SAMPLES;i++){
+            if(abs(block->data[i])>threshold){
+                latency=micros()+(uint32_t)(i*(1000000.0f/AUDIO_SAMPLE_RATE_EXACT))-arm_micros;
+                armed=false;
+                done=true;
+                break;
+            }
+        }
+    }
+    release(block);
+}
+
+void audio_latency_probe::arm(){
+    __disable_irq();
+    arm_micros=micros();
+    done=false;
+    armed=true;
+    __enable_irq();
+}
+
+bool audio_latency_probe::measured(){
+    return done;
+}
+
+uint32_t audio_latency_probe::latency_micros(){
+    return latency;
+}
+
+uint32_t audio_latency_probe::assumed_output_micros(){
+    return (uint32_t)(AUDIO_BLOCK_SAMPLES/2*(1000000.0f/AUDIO_SAMPLE_RATE_EXACT));
+}
@@ -0,0 +1,28 @@
+#ifndef AUDIO_LATENCY_PROBE_H
+#define AUDIO_LATENCY_PROBE_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+
+//times the first sound at the output after arm(), to compare the latency of builds with different block sizes
+//to be declared first in the graph and fed by the final output, so that a block arrives at the start of the update after the one computing it
+//what it measures ends with that update, where the I2S output takes the block, the time it then takes to play it is not measured:
+//assumed_output_micros() is the half block its DMA buffer is refilled by, from the buffer layout, to be checked on a scope at the DAC
+class audio_latency_probe : public AudioStream{
+  public:
+  audio_latency_probe();
+  virtual void update(void);
+  void arm(); //to be called with the note that is timed
+  bool measured(); //true once the note has been heard after arm()
+  uint32_t latency_micros(); //from arm() to the first sample above the threshold being taken by the I2S output
+  static uint32_t assumed_output_micros(); //I2S buffering after that, assumed and not measured
+  private:
+  audio_block_t *inputQueueArray[1];
+  volatile bool armed=false;
+  volatile bool done=false;
+  volatile uint32_t arm_micros=0;
+  volatile uint32_t latency=0;
+  int16_t threshold=256; //peak value from which the note is heard
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "audio_monitor.h"
+
+audio_monitor::audio_monitor() : AudioStream(2, inputQueueArray){
+}
+
+void audio_monitor::update(void){
+    bool silent=true;
+    for(int channel=0;channel<2;channel++){
+        audio_block_t *block=receiveReadOnly(channel);
+        if(!block){
+            continue;
+        }
+        for(int i=0;i<AUDIO_BLOCK_SAMPLES;i++){
+            if(abs(block->data[i])>silence_threshold){
+                silent=false;
+                break;
+            }
+        }
+        release(block);
+    }
+    if(!silent){
+        silent_blocks=0;
+    }else if(silent_blocks<silent_blocks_needed){
+        silent_blocks++;
+    }
+    last_update_micros=micros();
+    updates++;
+}
+
+uint32_t audio_monitor::micros_since_update(){
+    return micros()-last_update_micros;
+}
+
+uint32_t audio_monitor::update_count(){
+    return updates;
+}
+
+bool audio_monitor::is_silent(){
+    return silent_blocks>=silent_blocks_needed;
+}
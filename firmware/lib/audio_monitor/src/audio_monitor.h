@@ -0,0 +1,25 @@
+#ifndef AUDIO_MONITOR_H
+#define AUDIO_MONITOR_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+
+//watches the final stereo output, to be declared after every other audio object so that it is updated last
+//the loop can then tell how long ago the audio update finished and whether the output is silent
+class audio_monitor : public AudioStream{
+  public:
+  audio_monitor();
+  virtual void update(void);
+  uint32_t micros_since_update(); //time elapsed since the end of the last audio update
+  uint32_t update_count(); //number of audio updates so far, to do something once per update
+  bool is_silent(); //true when the output has been silent for a few blocks
+  private:
+  audio_block_t *inputQueueArray[2];
+  volatile uint32_t last_update_micros=0;
+  volatile uint32_t updates=0;
+  volatile uint16_t silent_blocks=0;
+  int16_t silence_threshold=16; //peak value under which a block is considered silent
+  uint16_t silent_blocks_needed=2048/AUDIO_BLOCK_SAMPLES; //2048 samples, about 46ms
+};
+
+#endif
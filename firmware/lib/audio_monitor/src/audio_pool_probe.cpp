@@ -0,0 +1,46 @@
+#include "audio_pool_probe.h"
+
+audio_pool_probe *audio_pool_probe::first_probe = nullptr;
+
+audio_pool_probe::audio_pool_probe(const char *name) : AudioStream(0, NULL){
+  this->name = name;
+  active = true; //updated without being connected
+  if(!first_probe){
+    first_probe = this;
+  }else{
+    audio_pool_probe *probe = first_probe;
+    while(probe->next_probe){
+      probe = probe->next_probe;
+    }
+    probe->next_probe = this;
+    previous_probe = probe;
+  }
+}
+
+void audio_pool_probe::update(void){
+  usage = AudioMemoryUsage();
+  if(usage > peak){
+    peak = usage;
+  }
+  if(previous_probe){
+    int16_t change = usage - previous_probe->usage;
+    if(change > peak_change){
+      peak_change = change;
+    }
+  }
+}
+
+void audio_pool_probe::report(Print &output){
+  for(audio_pool_probe *probe = first_probe; probe; probe = probe->next_probe){
+    output.printf("Audio pool at %s: %u blocks now, peak %u, peak taken since the previous probe %d\n", probe->name, probe->usage, probe->peak, probe->peak_change);
+  }
+}
+
+void audio_pool_probe::reset(){
+  for(audio_pool_probe *probe = first_probe; probe; probe = probe->next_probe){
+    __disable_irq();
+    probe->peak = probe->usage;
+    probe->peak_change = 0;
+    __enable_irq();
+  }
+}
@@ -0,0 +1,28 @@
+#ifndef AUDIO_POOL_PROBE_H
+#define AUDIO_POOL_PROBE_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+
+//reads the number of audio blocks in use at its place in the update order, to be declared between sections of the graph
+//the Teensy library only gives the usage of the whole pool, so the blocks taken by a section are seen as the change since the previous probe
+//the first probe of the graph sees the blocks held from one update to the next, mostly by the outputs
+//the peaks are per section, the blocks between two probes, not per object: a section holding many objects shows their sum at its worst moment
+//and the peak taken by a section and the peak of the next one may come from different updates, so the peaks of the sections do not add up to the pool peak
+class audio_pool_probe : public AudioStream{
+  public:
+  audio_pool_probe(const char *name);
+  virtual void update(void);
+  static void report(Print &output); //one line per probe, in update order
+  static void reset(); //forget the peaks, to measure a new performance
+  private:
+  static audio_pool_probe *first_probe;
+  audio_pool_probe *next_probe=nullptr;
+  audio_pool_probe *previous_probe=nullptr;
+  const char *name;
+  volatile uint16_t usage=0; //at this point of the last update
+  volatile uint16_t peak=0;
+  volatile int16_t peak_change=0; //largest increase since the previous probe within an update
+};
+
+#endif
@@ -0,0 +1,157 @@
+#include "feedback_delay.h"
+
+#define FADE_SAMPLES 1024 //length of the crossfade between two delay times, about 23 ms
+
+feedback_delay::feedback_delay() : AudioStream(1, inputQueueArray){
+  mix.gain(0, 1);
+  for(int i = 1; i < 4; i++){
+    mix.gain(i, 0);
+  }
+}
+
+void feedback_delay::begin(int16_t *memory, uint32_t length){
+  memset(memory, 0, length * sizeof(int16_t));
+  __disable_irq();
+  ring = memory;
+  ring_length = length;
+  write_position = 0;
+  if(target_delay > length){
+    target_delay = length;
+  }
+  tap_delay = target_delay;
+  fade_position = 0;
+  __enable_irq();
+}
+
+void feedback_delay::delay(float milliseconds){
+  if(milliseconds < 0.0f){
+    milliseconds = 0.0f;
+  }
+  uint32_t samples = memory_samples(milliseconds);
+  if(ring && samples > ring_length){
+    samples = ring_length;
+  }
+  target_delay = samples;
+}
+
+//one block starting delay_samples before the write position, never overlapping the block about to be written
+void feedback_delay::read_tap(uint32_t delay_samples, int16_t *output){
+  uint32_t position = write_position + ring_length - delay_samples;
+  if(position >= ring_length){
+    position -= ring_length;
+  }
+  uint32_t first_part = ring_length - position;
+  if(first_part >= AUDIO_BLOCK_SAMPLES){
+    memcpy(output, ring + position, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+  }else{
+    memcpy(output, ring + position, first_part * sizeof(int16_t));
+    memcpy(output + first_part, ring, (AUDIO_BLOCK_SAMPLES - first_part) * sizeof(int16_t));
+  }
+}
+
+void feedback_delay::write_ring(const int16_t *block){
+  uint32_t first_part = ring_length - write_position;
+  if(first_part > AUDIO_BLOCK_SAMPLES){
+    first_part = AUDIO_BLOCK_SAMPLES;
+  }
+  if(block){
+    memcpy(ring + write_position, block, first_part * sizeof(int16_t));
+    memcpy(ring, block + first_part, (AUDIO_BLOCK_SAMPLES - first_part) * sizeof(int16_t));
+  }else{
+    memset(ring + write_position, 0, first_part * sizeof(int16_t));
+    memset(ring, 0, (AUDIO_BLOCK_SAMPLES - first_part) * sizeof(int16_t));
+  }
+  write_position += AUDIO_BLOCK_SAMPLES;
+  if(write_position >= ring_length){
+    write_position -= ring_length;
+  }
+}
+
+void feedback_delay::update(void){
+  audio_block_t *input = receiveReadOnly();
+  if(!ring){
+    //no memory yet, the input goes through as the mixer alone would have given it
+    if(input){
+      audio_block_t *output = allocate();
+      if(output){
+        mix.mix_in(0, input->data, output->data, true);
+        transmit(output);
+        release(output);
+      }
+      release(input);
+    }
+    return;
+  }
+  if(suspended){
+    //only the input is kept, for the echoes after the restart
+    write_ring(input ? input->data : nullptr);
+    if(input){
+      release(input);
+    }
+    filter_stopped = true;
+    return;
+  }
+  if(filter_stopped){
+    //the tap fades in from silence over the crossfade of a change of delay time, instead of stepping to the echoes recorded meanwhile
+    filter.reset();
+    filter_stopped = false;
+    fade_delay = target_delay;
+    fade_position = 1;
+    fade_from_silence = true;
+  }
+  audio_block_t *output = allocate();
+  if(!output){
+    if(input){
+      release(input);
+    }
+    return;
+  }
+
+  //tap of the loop, crossfading to a new delay time when one was asked
+  int16_t delayed[AUDIO_BLOCK_SAMPLES];
+  read_tap(tap_delay, delayed);
+  if(fade_position == 0 && target_delay != tap_delay){
+    fade_delay = target_delay;
+    fade_position = 1;
+  }
+  if(fade_position){
+    int16_t faded[AUDIO_BLOCK_SAMPLES];
+    read_tap(fade_delay, faded);
+    if(fade_from_silence){
+      memset(delayed, 0, sizeof(delayed));
+    }
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      int32_t amount = (fade_position << 15) / FADE_SAMPLES;
+      delayed[i] = delayed[i] + (((faded[i] - delayed[i]) * amount) >> 15);
+      if(fade_position < FADE_SAMPLES){
+        fade_position++;
+      }
+    }
+    if(fade_position == FADE_SAMPLES){
+      tap_delay = fade_delay;
+      fade_position = 0;
+      fade_from_silence = false;
+    }
+  }
+
+  //feedback filter and mix, the same saturation as the mixer
+  int16_t low[AUDIO_BLOCK_SAMPLES];
+  int16_t band[AUDIO_BLOCK_SAMPLES];
+  int16_t high[AUDIO_BLOCK_SAMPLES];
+  filter.process(delayed, nullptr, low, band, high);
+  int16_t *out = output->data;
+  bool first = true;
+  if(input){
+    mix.mix_in(0, input->data, out, first);
+    first = false;
+    release(input);
+  }
+  mix.mix_in(1, low, out, first);
+  mix.mix_in(2, band, out, false);
+  mix.mix_in(3, high, out, false);
+
+  //the mix enters the ring
+  write_ring(out);
+  transmit(output);
+  release(output);
+}
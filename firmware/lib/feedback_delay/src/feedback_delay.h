@@ -0,0 +1,60 @@
+#ifndef FEEDBACK_DELAY_H
+#define FEEDBACK_DELAY_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+#include "voice_components.h"
+
+#define FEEDBACK_DELAY_LOOP_SAMPLES 128 //added to every delay time, the block the filter lagged by in the previous graph, whatever the block size now is
+
+#if AUDIO_BLOCK_SAMPLES > FEEDBACK_DELAY_LOOP_SAMPLES
+#error "the tap of the feedback delay would overlap the block being written"
+#endif
+
+//a delay with its feedback loop in a single audio object, replacing an AudioEffectDelay, the state variable filter after it and the mixer before it
+//the history is kept in a ring buffer given by the caller instead of queued audio blocks, so a long delay takes nothing from AudioMemory
+//output 0 is the mix of the input and the filtered feedback, as the mixer gave, and is also what enters the ring
+//the loop is 128 samples longer than the delay time, as it was when the filter read the delay output of the previous update with 128 sample blocks
+//this stays the same with smaller blocks, so that the presets keep their timing
+//a change of delay time crossfades from the old tap to the new one, a restart after a suspension fades the tap in from silence
+//the members carry the settings of the objects they replace: mix channel 0 input, 1 lowpass, 2 bandpass, 3 highpass feedback
+class feedback_delay : public AudioStream{
+  public:
+  feedback_delay();
+  virtual void update(void);
+  /**
+  * Give its ring buffer to the delay, which passes the input through until then
+  * @param memory ring buffer, DMAMEM or EXTMEM, cleared here
+  * @param length in samples, memory_samples() of the longest delay time
+  */
+  void begin(int16_t *memory, uint32_t length);
+  static constexpr uint32_t memory_samples(float milliseconds){
+    return (uint32_t)(milliseconds * (AUDIO_SAMPLE_RATE_EXACT / 1000.0f) + 0.5f) + FEEDBACK_DELAY_LOOP_SAMPLES;
+  }
+  void delay(float milliseconds); //limited to what the ring buffer holds
+  /**
+  * Stop or restart the loop of a delay whose output is not heard
+  * the filter restarts from rest, and the first echoes after a restart are those of the input recorded meanwhile, faded in
+  * @param suspended while true the input is only written to the ring, the loop is not computed and nothing is transmitted
+  */
+  void suspend(bool suspended){ this->suspended = suspended; }
+  bool is_suspended(){ return suspended; }
+  voice_filter filter;
+  voice_mixer mix;
+  private:
+  void read_tap(uint32_t delay_samples, int16_t *output);
+  void write_ring(const int16_t *block); //nullptr writes silence
+  audio_block_t *inputQueueArray[1];
+  int16_t *ring=nullptr;
+  uint32_t ring_length=0;
+  uint32_t write_position=0;
+  uint32_t tap_delay=FEEDBACK_DELAY_LOOP_SAMPLES; //samples from the write position to the block read, including the extra samples of the loop
+  volatile uint32_t target_delay=FEEDBACK_DELAY_LOOP_SAMPLES;
+  uint32_t fade_delay=FEEDBACK_DELAY_LOOP_SAMPLES; //tap faded in while fade_position runs
+  uint16_t fade_position=0; //0 when no crossfade is running
+  bool fade_from_silence=false; //the crossfade running is the fade in after a restart
+  volatile bool suspended=false;
+  bool filter_stopped=false; //the filter missed blocks while suspended
+};
+
+#endif
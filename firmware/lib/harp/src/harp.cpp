@@ -14,18 +14,51 @@ harp::harp(){}
   }
 
   void harp::recalibrate(){
-      Serial.println("reseting...");
+    start_calibration();
+    while (!calibration_step()){
+    }
+  }
+
+  void harp::start_calibration(){
+    Serial.println("reseting...");
+    ready=false;
     touch_sensor.reset();
-    delay(1000);
-    Serial.println("triggerCalibration");
-    touch_sensor.triggerCalibration();
-    delay(50);
-    while (touch_sensor.calibrating())
-    {
-      Serial.println("calibrating...");
-      delay(50);
+    calibration_timer=0;
+    calibration_state=CALIBRATION_RESET;
+  }
+
+  // the chip needs 1s after a reset, then the calibration is polled every 50ms
+  bool harp::calibration_step(){
+    switch (calibration_state){
+      case CALIBRATION_RESET:
+        if (calibration_timer<1000){
+          return false;
+        }
+        Serial.println("triggerCalibration");
+        touch_sensor.triggerCalibration();
+        calibration_timer=0;
+        calibration_state=CALIBRATION_RUNNING;
+        return false;
+      case CALIBRATION_RUNNING:
+        if (calibration_timer<50){
+          return false;
+        }
+        calibration_timer=0;
+        if (touch_sensor.calibrating()){
+          Serial.println("calibrating...");
+          return false;
+        }
+        Serial.println("finished calibrating"); 
+        configure_keys();
+        calibration_state=CALIBRATION_IDLE;
+        ready=true;
+        return true;
+      default:
+        return ready;
     }
-    Serial.println("finished calibrating"); 
+  }
+
+  void harp::configure_keys(){
     touch_sensor.setMeasurementIntervalCount(1);
     touch_sensor.setDetectionIntegrator(2); 
     touch_sensor.setTowardsDriftCompensationDuration(26);
@@ -61,6 +94,11 @@ harp::harp(){}
   }
 
   void harp::recalibrate(){
+    start_calibration();
+  }
+
+  // only register writes, the chip sets its baseline itself once the channels are started
+  void harp::start_calibration(){
     Serial.println("Recalibrating Harp");
     touch_sensor.setAllChannelsThresholds(touch_threshold,
     release_threshold);
@@ -80,7 +118,11 @@ harp::harp(){}
     touch_sensor.setSamplePeriod(MPR121::ADDRESS_5A,
     sample_period);
     touch_sensor.startAllChannels();
+    ready=true;
+  }
 
+  bool harp::calibration_step(){
+    return ready;
   }
 
 
@@ -96,3 +138,7 @@ harp::harp(){}
       }
   }
 #endif
+
+bool harp::is_ready(){
+  return ready;
+}
@@ -16,16 +16,24 @@ class harp{
   harp();
 
   void setup();
-  void recalibrate();
+  void recalibrate(); //blocking, waits for the end of the calibration
+  void start_calibration(); //non blocking, the calibration is then completed by calling calibration_step()
+  bool calibration_step(); //returns true once the calibration is done
+  bool is_ready(); //false until the calibration is done, the touch data should not be used before
   void update(debouncer (&data_array)[12]);
 
   private:
+  bool ready=false;
   #if CAP_CHIP==1
     AT42QT2120 touch_sensor;
     int remap_array[12]={3,4,5,6,7,8,9,10,11,2,1,0};
     int calibrated_val_array[12]={0,0,0,0,0,0,0,0,0,0,0,0};
     int threshold=12;
     float hysteresis=1.6;
+    enum calibration_states {CALIBRATION_IDLE, CALIBRATION_RESET, CALIBRATION_RUNNING};
+    calibration_states calibration_state=CALIBRATION_IDLE;
+    elapsedMillis calibration_timer;
+    void configure_keys();
   #else
     MPR121 touch_sensor;
     int remap_array[12]={11,9,7,6,8,10,0,2,4,5,3,1};
@@ -0,0 +1,180 @@
+#include "modulation_matrix.h"
+#include "Audio.h"
+#include "utility/dspinst.h"
+
+#define PULSE_WIDTH 0x40000000u //default of AudioSynthWaveform, also the rise of the variable triangle
+
+//>>LFO<<
+
+void control_lfo::begin(short type){
+  tone_type = type;
+}
+
+void control_lfo::frequency(float frequency){
+  if(frequency < 0.0f){
+    frequency = 0.0f;
+  }else if(frequency > MODULATION_MAX_FREQUENCY){
+    frequency = MODULATION_MAX_FREQUENCY;
+  }
+  block_increment = frequency * (4294967296.0f * AUDIO_BLOCK_SAMPLES / AUDIO_SAMPLE_RATE_EXACT);
+}
+
+void control_lfo::amplitude(float level){
+  if(level < 0.0f){
+    level = 0.0f;
+  }else if(level > 1.0f){
+    level = 1.0f;
+  }
+  magnitude = level * 65536.0f;
+}
+
+void control_lfo::offset(float level){
+  if(level < -1.0f){
+    level = -1.0f;
+  }else if(level > 1.0f){
+    level = 1.0f;
+  }
+  level_offset = level * 32767.0f;
+}
+
+void control_lfo::advance(){
+  uint32_t prior_phase = phase;
+  phase += block_increment;
+  if(phase < prior_phase){
+    held_sample = random(65536) - 32768;
+  }
+}
+
+//the formulas of AudioSynthWaveform, the band limited shapes are the same at these rates
+int32_t control_lfo::shape(int32_t level){
+  uint32_t ph = phase;
+  int16_t level15 = signed_saturate_rshift(level, 16, 1);
+  switch(tone_type){
+    case WAVEFORM_SINE:{
+      uint32_t index = ph >> 24;
+      uint32_t fraction = (ph >> 8) & 0xFFFF;
+      int32_t value = AudioWaveformSine[index] * (int32_t)(0x10000 - fraction) + AudioWaveformSine[index + 1] * (int32_t)fraction;
+      return multiply_32x32_rshift32(value, level);
+    }
+    case WAVEFORM_SQUARE:
+    case WAVEFORM_BANDLIMIT_SQUARE:
+      return (ph & 0x80000000) ? -level15 : level15;
+    case WAVEFORM_PULSE:
+    case WAVEFORM_BANDLIMIT_PULSE:
+      return (ph < PULSE_WIDTH) ? level15 : -level15;
+    case WAVEFORM_SAWTOOTH:
+    case WAVEFORM_BANDLIMIT_SAWTOOTH:
+      return signed_multiply_32x16t(level, ph);
+    case WAVEFORM_SAWTOOTH_REVERSE:
+    case WAVEFORM_BANDLIMIT_SAWTOOTH_REVERSE:
+      return signed_multiply_32x16t(0xFFFFFFFFu - level, ph);
+    case WAVEFORM_TRIANGLE:{
+      uint32_t phtop = ph >> 30;
+      if(phtop == 1 || phtop == 2){
+        return (int16_t)(((0xFFFF - (ph >> 15)) * level) >> 16); //wraps as the int16_t sample of AudioSynthWaveform
+      }
+      return (int16_t)((((int32_t)ph >> 15) * level) >> 16);
+    }
+    case WAVEFORM_TRIANGLE_VARIABLE:{
+      //rises from 0 to full scale over half the width, falls to minus full scale, rises back to 0 over the other half
+      const uint32_t half = PULSE_WIDTH / 2;
+      int32_t value;
+      if(ph < half){
+        value = ((uint64_t)ph * 0x7FFFFFFF) / half;
+      }else if(ph < 0xFFFFFFFFu - half){
+        value = (int64_t)0x7FFFFFFF - (int64_t)(((uint64_t)(ph - half) * 0xFFFFFFFEu) / (0xFFFFFFFFu - PULSE_WIDTH));
+      }else{
+        value = (int32_t)(((uint64_t)(ph - (0xFFFFFFFFu - half)) * 0x7FFFFFFF) / half) - 0x7FFFFFFF;
+      }
+      return multiply_32x32_rshift32(value, level);
+    }
+    case WAVEFORM_SAMPLE_HOLD:
+      return (held_sample * level) >> 16;
+    default:
+      return 0;
+  }
+}
+
+int32_t control_lfo::output(){
+  int32_t level = magnitude;
+  if(level == 0){
+    return 0;
+  }
+  return signed_saturate_rshift(shape(level) + level_offset, 16, 0);
+}
+
+//>>MATRIX<<
+
+modulation_matrix::modulation_matrix() : AudioStream(0, NULL){
+}
+
+void modulation_matrix::route_source(uint8_t route, uint8_t source){
+  if(route < MODULATION_ROUTES){
+    sources[route] = source <= MODULATION_LFOS ? source : 0;
+  }
+}
+
+void modulation_matrix::route_destination(uint8_t route, uint8_t destination){
+  if(route < MODULATION_ROUTES){
+    destinations[route] = destination;
+  }
+}
+
+void modulation_matrix::route_depth(uint8_t route, float depth){
+  if(depth < 0.0f){
+    depth = 0.0f;
+  }else if(depth > 1.0f){
+    depth = 1.0f;
+  }
+  if(route < MODULATION_ROUTES){
+    depths[route] = depth;
+  }
+}
+
+uint8_t modulation_matrix::sysex_destination(uint8_t route){
+  if(route >= MODULATION_ROUTES || !sources[route] || destinations[route] < MODULATION_FIRST_ADDRESS){
+    return 0;
+  }
+  return destinations[route];
+}
+
+float modulation_matrix::route_value(uint8_t route){
+  return route < MODULATION_ROUTES ? values[route] : 0.0f;
+}
+
+void modulation_matrix::update(void){
+  int32_t targets[MODULATION_LFOS];
+  for(int n = 0; n < MODULATION_LFOS; n++){
+    lfo[n].advance();
+    targets[n] = lfo[n].output();
+  }
+  for(int r = 0; r < MODULATION_ROUTES; r++){
+    uint8_t source = sources[r];
+    uint8_t destination = destinations[r];
+    float value = source ? depths[r] * lfo[source - 1].shape(65536) * (1.0f / 32767.0f) : 0.0f;
+    if(destination >= 1 && destination <= MODULATION_LFOS){
+      targets[destination - 1] += (int32_t)(value * 32767.0f);
+      value = 0.0f;
+    }
+    values[r] = value;
+  }
+
+  for(int n = 0; n < MODULATION_LFOS; n++){
+    int32_t target = signed_saturate_rshift(targets[n], 16, 0);
+    int32_t start = last[n];
+    last[n] = target;
+    if(target == 0 && start == 0){
+      continue;
+    }
+    audio_block_t *block = allocate();
+    if(!block){
+      continue;
+    }
+    int32_t difference = target - start;
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      block->data[i] = start + difference * (i + 1) / AUDIO_BLOCK_SAMPLES;
+    }
+    transmit(block, n);
+    release(block);
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef MODULATION_MATRIX_H
+#define MODULATION_MATRIX_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+
+#define MODULATION_LFOS 6 //also the number of outputs, output n carries LFO n
+#define MODULATION_ROUTES 4
+#define MODULATION_FIRST_ADDRESS 21 //route destinations from here are sysex addresses, below they are output numbers + 1
+#define MODULATION_MAX_FREQUENCY (AUDIO_SAMPLE_RATE_EXACT / AUDIO_BLOCK_SAMPLES / 8) //eight blocks per cycle at least
+
+//an LFO evaluated once per block, with the setters, shapes and levels of the AudioSynthWaveform it replaces
+//the frequency is limited to MODULATION_MAX_FREQUENCY so that the ramps between two blocks keep the shape
+class control_lfo{
+  public:
+  void begin(short type);
+  void frequency(float frequency);
+  void amplitude(float level);
+  void offset(float level);
+  private:
+  friend class modulation_matrix;
+  void advance(); //to the last sample of the next block
+  int32_t shape(int32_t level); //at the current phase, level 65536 for full scale
+  int32_t output(); //with the amplitude and offset, 0 at 0 amplitude as AudioSynthWaveform transmitted nothing
+  uint32_t phase=0;
+  volatile uint32_t block_increment=0;
+  volatile int32_t magnitude=0;
+  volatile int32_t level_offset=0;
+  int16_t held_sample=0; //of the sample and hold, full scale
+  volatile short tone_type=0;
+};
+
+//the LFOs of the synth, evaluated once per audio block instead of generating every sample
+//output n carries LFO n with its amplitude and offset, as the LFO object it replaces did
+//the routes add the shape of an LFO, at their own depth, to an output or to a sysex parameter
+//an output block is a ramp from the value at the end of the previous block to the value at the end of this one
+//an output that stays at 0 transmits nothing
+class modulation_matrix : public AudioStream{
+  public:
+  modulation_matrix();
+  virtual void update(void);
+  control_lfo lfo[MODULATION_LFOS];
+  void route_source(uint8_t route, uint8_t source); //LFO number + 1, 0 for none
+  void route_destination(uint8_t route, uint8_t destination); //output number + 1, a sysex address from MODULATION_FIRST_ADDRESS, 0 for none
+  void route_depth(uint8_t route, float depth); //0 to 1.0
+  uint8_t sysex_destination(uint8_t route); //the address modulated by the route, 0 when it modulates no sysex parameter
+  float route_value(uint8_t route); //+-depth, as of the last block, for a sysex destination
+  private:
+  int16_t last[MODULATION_LFOS]={}; //value at the end of the previous block
+  volatile uint8_t sources[MODULATION_ROUTES]={};
+  volatile uint8_t destinations[MODULATION_ROUTES]={};
+  volatile float depths[MODULATION_ROUTES]={};
+  volatile float values[MODULATION_ROUTES]={};
+};
+
+#endif
@@ -0,0 +1,350 @@
+#include "preset_storage.h"
+
+preset_storage::preset_storage(){
+    memset(bank_data, 0, sizeof(bank_data));
+    memset(bank_ram, 0, sizeof(bank_ram));
+    memset(changed, 0, sizeof(changed));
+    memset(full_save, 0, sizeof(full_save));
+    memset(generation, 0, sizeof(generation));
+    memset(journal_records, 0, sizeof(journal_records));
+    memset(loaded, 0, sizeof(loaded));
+}
+
+void preset_storage::setup(FS *filesystem, const char *const *bank_names, const int16_t (*factory_parameters)[PRESET_PARAMETER_COUNT]){
+    this->filesystem = filesystem;
+    this->bank_names = bank_names;
+    this->factory_parameters = factory_parameters;
+    // the journal of "a.txt" is "a.jnl"
+    for (uint8_t i = 0; i < PRESET_BANK_COUNT; i++) {
+        strncpy(journal_names[i], bank_names[i], sizeof(journal_names[i]) - 5);
+        journal_names[i][sizeof(journal_names[i]) - 5] = '\0';
+        char *extension = strchr(journal_names[i], '.');
+        if (extension) *extension = '\0';
+        strcat(journal_names[i], ".jnl");
+    }
+}
+
+void preset_storage::begin_load(){
+    cancel_save();
+    memset(loaded, 0, sizeof(loaded));
+}
+
+void preset_storage::load(uint8_t bank_number){
+    if (bank_number >= PRESET_BANK_COUNT || loaded[bank_number]) return;
+    memset(changed[bank_number], 0, sizeof(changed[bank_number]));
+    full_save[bank_number] = false;
+    generation[bank_number] = 0;
+    journal_records[bank_number] = 0;
+    bank_data[bank_number] = factory_parameters[bank_number];
+    loaded[bank_number] = true;
+    if (!load_bank(bank_number)) {
+        Serial.print("No preset, using factory default for bank ");
+        Serial.println(bank_number);
+        reset(bank_number); //will be written to the filesystem at the next save
+    }
+}
+
+bool preset_storage::load_step(){
+    for (uint8_t i = 0; i < PRESET_BANK_COUNT; i++) {
+        if (!loaded[i]) {
+            load(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void preset_storage::load_all(){
+    begin_load();
+    while (load_step()) {
+    }
+}
+
+void preset_storage::read(uint8_t bank_number, int16_t *data_array){
+    if (bank_number >= PRESET_BANK_COUNT) return;
+    load(bank_number);
+    memcpy(data_array, bank_data[bank_number], sizeof(bank_ram[bank_number]));
+    data_array[0] = 0;
+    data_array[1] = bank_number;
+}
+
+void preset_storage::write(uint8_t bank_number, const int16_t *data_array){
+    if (bank_number >= PRESET_BANK_COUNT) return;
+    load(bank_number);
+    // index 0 and 1 are the control command and bank ID, not preset values
+    for (uint16_t i = 2; i < PRESET_PARAMETER_COUNT; i++) {
+        if (bank_data[bank_number][i] != data_array[i]) {
+            set_parameter(bank_number, i, data_array[i]);
+            changed[bank_number][i / 8] |= 1 << (i % 8);
+        }
+    }
+}
+
+void preset_storage::reset(uint8_t bank_number){
+    if (bank_number >= PRESET_BANK_COUNT) return;
+    load(bank_number); // the generation of the current base is needed for the next save
+    bank_data[bank_number] = factory_parameters[bank_number];
+    full_save[bank_number] = true;
+}
+
+bool preset_storage::save_step(bool erase_allowed){
+    switch (save_state) {
+    case SAVE_IDLE: // no flash access, only pick the bank and encode it
+        for (uint8_t i = 0; i < PRESET_BANK_COUNT; i++) {
+            if (is_dirty(i)) {
+                start_save(i);
+                return true;
+            }
+        }
+        return false;
+    case SAVE_OPEN: // directory update, can trigger a metadata compaction
+        if (!erase_allowed) return true;
+        if (save_journal) {
+            if (journal_records[save_bank] == 0 && filesystem->exists(journal_names[save_bank])) {
+                filesystem->remove(journal_names[save_bank]); // written for an older base
+                return true;
+            }
+            save_file = filesystem->open(journal_names[save_bank], FILE_WRITE); // appending
+        } else {
+            if (filesystem->exists(PRESET_SAVE_TEMP_NAME)) {
+                filesystem->remove(PRESET_SAVE_TEMP_NAME); // left over from an interrupted save
+                return true;
+            }
+            save_file = filesystem->open(PRESET_SAVE_TEMP_NAME, FILE_WRITE);
+        }
+        if (!save_file) {
+            Serial.printf("Error: could not write bank %d\n", save_bank);
+            cancel_save();
+            return false;
+        }
+        save_state = SAVE_WRITE;
+        return true;
+    case SAVE_WRITE: {
+        // the first chunk is kept inline in the directory, the second one moves the file to its own sector which is erased
+        // the following chunks each fill the cache once and are a single flash program
+        // the journal always stays inline, its content only reaches the flash when the file is closed
+        if (!save_journal && save_offset == PRESET_SAVE_CHUNK_SIZE && !erase_allowed) return true;
+        uint16_t chunk = min((uint16_t)PRESET_SAVE_CHUNK_SIZE, (uint16_t)(save_length - save_offset));
+        if (save_file.write(save_pointer + save_offset, chunk) != chunk) {
+            Serial.printf("Error: could not write bank %d\n", save_bank);
+            cancel_save();
+            return false;
+        }
+        save_offset += chunk;
+        if (save_offset >= save_length) {
+            save_state = SAVE_CLOSE;
+        }
+        return true;
+    }
+    case SAVE_CLOSE: // last program and directory update
+        if (!erase_allowed) return true;
+        save_file.close();
+        if (save_journal) {
+            journal_records[save_bank] += save_records;
+            save_state = SAVE_IDLE;
+            Serial.print("Saved preset changes: ");
+            Serial.println(journal_names[save_bank]);
+            return false;
+        }
+        save_state = SAVE_RENAME;
+        return true;
+    case SAVE_RENAME: // the old bank file is only replaced once the new one is complete
+        if (!erase_allowed) return true;
+        if (!filesystem->rename(PRESET_SAVE_TEMP_NAME, bank_names[save_bank])) {
+            Serial.printf("Error: could not write bank %d\n", save_bank);
+            cancel_save();
+            return false;
+        }
+        // from here the old journal no longer matches the generation of the base
+        generation[save_bank] = save_generation;
+        journal_records[save_bank] = 0;
+        save_data = "";
+        save_state = SAVE_REMOVE_JOURNAL;
+        Serial.print("Saved preset: ");
+        Serial.println(bank_names[save_bank]);
+        return true;
+    case SAVE_REMOVE_JOURNAL:
+        if (!erase_allowed) return true;
+        if (filesystem->exists(journal_names[save_bank])) {
+            filesystem->remove(journal_names[save_bank]);
+        }
+        save_state = SAVE_IDLE;
+        return false;
+    }
+    return false;
+}
+
+void preset_storage::cancel_save(){
+    if (save_state == SAVE_IDLE) return;
+    if (save_state == SAVE_WRITE || save_state == SAVE_CLOSE) {
+        save_file.close();
+    }
+    full_save[save_bank] = true; // the changes taken by this save are no longer tracked
+    save_data = "";
+    save_state = SAVE_IDLE;
+}
+
+bool preset_storage::is_dirty(uint8_t bank_number){
+    if (bank_number >= PRESET_BANK_COUNT) return false;
+    if (full_save[bank_number]) return true;
+    for (uint8_t i = 0; i < sizeof(changed[bank_number]); i++) {
+        if (changed[bank_number][i]) return true;
+    }
+    return false;
+}
+
+bool preset_storage::any_dirty(){
+    for (uint8_t i = 0; i < PRESET_BANK_COUNT; i++) {
+        if (is_dirty(i)) return true;
+    }
+    return false;
+}
+
+void preset_storage::start_save(uint8_t bank_number){
+    save_bank = bank_number;
+    uint16_t changed_count = 0;
+    for (uint16_t i = 2; i < PRESET_PARAMETER_COUNT; i++) {
+        if (changed[bank_number][i / 8] & (1 << (i % 8))) changed_count++;
+    }
+    uint16_t header_count = journal_records[bank_number] == 0 ? 1 : 0;
+    save_journal = !full_save[bank_number] && journal_records[bank_number] + header_count + changed_count <= PRESET_JOURNAL_MAX_RECORDS;
+    if (save_journal) {
+        // a few records appended to the journal, the first one tells which base it applies to
+        save_length = 0;
+        if (header_count) {
+            encode_record(journal_buffer, 0, generation[bank_number]);
+            save_length += PRESET_JOURNAL_RECORD_SIZE;
+        }
+        for (uint16_t i = 2; i < PRESET_PARAMETER_COUNT; i++) {
+            if (changed[bank_number][i / 8] & (1 << (i % 8))) {
+                encode_record(journal_buffer + save_length, i, bank_data[bank_number][i]);
+                save_length += PRESET_JOURNAL_RECORD_SIZE;
+            }
+        }
+        save_records = header_count + changed_count;
+        save_pointer = journal_buffer;
+    } else {
+        // compaction of the whole bank in a new base
+        save_generation = (generation[bank_number] + 1) & 0x7FFF;
+        save_data = serialize(bank_number, save_generation);
+        save_length = save_data.length();
+        save_pointer = (const uint8_t *)save_data.c_str();
+    }
+    memset(changed[bank_number], 0, sizeof(changed[bank_number])); // a write during the save will flag them again
+    full_save[bank_number] = false;
+    save_offset = 0;
+    save_state = SAVE_OPEN;
+}
+
+bool preset_storage::load_bank(uint8_t bank_number){
+    File entry = filesystem->open(bank_names[bank_number]);
+    if (!entry) return false;
+    int len = entry.size();
+    char data_string[len + 1];
+    len = entry.read(data_string, len);
+    data_string[len] = '\0';
+    entry.close();
+    if (len == 0) return false;
+    deserialize(data_string, bank_number);
+    replay_journal(bank_number);
+    return true;
+}
+
+void preset_storage::replay_journal(uint8_t bank_number){
+    File entry = filesystem->open(journal_names[bank_number]);
+    if (!entry) return;
+    uint8_t records_buffer[PRESET_JOURNAL_MAX_RECORDS * PRESET_JOURNAL_RECORD_SIZE]; // not journal_buffer, a save in progress may still be writing from it
+    int len = entry.read(records_buffer, sizeof(records_buffer));
+    bool complete = entry.size() == (uint32_t)len && len % PRESET_JOURNAL_RECORD_SIZE == 0;
+    entry.close();
+    uint8_t address;
+    int16_t value;
+    if (len < PRESET_JOURNAL_RECORD_SIZE || !decode_record(records_buffer, &address, &value) || address != 0 || value != generation[bank_number]) {
+        return; // written for an older base, replaced at the next save
+    }
+    uint8_t records = 1;
+    while ((records + 1) * PRESET_JOURNAL_RECORD_SIZE <= len && decode_record(records_buffer + records * PRESET_JOURNAL_RECORD_SIZE, &address, &value) && address >= 2) {
+        set_parameter(bank_number, address, value);
+        records++;
+    }
+    if (records * PRESET_JOURNAL_RECORD_SIZE != len || !complete) {
+        // torn or corrupted record, nothing can be appended after it so the next save compacts the bank
+        Serial.printf("Journal of bank %d truncated after %d records\n", bank_number, records);
+        records = PRESET_JOURNAL_MAX_RECORDS;
+    }
+    journal_records[bank_number] = records;
+}
+
+// "generation,bank,d," followed by "address,value," for each parameter that differs from the factory preset
+String preset_storage::serialize(uint8_t bank_number, int16_t base_generation){
+    String data_string = String(base_generation); // the control command slot holds the generation of the base
+    data_string += ",";
+    data_string += String(bank_number); // to save the number of the bank for the online display
+    data_string += ",d,";
+    if (bank_data[bank_number] != factory_parameters[bank_number]) {
+        for (uint16_t i = 2; i < PRESET_PARAMETER_COUNT; i++) {
+            if (bank_data[bank_number][i] != factory_parameters[bank_number][i]) {
+                data_string += String(i);
+                data_string += ",";
+                data_string += String(bank_data[bank_number][i]);
+                data_string += ",";
+            }
+        }
+    }
+    data_string += "\r\n";
+    return data_string;
+}
+
+// also reads the older files holding all the parameters in order, which are converted at the next save
+void preset_storage::deserialize(char *input, uint8_t bank_number){
+    char *p = strtok(input, ",");
+    if (!p) return;
+    generation[bank_number] = atoi(p);
+    p = strtok(NULL, ","); // bank ID, given by the file name
+    p = strtok(NULL, ",");
+    if (p && strcmp(p, "d") == 0) {
+        p = strtok(NULL, ",");
+        while (p) {
+            int address = atoi(p);
+            p = strtok(NULL, ",");
+            if (!p) break; // end of line
+            if (address >= 2 && address < PRESET_PARAMETER_COUNT) {
+                set_parameter(bank_number, address, atoi(p));
+            }
+            p = strtok(NULL, ",");
+        }
+        return;
+    }
+    int i = 2;
+    while (p && i < PRESET_PARAMETER_COUNT) {
+        set_parameter(bank_number, i, atoi(p));
+        p = strtok(NULL, ",");
+        i++;
+    }
+    full_save[bank_number] = true;
+}
+
+// the factory table is copied in RAM on the first change
+void preset_storage::set_parameter(uint8_t bank_number, uint8_t address, int16_t value){
+    if (bank_data[bank_number][address] == value) return;
+    if (bank_data[bank_number] != bank_ram[bank_number]) {
+        memcpy(bank_ram[bank_number], bank_data[bank_number], sizeof(bank_ram[bank_number]));
+        bank_data[bank_number] = bank_ram[bank_number];
+    }
+    bank_ram[bank_number][address] = value;
+}
+
+// address, value as little endian, and a check byte so that a torn or erased record is not replayed
+void preset_storage::encode_record(uint8_t *record, uint8_t address, int16_t value){
+    record[0] = address;
+    record[1] = value & 0xFF;
+    record[2] = (value >> 8) & 0xFF;
+    record[3] = record[0] ^ record[1] ^ record[2] ^ 0x5A;
+}
+
+bool preset_storage::decode_record(const uint8_t *record, uint8_t *address, int16_t *value){
+    if ((record[0] ^ record[1] ^ record[2] ^ 0x5A) != record[3]) return false;
+    *address = record[0];
+    *value = (int16_t)(record[1] | (record[2] << 8));
+    return true;
+}
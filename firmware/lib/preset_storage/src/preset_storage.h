@@ -0,0 +1,81 @@
+#ifndef PRESET_STORAGE_H
+#define PRESET_STORAGE_H
+
+#include "Arduino.h"
+#include <FS.h>
+
+#define PRESET_BANK_COUNT 12
+#define PRESET_PARAMETER_COUNT 256
+#define PRESET_SAVE_CHUNK_SIZE 128 //matches the LittleFS cache, so each chunk is at most one flash program
+#define PRESET_SAVE_TEMP_NAME "save.tmp"
+#define PRESET_JOURNAL_RECORD_SIZE 4
+#define PRESET_JOURNAL_MAX_RECORDS 32 //header included, keeps the journal small enough to be stored inline by LittleFS
+
+//keeps every bank decoded in RAM so that switching preset never touches the flash
+//banks modified in RAM are flagged as dirty and written back to the filesystem by save_step()
+//a save is split in slices so that no single call keeps the flash busy for long
+//each bank is a base file plus a journal of the parameters changed since, which is compacted into the base when full
+//the base file only holds the parameters that differ from the factory preset, kept in flash
+class preset_storage{
+  public:
+  preset_storage();
+  /**
+  * @param filesystem the filesystem holding one file per bank
+  * @param bank_names the file name of each bank
+  * @param factory_parameters the factory value of each bank, in flash
+  */
+  void setup(FS *filesystem, const char *const *bank_names, const int16_t (*factory_parameters)[PRESET_PARAMETER_COUNT]);
+  void begin_load(); //to be called once the filesystem is mounted, the banks are then decoded in RAM when first used or by load_step()
+  void load(uint8_t bank_number); //decode a bank now if it was not yet
+  bool load_step(); //decode the next bank not yet loaded, returns false once all are
+  void load_all();
+  void read(uint8_t bank_number, int16_t *data_array); //copy a bank from RAM
+  void write(uint8_t bank_number, const int16_t *data_array); //copy to a bank in RAM and flag it for write back
+  void reset(uint8_t bank_number); //go back to the factory value and flag it for write back
+  /**
+  * Advance the write back of the dirty banks by one slice
+  * @param erase_allowed false to postpone the slices that can erase a flash sector
+  * @return true while a save is in progress
+  */
+  bool save_step(bool erase_allowed);
+  void cancel_save(); //drop the save in progress, the whole bank will be saved again
+  bool is_dirty(uint8_t bank_number);
+  bool any_dirty();
+
+  private:
+  enum save_states {SAVE_IDLE, SAVE_OPEN, SAVE_WRITE, SAVE_CLOSE, SAVE_RENAME, SAVE_REMOVE_JOURNAL};
+  bool load_bank(uint8_t bank_number);
+  void replay_journal(uint8_t bank_number);
+  void start_save(uint8_t bank_number);
+  String serialize(uint8_t bank_number, int16_t base_generation);
+  void deserialize(char *input, uint8_t bank_number);
+  void set_parameter(uint8_t bank_number, uint8_t address, int16_t value);
+  void encode_record(uint8_t *record, uint8_t address, int16_t value);
+  bool decode_record(const uint8_t *record, uint8_t *address, int16_t *value);
+  FS *filesystem=nullptr;
+  const char *const *bank_names=nullptr;
+  char journal_names[PRESET_BANK_COUNT][16];
+  const int16_t (*factory_parameters)[PRESET_PARAMETER_COUNT]=nullptr;
+  const int16_t *bank_data[PRESET_BANK_COUNT]; //the factory table until the bank is modified, then its RAM copy
+  int16_t bank_ram[PRESET_BANK_COUNT][PRESET_PARAMETER_COUNT];
+  //write back state of each bank
+  uint8_t changed[PRESET_BANK_COUNT][PRESET_PARAMETER_COUNT / 8]; //one bit per parameter changed since the last save
+  bool full_save[PRESET_BANK_COUNT]; //the base file has to be rewritten, also to convert a file holding all the parameters
+  int16_t generation[PRESET_BANK_COUNT]; //of the base file, a journal is only replayed on the base it was written for
+  uint8_t journal_records[PRESET_BANK_COUNT]; //valid records in the journal file, 0 if there is none
+  bool loaded[PRESET_BANK_COUNT];
+  //save in progress
+  save_states save_state=SAVE_IDLE;
+  uint8_t save_bank=0;
+  bool save_journal=false; //appending to the journal instead of rewriting the base
+  int16_t save_generation=0;
+  String save_data;
+  uint8_t journal_buffer[PRESET_JOURNAL_MAX_RECORDS * PRESET_JOURNAL_RECORD_SIZE]; //records of the journal save in progress, only used by the save
+  const uint8_t *save_pointer=nullptr;
+  uint16_t save_length=0;
+  uint16_t save_offset=0;
+  uint8_t save_records=0;
+  File save_file;
+};
+
+#endif
@@ -0,0 +1,41 @@
+#include "section_filter.h"
+
+section_filter::section_filter() : AudioStream(2, inputQueueArray){
+}
+
+void section_filter::update(void){
+  audio_block_t *input = receiveReadOnly(0);
+  audio_block_t *control = receiveReadOnly(1);
+  if(suspended){
+    filter_stopped = true;
+  }else if(input){
+    if(filter_stopped){
+      filter.reset();
+      filter_stopped = false;
+    }
+    audio_block_t *lowpass = allocate();
+    audio_block_t *bandpass = allocate();
+    audio_block_t *highpass = allocate();
+    if(lowpass && bandpass && highpass){
+      filter.process(input->data, control ? control->data : nullptr, lowpass->data, bandpass->data, highpass->data);
+      transmit(lowpass, 0);
+      transmit(bandpass, 1);
+      transmit(highpass, 2);
+    }
+    if(lowpass){
+      release(lowpass);
+    }
+    if(bandpass){
+      release(bandpass);
+    }
+    if(highpass){
+      release(highpass);
+    }
+  }
+  if(input){
+    release(input);
+  }
+  if(control){
+    release(control);
+  }
+}
@@ -0,0 +1,31 @@
+#ifndef SECTION_FILTER_H
+#define SECTION_FILTER_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+#include "voice_components.h"
+
+//an AudioFilterStateVariable that can be suspended while its outputs are not heard, filtering with voice_filter
+//an AudioFilterStateVariable cut at its input keeps its state and plays it back once reconnected, this one restarts from rest
+//input 0 signal, 1 corner control, output 0 lowpass, 1 bandpass, 2 highpass, as AudioFilterStateVariable
+class section_filter : public AudioStream{
+  public:
+  section_filter();
+  virtual void update(void);
+  void frequency(float frequency){ filter.frequency(frequency); }
+  void resonance(float q){ filter.resonance(q); }
+  void octaveControl(float octaves){ filter.octaveControl(octaves); }
+  /**
+  * Stop or restart a filter whose outputs are not heard
+  * @param suspended while true the inputs are released unread and nothing is transmitted, the filter restarts from rest after
+  */
+  void suspend(bool suspended){ this->suspended = suspended; }
+  bool is_suspended(){ return suspended; }
+  private:
+  voice_filter filter;
+  audio_block_t *inputQueueArray[2];
+  volatile bool suspended=false;
+  bool filter_stopped=false; //the filter missed blocks while suspended
+};
+
+#endif
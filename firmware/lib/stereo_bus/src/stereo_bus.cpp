@@ -0,0 +1,101 @@
+#include "stereo_bus.h"
+
+//reverb return added to a dry sum in float, then saturated once
+static void mix_return(const float32_t *wet, int16_t *output, bool first){
+  for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+    float32_t sample = wet[i] * 32767.0f;
+    if(!first){
+      sample += output[i];
+    }
+    output[i] = sample > 32767.0f ? 32767 : (sample < -32768.0f ? -32768 : (int16_t)sample);
+  }
+}
+
+stereo_bus::stereo_bus() : AudioStream(2, inputQueueArray){
+}
+
+void stereo_bus::update(void){
+  audio_block_t *inputs[2];
+  for(int i = 0; i < 2; i++){
+    inputs[i] = receiveReadOnly(i);
+  }
+  audio_block_t *left = allocate();
+  audio_block_t *right = allocate();
+  int16_t amplified[AUDIO_BLOCK_SAMPLES];
+  float32_t send[AUDIO_BLOCK_SAMPLES];
+  bool allocated = left && right;
+  bool mixed = false;
+  bool sent = false;
+
+  //dry sections, harp then chords as the stereo mixers summed them, a missing block skips the section but its ramps keep moving
+  if(add_section(allocated ? inputs[0] : nullptr, string_gain, string_amplifier, string_l_stereo_gain, string_r_stereo_gain,
+                 allocated ? left->data : nullptr, allocated ? right->data : nullptr, amplified, true)){
+    mixed = true;
+    reverb_mixer.mix_in(0, amplified, send, true);
+    sent = true;
+  }
+  if(add_section(allocated ? inputs[1] : nullptr, chords_gain, chords_amplifier, chords_l_stereo_gain, chords_r_stereo_gain,
+                 allocated ? left->data : nullptr, allocated ? right->data : nullptr, amplified, !mixed)){
+    mixed = true;
+    reverb_mixer.mix_in(1, amplified, send, !sent);
+    sent = true;
+  }
+
+  //reverb, its outputs cross over as they were patched: 0 to the right, 1 to the left
+  float32_t wet_left[AUDIO_BLOCK_SAMPLES];
+  float32_t wet_right[AUDIO_BLOCK_SAMPLES];
+  bool wet = reverb && reverb->process(sent ? send : nullptr, nullptr, wet_right, wet_left);
+  if(allocated && wet){
+    mix_return(wet_left, left->data, !mixed);
+    mix_return(wet_right, right->data, !mixed);
+    mixed = true;
+  }
+
+  if(mixed){
+    transmit(left, 0);
+    transmit(right, 1);
+  }
+  if(left){
+    release(left);
+  }
+  if(right){
+    release(right);
+  }
+  for(int i = 0; i < 2; i++){
+    if(inputs[i]){
+      release(inputs[i]);
+    }
+  }
+}
+
+//gain, amplifier and pan of one section in a single loop, false when nothing was added as the amplifier at 0 transmits nothing
+bool stereo_bus::add_section(audio_block_t *input, voice_dc &gain, voice_amplifier &amplifier, voice_dc &left_gain, voice_dc &right_gain,
+                             int16_t *left, int16_t *right, int16_t *amplified, bool first){
+  if(!input || !amplifier.active()){
+    gain.advance();
+    left_gain.advance();
+    right_gain.advance();
+    return false;
+  }
+  int16_t gains[AUDIO_BLOCK_SAMPLES];
+  int16_t left_gains[AUDIO_BLOCK_SAMPLES];
+  int16_t right_gains[AUDIO_BLOCK_SAMPLES];
+  gain.process(gains);
+  left_gain.process(left_gains);
+  right_gain.process(right_gains);
+  const int16_t *data = input->data;
+  for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+    int32_t sample = amplifier.apply(signed_saturate_rshift(data[i] * gains[i], 16, 15));
+    amplified[i] = sample;
+    int32_t l = signed_saturate_rshift(sample * left_gains[i], 16, 15);
+    int32_t r = signed_saturate_rshift(sample * right_gains[i], 16, 15);
+    if(first){
+      left[i] = l;
+      right[i] = r;
+    }else{
+      left[i] = signed_saturate_rshift(left[i] + l, 16, 0);
+      right[i] = signed_saturate_rshift(right[i] + r, 16, 0);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,49 @@
+#ifndef STEREO_BUS_H
+#define STEREO_BUS_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+#include "voice_components.h"
+#include "effect_platervbstereo.h"
+
+//the output stage in a single audio object, replacing the 14 gain, amplifier and pan objects and the 3 mixers around the reverb
+//input 0 harp, 1 chords, output 0 left, 1 right
+//each section goes through gain, amplifier and pan in one loop, with the arithmetic of the objects it replaces
+//the reverb is not connected but attached and run from the bus, so that its send and return stay in float
+//the only conversion is the saturation of dry and wet together into the output blocks
+//only the reverb I/O is in float: the chord voices, their mixers and the dry sections stay in the int16 blocks of the graph,
+//which have no float conversion to remove, a float path through them would need a block pool and connections of its own
+//the members carry the settings of the objects they replace, under the same names: reverb_mixer channel 0 harp, 1 chords
+class stereo_bus : public AudioStream{
+  public:
+  stereo_bus();
+  virtual void update(void);
+  void attach(AudioEffectPlateReverb *reverb){
+    this->reverb = reverb;
+  }
+  voice_dc string_gain;
+  voice_amplifier string_amplifier;
+  voice_dc string_l_stereo_gain;
+  voice_dc string_r_stereo_gain;
+  voice_dc chords_gain;
+  voice_amplifier chords_amplifier;
+  voice_dc chords_l_stereo_gain;
+  voice_dc chords_r_stereo_gain;
+  voice_mixer reverb_mixer;
+  private:
+  /**
+  * Add one section to the left and right sums
+  * @param input block of the section, nullptr to only advance its ramps
+  * @param left left sum, overwritten when first
+  * @param right right sum, overwritten when first
+  * @param amplified the section after its amplifier, for the reverb send
+  * @param first true for the first section present
+  * @return false when nothing was added
+  */
+  bool add_section(audio_block_t *input, voice_dc &gain, voice_amplifier &amplifier, voice_dc &left_gain, voice_dc &right_gain,
+                   int16_t *left, int16_t *right, int16_t *amplified, bool first);
+  AudioEffectPlateReverb *reverb=nullptr;
+  audio_block_t *inputQueueArray[2];
+};
+
+#endif
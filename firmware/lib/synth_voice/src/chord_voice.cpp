@@ -0,0 +1,112 @@
+#include "chord_voice.h"
+#include "utility/dspinst.h"
+
+ChordVoice::ChordVoice() : AudioStream(4, inputQueueArray){
+  vibrato_envelope.attach(&envelopes, 0);
+  vibrato_dc_envelope.attach(&envelopes, 1);
+  envelope_filter.attach(&envelopes, 2);
+  envelope.attach(&envelopes, 3);
+}
+
+void ChordVoice::update(void){
+  audio_block_t *inputs[4];
+  for(int i = 0; i < 4; i++){
+    inputs[i] = receiveReadOnly(i);
+  }
+  if(suspended){
+    filter_stopped = true;
+    skip(inputs);
+    return;
+  }
+  if(filter_stopped){
+    filter.reset();
+    filter_stopped = false;
+  }
+  audio_block_t *output = nullptr;
+  if(inputs[3] && envelope.isActive()){
+    output = allocate();
+  }
+  if(!output){
+    skip(inputs);
+    return;
+  }
+  int16_t modulation[AUDIO_BLOCK_SAMPLES];
+  int16_t buffer[AUDIO_BLOCK_SAMPLES];
+  int16_t *mix = output->data;
+
+  //pitch: vibrato, pitch bend and glide, the output block holds the glide until the oscillators are mixed
+  frequency_dc.process(mix);
+  bool first = true;
+  if(inputs[0] && vibrato_envelope.process(inputs[0]->data, buffer)){
+    vibrato_mixer.mix_in(0, buffer, modulation, first);
+    first = false;
+  }
+  if(inputs[1] && vibrato_dc_envelope.process(inputs[1]->data, buffer)){
+    vibrato_mixer.mix_in(1, buffer, modulation, first);
+    first = false;
+  }
+  vibrato_mixer.mix_in(2, mix, modulation, first);
+
+  //oscillators, the modulation scale is shared by the ones with the same range
+  uint32_t scale[AUDIO_BLOCK_SAMPLES];
+  int32_t scale_factor = osc1.modulation_factor();
+  voice_oscillator::modulation_scale(modulation, scale_factor, scale);
+  voice_oscillator *oscillators[3] = {&osc1, &osc2, &osc3};
+  first = true;
+  for(int i = 0; i < 3; i++){
+    if(oscillators[i]->modulation_factor() != scale_factor){
+      scale_factor = oscillators[i]->modulation_factor();
+      voice_oscillator::modulation_scale(modulation, scale_factor, scale);
+    }
+    if(oscillators[i]->process(scale, buffer)){
+      mixer.mix_in(i, buffer, mix, first);
+      first = false;
+    }
+  }
+  if(!mixer.muted(3) && noise.process(buffer)){
+    mixer.mix_in(3, buffer, mix, first);
+    first = false;
+  }
+  if(first){
+    memset(mix, 0, sizeof(output->data));
+  }
+
+  //filter
+  bool filter_modulated = inputs[2] && envelope_filter.process(inputs[2]->data, buffer);
+  filter.process(mix, filter_modulated ? buffer : nullptr, mix);
+
+  //amplitude envelope and tremolo, a missing envelope block silences the voice as the multiply would
+  if(envelope.process(inputs[3]->data, buffer)){
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      mix[i] = signed_saturate_rshift(mix[i] * buffer[i], 16, 15);
+    }
+    transmit(output);
+  }
+  release(output);
+  for(int i = 0; i < 4; i++){
+    if(inputs[i]){
+      release(inputs[i]);
+    }
+  }
+}
+
+//silent voice, only what the next note depends on is kept moving
+void ChordVoice::skip(audio_block_t **inputs){
+  voice_envelope *input_envelopes[4] = {&vibrato_envelope, &vibrato_dc_envelope, &envelope_filter, &envelope};
+  uint16_t channels = 0;
+  for(int i = 0; i < 4; i++){
+    if(inputs[i]){
+      channels |= input_envelopes[i]->mask();
+    }
+  }
+  envelopes.advance(channels);
+  frequency_dc.advance();
+  osc1.advance();
+  osc2.advance();
+  osc3.advance();
+  for(int i = 0; i < 4; i++){
+    if(inputs[i]){
+      release(inputs[i]);
+    }
+  }
+}
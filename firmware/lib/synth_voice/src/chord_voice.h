@@ -0,0 +1,43 @@
+#ifndef CHORD_VOICE_H
+#define CHORD_VOICE_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+#include "voice_components.h"
+
+//a whole chord voice in a single audio object, replacing the 12 objects of the previous graph
+//vibrato envelopes and mixer, 3 oscillators and noise, voice mixer, filter with its envelope, amplitude envelope and tremolo
+//the shared LFOs stay outside: input 0 vibrato LFO, 1 vibrato DC (pitch bend), 2 filter LFO, 3 tremolo LFO
+//the members carry the settings of the objects they replace, under the same names
+//while the amplitude envelope is idle nothing is computed, only the envelopes, glide and phases are kept running
+class ChordVoice : public AudioStream{
+  public:
+  ChordVoice();
+  virtual void update(void);
+  /**
+  * Stop or restart the rendering of a voice whose output is not heard
+  * @param suspended while true the voice runs as if its amplitude envelope were idle, the filter restarts from rest
+  */
+  void suspend(bool suspended){ this->suspended = suspended; }
+  bool is_suspended(){ return suspended; }
+  voice_envelope vibrato_envelope;
+  voice_envelope vibrato_dc_envelope;
+  voice_dc frequency_dc;
+  voice_mixer vibrato_mixer;
+  voice_oscillator osc1;
+  voice_oscillator osc2;
+  voice_oscillator osc3;
+  voice_noise noise;
+  voice_mixer mixer;
+  voice_envelope envelope_filter;
+  voice_filter filter;
+  voice_envelope envelope;
+  private:
+  void skip(audio_block_t **inputs);
+  voice_envelope_bank envelopes; //the 4 envelopes above
+  audio_block_t *inputQueueArray[4];
+  volatile bool suspended=false;
+  bool filter_stopped=false; //the filter missed blocks while suspended
+};
+
+#endif
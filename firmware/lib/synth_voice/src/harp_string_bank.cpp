@@ -0,0 +1,118 @@
+#include "harp_string_bank.h"
+
+HarpStringBank::HarpStringBank() : AudioStream(2, inputQueueArray){
+  for(int s = 0; s < HARP_STRINGS; s++){
+    strings[s].envelope.attach(&string_envelopes, s);
+    strings[s].envelope_filter.attach(&filter_envelopes, s);
+    strings[s].transient_envelope.attach(&transient_envelopes, s);
+  }
+}
+
+void HarpStringBank::transient_gain(float gain){
+  string_mixer.gain(1, gain);
+}
+
+void HarpStringBank::update(void){
+  audio_block_t *vibrato = receiveReadOnly(0);
+  audio_block_t *filter_control = receiveReadOnly(1);
+  bool any_active = (string_envelopes.active_channels() | transient_envelopes.active_channels()) != 0;
+  if(suspended){
+    filters_stopped = true;
+  }else if(filters_stopped){
+    for(int s = 0; s < HARP_STRINGS; s++){
+      strings[s].filter.reset();
+    }
+    filters_stopped = false;
+  }
+  audio_block_t *mix = any_active && !suspended ? allocate() : nullptr;
+  if(mix){
+    memset(mix->data, 0, sizeof(mix->data));
+  }
+
+  //strings: oscillator and envelope into a free lane, the lanes are filtered and mixed once full
+  int16_t lane_buffers[FILTER_LANES][AUDIO_BLOCK_SAMPLES];
+  int16_t lane_controls[FILTER_LANES][AUDIO_BLOCK_SAMPLES];
+  voice_filter *lane_filters[FILTER_LANES];
+  int16_t *lane_blocks[FILTER_LANES];
+  const int16_t *lane_control_blocks[FILTER_LANES];
+  int8_t string_lanes[HARP_STRINGS];
+  uint32_t scale[AUDIO_BLOCK_SAMPLES];
+  int32_t scale_factor = 0; //0 while no scale was computed, the modulation factor is never 0
+  int lane_count = 0;
+  int first_unmixed = 0;
+  uint16_t filter_idle = 0; //filter envelopes to advance without audio
+  transient_idle = 0;
+  for(int s = 0; s < HARP_STRINGS; s++){
+    harp_string &string = strings[s];
+    string_lanes[s] = -1;
+    if(string.envelope.isActive() && mix){
+      //the modulation scale is shared by the strings with the same range
+      if(vibrato && string.oscillator.modulation_factor() != scale_factor){
+        scale_factor = string.oscillator.modulation_factor();
+        voice_oscillator::modulation_scale(vibrato->data, scale_factor, scale);
+      }
+      int16_t *buffer = lane_buffers[lane_count];
+      if(string.oscillator.process(vibrato ? scale : nullptr, buffer)){
+        string.envelope.process(buffer, buffer);
+        bool filter_modulated = filter_control && string.envelope_filter.process(filter_control->data, lane_controls[lane_count]);
+        lane_filters[lane_count] = &string.filter;
+        lane_blocks[lane_count] = buffer;
+        lane_control_blocks[lane_count] = filter_modulated ? lane_controls[lane_count] : nullptr;
+        string_lanes[s] = lane_count++;
+      }else{
+        string_envelopes.advance(string.envelope.mask());
+        filter_idle |= string.envelope_filter.mask();
+      }
+    }else{
+      if(string.envelope.isActive()){
+        string_envelopes.advance(string.envelope.mask()); //sounding while nothing is rendered
+      }
+      string.oscillator.advance();
+      filter_idle |= string.envelope_filter.mask();
+    }
+    if(lane_count == FILTER_LANES || s == HARP_STRINGS - 1){
+      voice_filter::process_lanes(lane_filters, lane_blocks, lane_control_blocks, lane_count);
+      mix_strings(first_unmixed, s, string_lanes, lane_blocks, mix ? mix->data : nullptr);
+      first_unmixed = s + 1;
+      lane_count = 0;
+    }
+  }
+
+  if(filter_control){
+    filter_envelopes.advance(filter_idle);
+  }
+  transient_envelopes.advance(transient_idle);
+
+  if(mix){
+    transmit(mix);
+    release(mix);
+  }
+  if(vibrato){
+    release(vibrato);
+  }
+  if(filter_control){
+    release(filter_control);
+  }
+}
+
+//strings first to last in order, each followed by its transient, so that the saturation of the mix is the same as with a mixer per string
+void HarpStringBank::mix_strings(int first, int last, const int8_t *lanes, int16_t *const *blocks, int16_t *mix){
+  int16_t buffer[AUDIO_BLOCK_SAMPLES];
+  for(int s = first; s <= last; s++){
+    harp_string &string = strings[s];
+    if(lanes[s] >= 0){
+      string_mixer.mix_in(0, blocks[lanes[s]], mix, false);
+    }
+    //transient, without modulation
+    bool transient_active = string.transient_envelope.isActive();
+    if(transient_active && mix && string.transient.process(nullptr, buffer)){
+      string.transient_envelope.process(buffer, buffer);
+      string_mixer.mix_in(1, buffer, mix, false);
+    }else{
+      if(!transient_active || !mix){
+        string.transient.advance();
+      }
+      transient_idle |= string.transient_envelope.mask();
+    }
+  }
+}
@@ -0,0 +1,51 @@
+#ifndef HARP_STRING_BANK_H
+#define HARP_STRING_BANK_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+#include "voice_components.h"
+
+#define HARP_STRINGS 12
+
+//the objects of one harp string: oscillator, envelope then filter with its own envelope, and the transient with its envelope
+//the members carry the settings of the objects they replace, under the same names
+class harp_string{
+  public:
+  voice_oscillator oscillator;
+  voice_envelope envelope;
+  voice_envelope envelope_filter;
+  voice_filter filter;
+  voice_oscillator transient;
+  voice_envelope transient_envelope;
+};
+
+//all the harp strings in a single audio object, replacing the oscillators, transients, filters, envelopes and mixers of each string
+//the shared sources stay outside: input 0 vibrato modulation, 1 filter envelope source (DC), output 0 is the mix of the strings
+//the filters of the sounding strings run FILTER_LANES at a time in lock-step, the strings and transients are then mixed in string order
+//a string whose envelopes are both idle is not computed, only its phases and filter envelope are kept moving
+//the envelopes of each kind are a bank, advanced together when they shape no audio
+class HarpStringBank : public AudioStream{
+  public:
+  HarpStringBank();
+  virtual void update(void);
+  void transient_gain(float gain); //level of the transients in the mix
+  /**
+  * Stop or restart the rendering of strings whose output is not heard
+  * @param suspended while true the strings run as if they were not sounding, the filters restart from rest
+  */
+  void suspend(bool suspended){ this->suspended = suspended; }
+  bool is_suspended(){ return suspended; }
+  harp_string strings[HARP_STRINGS];
+  private:
+  void mix_strings(int first, int last, const int8_t *lanes, int16_t *const *blocks, int16_t *mix);
+  audio_block_t *inputQueueArray[2];
+  voice_envelope_bank string_envelopes; //channel s is the envelope of string s
+  voice_envelope_bank filter_envelopes;
+  voice_envelope_bank transient_envelopes;
+  uint16_t transient_idle=0; //transient envelopes to advance without audio at the end of the update
+  voice_mixer string_mixer; //channel 0 the strings, 1 the transients
+  volatile bool suspended=false;
+  bool filters_stopped=false; //the filters missed blocks while suspended
+};
+
+#endif
@@ -0,0 +1,780 @@
+#include "voice_components.h"
+#include "Audio.h"
+#include "utility/dspinst.h"
+
+#define ENVELOPE_IDLE 0
+#define ENVELOPE_DELAY 1
+#define ENVELOPE_ATTACK 2
+#define ENVELOPE_HOLD 3
+#define ENVELOPE_DECAY 4
+#define ENVELOPE_SUSTAIN 5
+#define ENVELOPE_RELEASE 6
+#define ENVELOPE_FORCED 7
+#define ENVELOPE_UNITY 0x40000000
+#define SAMPLES_PER_MSEC (AUDIO_SAMPLE_RATE_EXACT/1000.0f)
+
+//exp2 of a 27 bit fraction, by Laurent de Soras, as used by the Teensy objects
+static inline int32_t exp2_fraction(int32_t n){
+  n = (n + 134217728) << 3;
+  n = multiply_32x32_rshift32_rounded(n, n);
+  n = multiply_32x32_rshift32_rounded(n, 715827883) << 3;
+  return n + 715827882;
+}
+
+static inline int16_t saturate16(int32_t value){
+  return value > 32767 ? 32767 : (value < -32768 ? -32768 : value);
+}
+
+//>>ENVELOPE<<
+
+voice_envelope_bank::voice_envelope_bank(){
+  for(uint8_t c = 0; c < ENVELOPE_BANK_CHANNELS; c++){
+    state[c] = ENVELOPE_IDLE;
+    events[c] = 0;
+    count[c] = 0;
+    mult_hires[c] = 0;
+    inc_hires[c] = 0;
+    delay(c, 0.0f);
+    attack(c, 10.5f);
+    hold(c, 2.5f);
+    decay(c, 35.0f);
+    sustain(c, 0.5f);
+    release(c, 300.0f);
+    releaseNoteOn(c, 5.0f);
+  }
+}
+
+uint16_t voice_envelope_bank::milliseconds2count(float milliseconds){
+  if(milliseconds < 0.0f){
+    milliseconds = 0.0f;
+  }
+  uint32_t c = ((uint32_t)(milliseconds * SAMPLES_PER_MSEC) + 7) >> 3;
+  if(c > 65535){
+    c = 65535;
+  }
+  return c;
+}
+
+void voice_envelope_bank::delay(uint8_t channel, float milliseconds){
+  delay_count[channel] = milliseconds2count(milliseconds);
+}
+
+void voice_envelope_bank::attack(uint8_t channel, float milliseconds){
+  attack_count[channel] = milliseconds2count(milliseconds);
+  if(attack_count[channel] == 0){
+    attack_count[channel] = 1;
+  }
+}
+
+void voice_envelope_bank::hold(uint8_t channel, float milliseconds){
+  hold_count[channel] = milliseconds2count(milliseconds);
+}
+
+void voice_envelope_bank::decay(uint8_t channel, float milliseconds){
+  decay_count[channel] = milliseconds2count(milliseconds);
+  if(decay_count[channel] == 0){
+    decay_count[channel] = 1;
+  }
+}
+
+void voice_envelope_bank::sustain(uint8_t channel, float level){
+  if(level < 0.0f){
+    level = 0.0f;
+  }else if(level > 1.0f){
+    level = 1.0f;
+  }
+  sustain_mult[channel] = level * 1073741824.0f;
+}
+
+void voice_envelope_bank::release(uint8_t channel, float milliseconds){
+  release_count[channel] = milliseconds2count(milliseconds);
+  if(release_count[channel] == 0){
+    release_count[channel] = 1;
+  }
+}
+
+void voice_envelope_bank::releaseNoteOn(uint8_t channel, float milliseconds){
+  release_forced_count[channel] = milliseconds2count(milliseconds);
+}
+
+void voice_envelope_bank::start_attack(uint8_t channel){
+  mult_hires[channel] = 0;
+  count[channel] = delay_count[channel];
+  if(count[channel] > 0){
+    state[channel] = ENVELOPE_DELAY;
+    inc_hires[channel] = 0;
+  }else{
+    state[channel] = ENVELOPE_ATTACK;
+    count[channel] = attack_count[channel];
+    inc_hires[channel] = ENVELOPE_UNITY / (int32_t)count[channel];
+  }
+}
+
+void voice_envelope_bank::noteOn(uint8_t channel){
+  __disable_irq();
+  uint8_t current = state[channel];
+  if(current == ENVELOPE_IDLE || current == ENVELOPE_DELAY || release_forced_count[channel] == 0){
+    start_attack(channel);
+  }else if(current != ENVELOPE_FORCED){
+    //quick fade out of the sound still playing before the attack
+    state[channel] = ENVELOPE_FORCED;
+    count[channel] = release_forced_count[channel];
+    inc_hires[channel] = (-mult_hires[channel]) / (int32_t)count[channel];
+  }
+  active_mask |= 1 << channel;
+  events[channel]++;
+  __enable_irq();
+}
+
+void voice_envelope_bank::noteOff(uint8_t channel){
+  __disable_irq();
+  uint8_t current = state[channel];
+  if(current != ENVELOPE_IDLE && current != ENVELOPE_FORCED){
+    state[channel] = ENVELOPE_RELEASE;
+    count[channel] = release_count[channel];
+    inc_hires[channel] = (-mult_hires[channel]) / (int32_t)count[channel];
+  }
+  events[channel]++;
+  __enable_irq();
+}
+
+bool voice_envelope_bank::isActive(uint8_t channel){
+  return (active_mask >> channel) & 1;
+}
+
+bool voice_envelope_bank::isSustain(uint8_t channel){
+  return *(volatile uint8_t *)&state[channel] == ENVELOPE_SUSTAIN;
+}
+
+uint16_t voice_envelope_bank::active_channels(){
+  return active_mask;
+}
+
+bool voice_envelope_bank::process(uint8_t channel, const int16_t *input, int16_t *output){
+  if(state[channel] == ENVELOPE_IDLE){
+    return false;
+  }
+  //the block runs on a copy of the state, dropped if a note event arrives meanwhile from a timer interrupt
+  uint8_t events_seen = events[channel];
+  uint8_t current = state[channel];
+  uint16_t left = count[channel];
+  int32_t mult = mult_hires[channel];
+  int32_t inc = inc_hires[channel];
+  //without audio, a block that completes no region is a single step
+  if(!input && left >= AUDIO_BLOCK_SAMPLES / 8){
+    left -= AUDIO_BLOCK_SAMPLES / 8;
+    mult += inc * (AUDIO_BLOCK_SAMPLES / 8);
+  }else{
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES;){
+      //the state only matters when completing a region
+      if(left == 0){
+        if(current == ENVELOPE_ATTACK){
+          left = hold_count[channel];
+          if(left > 0){
+            current = ENVELOPE_HOLD;
+            mult = ENVELOPE_UNITY;
+            inc = 0;
+          }else{
+            current = ENVELOPE_DECAY;
+            left = decay_count[channel];
+            inc = (sustain_mult[channel] - ENVELOPE_UNITY) / (int32_t)left;
+          }
+          continue;
+        }else if(current == ENVELOPE_HOLD){
+          current = ENVELOPE_DECAY;
+          left = decay_count[channel];
+          inc = (sustain_mult[channel] - ENVELOPE_UNITY) / (int32_t)left;
+          continue;
+        }else if(current == ENVELOPE_DECAY){
+          current = ENVELOPE_SUSTAIN;
+          left = 0xFFFF;
+          mult = sustain_mult[channel];
+          inc = 0;
+        }else if(current == ENVELOPE_SUSTAIN){
+          left = 0xFFFF;
+        }else if(current == ENVELOPE_RELEASE){
+          current = ENVELOPE_IDLE;
+          if(input){
+            memset(output + i, 0, (AUDIO_BLOCK_SAMPLES - i) * sizeof(int16_t));
+          }
+          break;
+        }else if(current == ENVELOPE_FORCED){
+          //start_attack() on the copy
+          mult = 0;
+          left = delay_count[channel];
+          if(left > 0){
+            current = ENVELOPE_DELAY;
+            inc = 0;
+          }else{
+            current = ENVELOPE_ATTACK;
+            left = attack_count[channel];
+            inc = ENVELOPE_UNITY / (int32_t)left;
+          }
+        }else if(current == ENVELOPE_DELAY){
+          current = ENVELOPE_ATTACK;
+          left = attack_count[channel];
+          inc = ENVELOPE_UNITY / (int32_t)left;
+          continue;
+        }
+      }
+      if(input){
+        //8 samples at 16 bit resolution, the long term gain is kept at 30 bit
+        int32_t gain = mult >> 14;
+        int32_t step = inc >> 17;
+        for(int j = i; j < i + 8; j++){
+          gain += step;
+          output[j] = (gain * input[j]) >> 16;
+        }
+      }
+      mult += inc;
+      left--;
+      i += 8;
+    }
+  }
+  __disable_irq();
+  if(events[channel] == events_seen){
+    state[channel] = current;
+    count[channel] = left;
+    mult_hires[channel] = mult;
+    inc_hires[channel] = inc;
+    if(current == ENVELOPE_IDLE){
+      active_mask &= ~(1 << channel);
+    }
+  }
+  __enable_irq();
+  return true;
+}
+
+void voice_envelope_bank::advance(uint16_t channels){
+  channels &= active_mask;
+  while(channels){
+    uint8_t channel = __builtin_ctz(channels);
+    channels &= channels - 1;
+    process(channel, nullptr, nullptr);
+  }
+}
+
+//>>OSCILLATOR<<
+
+void voice_oscillator::begin(short type){
+  tone_type = type;
+}
+
+void voice_oscillator::begin(float amplitude, float frequency, short type){
+  this->amplitude(amplitude);
+  this->frequency(frequency);
+  begin(type);
+}
+
+void voice_oscillator::amplitude(float level){
+  if(level < 0.0f){
+    level = 0.0f;
+  }else if(level > 1.0f){
+    level = 1.0f;
+  }
+  magnitude = level * 65536.0f;
+}
+
+void voice_oscillator::frequency(float frequency){
+  if(frequency < 0.0f){
+    frequency = 0.0f;
+  }else if(frequency > AUDIO_SAMPLE_RATE_EXACT / 2.0f){
+    frequency = AUDIO_SAMPLE_RATE_EXACT / 2.0f;
+  }
+  uint32_t increment = frequency * (4294967296.0f / AUDIO_SAMPLE_RATE_EXACT);
+  if(increment > 0x7FFE0000u){
+    increment = 0x7FFE0000u;
+  }
+  phase_increment = increment;
+}
+
+void voice_oscillator::frequencyModulation(float octaves){
+  if(octaves > 12.0f){
+    octaves = 12.0f;
+  }else if(octaves < 0.1f){
+    octaves = 0.1f;
+  }
+  factor = octaves * 4096.0f;
+}
+
+int32_t voice_oscillator::modulation_factor(){
+  return factor;
+}
+
+void voice_oscillator::modulation_scale(const int16_t *modulation, int32_t factor, uint32_t *scale){
+  for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+    int32_t n = modulation[i] * factor; //octaves, 4 integer and 27 fractional bits
+    int32_t ipart = n >> 27;
+    scale[i] = (uint32_t)exp2_fraction(n & 0x7FFFFFF) >> (14 - ipart);
+  }
+}
+
+void voice_oscillator::advance(){
+  prior_phase = phase_accumulator + phase_increment * (AUDIO_BLOCK_SAMPLES - 1);
+  phase_accumulator += phase_increment * AUDIO_BLOCK_SAMPLES;
+}
+
+//step correction of the band limited waveforms, t is the phase since the step and dt the phase step, both in cycles
+static inline float poly_blep(float t, float dt){
+  if(t < dt){
+    t /= dt;
+    return t + t - t * t - 1.0f;
+  }else if(t > 1.0f - dt){
+    t = (t - 1.0f) / dt;
+    return t * t + t + t + 1.0f;
+  }
+  return 0.0f;
+}
+
+bool voice_oscillator::process(const uint32_t *scale, int16_t *output){
+  uint32_t ph = phase_accumulator;
+  const uint32_t inc = phase_increment;
+  uint32_t priorphase = prior_phase;
+  uint32_t phase_data[AUDIO_BLOCK_SAMPLES]; //on the stack, a member in each of the 36 oscillators took 18KB
+  if(scale){
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      uint64_t phstep = (uint64_t)inc * scale[i];
+      if((uint32_t)(phstep >> 32) < 0x7FFE){
+        ph += phstep >> 16;
+      }else{
+        ph += 0x7FFE0000;
+      }
+      phase_data[i] = ph;
+    }
+  }else{
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      phase_data[i] = ph;
+      ph += inc;
+    }
+  }
+  phase_accumulator = ph;
+  prior_phase = phase_data[AUDIO_BLOCK_SAMPLES - 1];
+  if(magnitude == 0){
+    return false;
+  }
+
+  switch(tone_type){
+    case WAVEFORM_SINE:
+      for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+        uint32_t phase = phase_data[i];
+        uint32_t index = phase >> 24;
+        uint32_t fraction = (phase >> 8) & 0xFFFF;
+        int32_t value = AudioWaveformSine[index] * (int32_t)(0x10000 - fraction) + AudioWaveformSine[index + 1] * (int32_t)fraction;
+        output[i] = multiply_32x32_rshift32(value, magnitude);
+      }
+      break;
+
+    case WAVEFORM_PULSE: //no shape input, so same as the square
+    case WAVEFORM_SQUARE:{
+      int16_t magnitude15 = signed_saturate_rshift(magnitude, 16, 1);
+      for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+        output[i] = (phase_data[i] & 0x80000000) ? -magnitude15 : magnitude15;
+      }
+      break;
+    }
+
+    case WAVEFORM_SAWTOOTH:
+      for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+        output[i] = signed_multiply_32x16t(magnitude, phase_data[i]);
+      }
+      break;
+
+    case WAVEFORM_SAWTOOTH_REVERSE:
+      for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+        output[i] = signed_multiply_32x16t(0xFFFFFFFFu - magnitude, phase_data[i]);
+      }
+      break;
+
+    case WAVEFORM_TRIANGLE_VARIABLE: //no shape input, so same as the triangle
+    case WAVEFORM_TRIANGLE:
+      for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+        uint32_t phase = phase_data[i];
+        uint32_t phtop = phase >> 30;
+        if(phtop == 1 || phtop == 2){
+          output[i] = ((0xFFFF - (phase >> 15)) * magnitude) >> 16;
+        }else{
+          output[i] = (((int32_t)phase >> 15) * magnitude) >> 16;
+        }
+      }
+      break;
+
+    case WAVEFORM_SAMPLE_HOLD:
+      for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+        if(phase_data[i] < priorphase){
+          held_sample = random(magnitude) - (magnitude >> 1);
+        }
+        priorphase = phase_data[i];
+        output[i] = held_sample;
+      }
+      break;
+
+    case WAVEFORM_BANDLIMIT_SAWTOOTH:
+    case WAVEFORM_BANDLIMIT_SAWTOOTH_REVERSE:{
+      //the step of the sawtooth is at half phase, as for WAVEFORM_SAWTOOTH
+      const float gain = (tone_type == WAVEFORM_BANDLIMIT_SAWTOOTH ? 1.0f : -1.0f) * magnitude * (32767.0f / 65536.0f);
+      for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+        uint32_t shifted = phase_data[i] + 0x80000000u;
+        float t = shifted * (1.0f / 4294967296.0f);
+        float dt = (phase_data[i] - priorphase) * (1.0f / 4294967296.0f);
+        priorphase = phase_data[i];
+        output[i] = (int16_t)((t + t - 1.0f - poly_blep(t, dt)) * gain);
+      }
+      break;
+    }
+
+    case WAVEFORM_BANDLIMIT_PULSE: //no shape input, so same as the square
+    case WAVEFORM_BANDLIMIT_SQUARE:{
+      const float gain = magnitude * (32767.0f / 65536.0f);
+      for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+        float t = phase_data[i] * (1.0f / 4294967296.0f);
+        float half = (uint32_t)(phase_data[i] + 0x80000000u) * (1.0f / 4294967296.0f);
+        float dt = (phase_data[i] - priorphase) * (1.0f / 4294967296.0f);
+        priorphase = phase_data[i];
+        float value = (phase_data[i] & 0x80000000) ? -1.0f : 1.0f;
+        output[i] = (int16_t)((value + poly_blep(t, dt) - poly_blep(half, dt)) * gain);
+      }
+      break;
+    }
+
+    default:
+      memset(output, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+      break;
+  }
+  return true;
+}
+
+//>>DC<<
+
+void voice_dc::amplitude(float level){
+  if(level > 1.0f){
+    level = 1.0f;
+  }else if(level < -1.0f){
+    level = -1.0f;
+  }
+  int32_t m = level * 2147418112.0f;
+  __disable_irq();
+  magnitude = m;
+  state = 0;
+  __enable_irq();
+}
+
+void voice_dc::amplitude(float level, float milliseconds){
+  if(milliseconds <= 0.0f){
+    amplitude(level);
+    return;
+  }
+  if(level > 1.0f){
+    level = 1.0f;
+  }else if(level < -1.0f){
+    level = -1.0f;
+  }
+  int32_t c = milliseconds * SAMPLES_PER_MSEC;
+  if(c == 0){
+    amplitude(level);
+    return;
+  }
+  int32_t t = level * 2147418112.0f;
+  __disable_irq();
+  if(t == magnitude){
+    state = 0;
+  }else{
+    target = t;
+    increment = ((int64_t)t - magnitude) / c;
+    if(increment == 0){
+      increment = (t > magnitude) ? 1 : -1;
+    }
+    state = 1;
+  }
+  __enable_irq();
+}
+
+void voice_dc::process(int16_t *output){
+  if(state == 0){
+    int16_t value = magnitude >> 16;
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      output[i] = value;
+    }
+    return;
+  }
+  for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+    if(state){
+      //compared before adding, so that the last step towards a level near full scale cannot wrap around as the int32 sum did
+      if((increment > 0) ? (magnitude >= target - increment) : (magnitude <= target - increment)){
+        magnitude = target;
+        state = 0;
+      }else{
+        magnitude += increment;
+      }
+    }
+    output[i] = magnitude >> 16;
+  }
+}
+
+void voice_dc::advance(){
+  if(state == 0){
+    return;
+  }
+  int64_t next = (int64_t)magnitude + (int64_t)increment * AUDIO_BLOCK_SAMPLES;
+  if((increment > 0) ? (next >= target) : (next <= target)){
+    magnitude = target;
+    state = 0;
+  }else{
+    magnitude = next;
+  }
+}
+
+//>>NOISE<<
+
+voice_noise_source voice_noise::source;
+uint16_t voice_noise::instance_count = 0;
+
+const int16_t *voice_noise_source::block(uint32_t &serial){
+  if(serial == current){
+    uint32_t lo = seed;
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      //Park-Miller minimal standard generator
+      uint32_t hi = 16807 * (lo >> 16);
+      lo = 16807 * (lo & 0xFFFF);
+      lo += (hi & 0x7FFF) << 16;
+      lo += hi >> 15;
+      lo = (lo & 0x7FFFFFFF) + (lo >> 31);
+      data[i] = lo;
+    }
+    seed = lo;
+    current++;
+  }
+  serial = current;
+  return data;
+}
+
+voice_noise::voice_noise(){
+  stride = 2 * instance_count + 1;
+  offset = 37 * instance_count;
+  instance_count++;
+}
+
+void voice_noise::amplitude(float level){
+  if(level < 0.0f){
+    level = 0.0f;
+  }else if(level > 1.0f){
+    level = 1.0f;
+  }
+  this->level = level * 65536.0f;
+}
+
+bool voice_noise::process(int16_t *output){
+  if(level == 0){
+    return false;
+  }
+  const int16_t *noise = source.block(serial);
+  uint32_t index = offset;
+  for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+    output[i] = (level * noise[index & (AUDIO_BLOCK_SAMPLES - 1)]) >> 16;
+    index += stride;
+  }
+  return true;
+}
+
+//>>MIXER<<
+
+voice_mixer::voice_mixer(){
+  for(int i = 0; i < 4; i++){
+    multiplier[i] = 65536;
+  }
+}
+
+void voice_mixer::gain(unsigned int channel, float gain){
+  if(channel >= 4){
+    return;
+  }
+  if(gain > 32767.0f){
+    gain = 32767.0f;
+  }else if(gain < -32767.0f){
+    gain = -32767.0f;
+  }
+  multiplier[channel] = gain * 65536.0f;
+}
+
+void voice_mixer::mix_in(unsigned int channel, const int16_t *input, int16_t *output, bool first){
+  const int32_t mult = multiplier[channel];
+  if(first){
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      output[i] = saturate16((int32_t)(((int64_t)mult * input[i]) >> 16));
+    }
+  }else if(mult == 65536){
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      output[i] = saturate16(output[i] + input[i]);
+    }
+  }else{
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      output[i] = saturate16(output[i] + saturate16((int32_t)(((int64_t)mult * input[i]) >> 16)));
+    }
+  }
+}
+
+void voice_mixer::mix_in(unsigned int channel, const int16_t *input, float *output, bool first){
+  const float scale = multiplier[channel] * (1.0f / (65536.0f * 32768.0f));
+  if(first){
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      output[i] = input[i] * scale;
+    }
+  }else{
+    for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+      output[i] += input[i] * scale;
+    }
+  }
+}
+
+//>>AMPLIFIER<<
+
+void voice_amplifier::gain(float n){
+  if(n > 32767.0f){
+    n = 32767.0f;
+  }else if(n < -32767.0f){
+    n = -32767.0f;
+  }
+  multiplier = n * 65536.0f;
+}
+
+//>>FILTER<<
+
+#define FILTER_MULT(a, b) (multiply_32x32_rshift32_rounded(a, b) << 2)
+
+voice_filter::voice_filter(){
+  frequency(1000);
+  octaveControl(1.0f);
+  resonance(0.707f);
+}
+
+void voice_filter::frequency(float frequency){
+  if(frequency < 20.0f){
+    frequency = 20.0f;
+  }else if(frequency > AUDIO_SAMPLE_RATE_EXACT / 2.5f){
+    frequency = AUDIO_SAMPLE_RATE_EXACT / 2.5f;
+  }
+  setting_fcenter = (frequency * (3.141592654f / (AUDIO_SAMPLE_RATE_EXACT * 2.0f))) * 2147483647.0f;
+  setting_fmult = sinf(frequency * (3.141592654f / (AUDIO_SAMPLE_RATE_EXACT * 2.0f))) * 2147483647.0f;
+}
+
+void voice_filter::resonance(float q){
+  if(q < 0.7f){
+    q = 0.7f;
+  }else if(q > 5.0f){
+    q = 5.0f;
+  }
+  setting_damp = (1.0f / q) * 1073741824.0f;
+}
+
+void voice_filter::octaveControl(float octaves){
+  if(octaves < 0.0f){
+    octaves = 0.0f;
+  }else if(octaves > 6.9999f){
+    octaves = 6.9999f;
+  }
+  setting_octavemult = octaves * 4096.0f;
+}
+
+//corner frequency multiplier from one control sample, with the approximations of AudioFilterStateVariable
+static inline int32_t filter_corner(int16_t control, int32_t fcenter, int32_t octavemult){
+  int32_t octaves = control * octavemult;
+  int32_t n = exp2_fraction(octaves & 0x7FFFFFF) >> (6 - (octaves >> 27));
+  int32_t fmult = multiply_32x32_rshift32_rounded(fcenter, n);
+  if(fmult > 5378279){
+    fmult = 5378279;
+  }
+  fmult = fmult << 8;
+  return (multiply_32x32_rshift32(fmult, 2145892402) + multiply_32x32_rshift32(multiply_32x32_rshift32(fmult, fmult), multiply_32x32_rshift32(fmult, -1383604731))) << 1;
+}
+
+void voice_filter::process(const int16_t *input, const int16_t *control, int16_t *lowpass, int16_t *bandpass, int16_t *highpass){
+  int32_t fmult = setting_fmult;
+  const int32_t fcenter = setting_fcenter;
+  const int32_t octavemult = setting_octavemult;
+  const int32_t damp = setting_damp;
+  int32_t inputprev = state_inputprev;
+  int32_t low = state_lowpass;
+  int32_t band = state_bandpass;
+  for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+    if(control){
+      fmult = filter_corner(control[i], fcenter, octavemult);
+    }
+    //twice oversampled, the first pass on the interpolated input
+    int32_t in = input[i] << 12;
+    low = low + FILTER_MULT(fmult, band);
+    int32_t high = ((in + inputprev) >> 1) - low - FILTER_MULT(damp, band);
+    inputprev = in;
+    band = band + FILTER_MULT(fmult, high);
+    int32_t first_low = low;
+    int32_t first_band = band;
+    int32_t first_high = high;
+    low = low + FILTER_MULT(fmult, band);
+    high = in - low - FILTER_MULT(damp, band);
+    band = band + FILTER_MULT(fmult, high);
+    lowpass[i] = signed_saturate_rshift(low + first_low, 16, 13);
+    if(bandpass){
+      bandpass[i] = signed_saturate_rshift(band + first_band, 16, 13);
+    }
+    if(highpass){
+      highpass[i] = signed_saturate_rshift(high + first_high, 16, 13);
+    }
+  }
+  state_inputprev = inputprev;
+  state_lowpass = low;
+  state_bandpass = band;
+}
+
+void voice_filter::process_lanes(voice_filter *const *filters, int16_t *const *blocks, const int16_t *const *controls, int count){
+  switch(count){
+    case 1: filters[0]->process(blocks[0], controls[0], blocks[0]); break;
+    case 2: run_lanes<2>(filters, blocks, controls); break;
+    case 3: run_lanes<3>(filters, blocks, controls); break;
+    case 4: run_lanes<4>(filters, blocks, controls); break;
+  }
+}
+
+//the corners of a modulated lane are computed first, they do not depend on each other
+//the recursion then runs on all lanes for each sample, so that the multiplies of a lane fill the latency of the others
+template <int lanes>
+void voice_filter::run_lanes(voice_filter *const *filters, int16_t *const *blocks, const int16_t *const *controls){
+  int32_t corners[lanes][AUDIO_BLOCK_SAMPLES];
+  int32_t damp[lanes];
+  int32_t inputprev[lanes];
+  int32_t low[lanes];
+  int32_t band[lanes];
+  for(int l = 0; l < lanes; l++){
+    const voice_filter *filter = filters[l];
+    if(controls[l]){
+      for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+        corners[l][i] = filter_corner(controls[l][i], filter->setting_fcenter, filter->setting_octavemult);
+      }
+    }else{
+      for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+        corners[l][i] = filter->setting_fmult;
+      }
+    }
+    damp[l] = filter->setting_damp;
+    inputprev[l] = filter->state_inputprev;
+    low[l] = filter->state_lowpass;
+    band[l] = filter->state_bandpass;
+  }
+  for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+    for(int l = 0; l < lanes; l++){
+      int32_t fmult = corners[l][i];
+      int32_t in = blocks[l][i] << 12;
+      low[l] = low[l] + FILTER_MULT(fmult, band[l]);
+      int32_t high = ((in + inputprev[l]) >> 1) - low[l] - FILTER_MULT(damp[l], band[l]);
+      inputprev[l] = in;
+      band[l] = band[l] + FILTER_MULT(fmult, high);
+      int32_t first_low = low[l];
+      low[l] = low[l] + FILTER_MULT(fmult, band[l]);
+      high = in - low[l] - FILTER_MULT(damp[l], band[l]);
+      band[l] = band[l] + FILTER_MULT(fmult, high);
+      blocks[l][i] = signed_saturate_rshift(low[l] + first_low, 16, 13);
+    }
+  }
+  for(int l = 0; l < lanes; l++){
+    filters[l]->state_inputprev = inputprev[l];
+    filters[l]->state_lowpass = low[l];
+    filters[l]->state_bandpass = band[l];
+  }
+}
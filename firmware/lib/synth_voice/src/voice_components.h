@@ -0,0 +1,244 @@
+#ifndef VOICE_COMPONENTS_H
+#define VOICE_COMPONENTS_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+#include "utility/dspinst.h"
+
+//building blocks of the fused voices, each one is the processing of a Teensy audio object without its own audio block
+//the setters keep the names, ranges and units of the objects they replace so that the sysex handler does not change
+//the process functions work on local buffers of AUDIO_BLOCK_SAMPLES samples, a false return means the object would not have transmitted
+
+#define ENVELOPE_BANK_CHANNELS 16
+
+#if AUDIO_BLOCK_SAMPLES % 8
+#error "the envelopes step every 8 samples and need blocks of a multiple of 8 samples"
+#endif
+
+//envelopes of AudioEffectEnvelope, the gain is updated every 8 samples
+//the state of all the channels is kept in arrays, with a mask of the active ones so that idle channels cost nothing
+//a block without audio that completes no region of the envelope is advanced in a single step
+class voice_envelope_bank{
+  public:
+  voice_envelope_bank();
+  void noteOn(uint8_t channel);
+  void noteOff(uint8_t channel);
+  void delay(uint8_t channel, float milliseconds);
+  void attack(uint8_t channel, float milliseconds);
+  void hold(uint8_t channel, float milliseconds);
+  void decay(uint8_t channel, float milliseconds);
+  void sustain(uint8_t channel, float level);
+  void release(uint8_t channel, float milliseconds);
+  void releaseNoteOn(uint8_t channel, float milliseconds);
+  bool isActive(uint8_t channel);
+  bool isSustain(uint8_t channel);
+  uint16_t active_channels(); //one bit per channel
+  /**
+  * Apply one block of envelope
+  * @param channel the envelope
+  * @param input block to be shaped, nullptr to only advance the envelope in time
+  * @param output shaped block, can be the input, unused when input is nullptr
+  * @return false when idle, output is then left untouched
+  */
+  bool process(uint8_t channel, const int16_t *input, int16_t *output);
+  void advance(uint16_t channels); //advance the active channels of the mask by a block, without audio
+  private:
+  uint16_t milliseconds2count(float milliseconds);
+  void start_attack(uint8_t channel);
+  volatile uint16_t active_mask=0;
+  uint8_t state[ENVELOPE_BANK_CHANNELS];
+  volatile uint8_t events[ENVELOPE_BANK_CHANNELS]; //counts the note events, to drop a block computed across one
+  uint16_t count[ENVELOPE_BANK_CHANNELS]; //8 sample steps left in the current state
+  int32_t mult_hires[ENVELOPE_BANK_CHANNELS]; //0x40000000 is unity gain
+  int32_t inc_hires[ENVELOPE_BANK_CHANNELS]; //added to mult_hires every 8 samples
+  uint16_t delay_count[ENVELOPE_BANK_CHANNELS];
+  uint16_t attack_count[ENVELOPE_BANK_CHANNELS];
+  uint16_t hold_count[ENVELOPE_BANK_CHANNELS];
+  uint16_t decay_count[ENVELOPE_BANK_CHANNELS];
+  int32_t sustain_mult[ENVELOPE_BANK_CHANNELS];
+  uint16_t release_count[ENVELOPE_BANK_CHANNELS];
+  uint16_t release_forced_count[ENVELOPE_BANK_CHANNELS];
+};
+
+//one channel of a voice_envelope_bank, with the interface of AudioEffectEnvelope, attached by the object owning the bank
+class voice_envelope{
+  public:
+  void attach(voice_envelope_bank *bank, uint8_t channel){
+    this->bank = bank;
+    this->channel = channel;
+  }
+  void noteOn(){ bank->noteOn(channel); }
+  void noteOff(){ bank->noteOff(channel); }
+  void delay(float milliseconds){ bank->delay(channel, milliseconds); }
+  void attack(float milliseconds){ bank->attack(channel, milliseconds); }
+  void hold(float milliseconds){ bank->hold(channel, milliseconds); }
+  void decay(float milliseconds){ bank->decay(channel, milliseconds); }
+  void sustain(float level){ bank->sustain(channel, level); }
+  void release(float milliseconds){ bank->release(channel, milliseconds); }
+  void releaseNoteOn(float milliseconds){ bank->releaseNoteOn(channel, milliseconds); }
+  bool isActive(){ return bank->isActive(channel); }
+  bool isSustain(){ return bank->isSustain(channel); }
+  bool process(const int16_t *input, int16_t *output){ return bank->process(channel, input, output); }
+  uint16_t mask(){ return 1 << channel; } //bit of the channel in the bank masks
+  private:
+  voice_envelope_bank *bank=nullptr;
+  uint8_t channel=0;
+};
+
+//same as AudioSynthWaveformModulated driven by frequency modulation
+class voice_oscillator{
+  public:
+  void begin(short type);
+  void begin(float amplitude, float frequency, short type);
+  void amplitude(float level);
+  void frequency(float frequency);
+  void frequencyModulation(float octaves);
+  /**
+  * Phase step multiplier of each sample, shared by the oscillators with the same modulation range
+  * @param modulation the modulation block, full scale moving by the modulation range in octaves
+  * @param factor modulation_factor() of the oscillators using the result
+  * @param scale one multiplier per sample, 0x10000 leaves the frequency unchanged
+  */
+  static void modulation_scale(const int16_t *modulation, int32_t factor, uint32_t *scale);
+  int32_t modulation_factor();
+  /**
+  * Generate one block
+  * @param scale from modulation_scale(), nullptr without modulation
+  * @param output generated block
+  * @return false when the amplitude is 0, the phase is still advanced
+  */
+  bool process(const uint32_t *scale, int16_t *output);
+  void advance(); //advance the phase of a block without generating it
+  private:
+  uint32_t phase_accumulator=0;
+  uint32_t phase_increment=0;
+  uint32_t prior_phase=0; //of the last sample of the previous block
+  int32_t magnitude=0;
+  int32_t factor=32768;
+  int16_t held_sample=0;
+  short tone_type=0;
+};
+
+//same as AudioSynthWaveformDc, including the timed transition
+class voice_dc{
+  public:
+  void amplitude(float level);
+  void amplitude(float level, float milliseconds);
+  void process(int16_t *output);
+  void advance(); //advance a transition by a block without generating it
+  private:
+  volatile uint8_t state=0; //0 steady, 1 in transition
+  int32_t magnitude=0;
+  int32_t target=0;
+  int32_t increment=0;
+};
+
+#if AUDIO_BLOCK_SAMPLES & (AUDIO_BLOCK_SAMPLES - 1)
+#error "the noise views permute the shared block and need blocks of a power of 2 samples"
+#endif
+
+//the white noise generator of AudioSynthNoiseWhite, one block shared by all the voice_noise
+//a new block is generated only when a noise asks again for the one it has already read, so nothing runs while no voice plays noise
+class voice_noise_source{
+  public:
+  /**
+  * Block of noise for one reader
+  * @param serial the serial of the last block read by the caller, updated
+  * @return full scale noise, valid until the next call
+  */
+  const int16_t *block(uint32_t &serial);
+  private:
+  uint32_t seed=1;
+  uint32_t current=0; //serial of the block in data
+  int16_t data[AUDIO_BLOCK_SAMPLES];
+};
+
+//same as AudioSynthNoiseWhite, reading the shared source through its own permutation of the block
+//sample i of the n-th noise is sample (i*(2n+1)+37n) of the block, which keeps the voices decorrelated
+class voice_noise{
+  public:
+  voice_noise();
+  void amplitude(float level);
+  bool process(int16_t *output); //false when the amplitude is 0
+  private:
+  static voice_noise_source source;
+  static uint16_t instance_count;
+  int32_t level=0;
+  uint32_t stride;
+  uint32_t offset;
+  uint32_t serial=0;
+};
+
+//the gains of an AudioMixer4, the channels are summed by mix_in()
+class voice_mixer{
+  public:
+  voice_mixer();
+  void gain(unsigned int channel, float gain);
+  /**
+  * Add a channel to the mix, with the saturation of AudioMixer4
+  * @param channel the input number, for its gain
+  * @param input block of the channel
+  * @param output the mix
+  * @param first true for the first channel present, which overwrites the mix
+  */
+  void mix_in(unsigned int channel, const int16_t *input, int16_t *output, bool first);
+  void mix_in(unsigned int channel, const int16_t *input, float *output, bool first); //same gains into a float mix, +-1.0 full scale and never saturated
+  bool muted(unsigned int channel){ return multiplier[channel] == 0; } //the channel adds nothing, it need not be computed
+  private:
+  int32_t multiplier[4];
+};
+
+//the gain of an AudioAmplifier, applied a sample at a time so that it can sit inside another loop
+class voice_amplifier{
+  public:
+  void gain(float n);
+  bool active(){ return multiplier != 0; } //AudioAmplifier transmits nothing at 0 gain
+  int32_t apply(int32_t sample){
+    if(multiplier == 65536){
+      return sample;
+    }
+    return signed_saturate_rshift(signed_multiply_32x16b(multiplier, sample), 16, 0);
+  }
+  private:
+  volatile int32_t multiplier=65536;
+};
+
+#define FILTER_LANES 4 //filters run together by process_lanes()
+
+//AudioFilterStateVariable, the bandpass and highpass outputs are optional
+class voice_filter{
+  public:
+  voice_filter();
+  void frequency(float frequency);
+  void resonance(float q);
+  void octaveControl(float octaves);
+  /**
+  * Filter one block
+  * @param input block to be filtered
+  * @param control corner frequency control, +-1.0 for +-octaveControl octaves, nullptr for a fixed corner
+  * @param lowpass the lowpass output, can be the input
+  * @param bandpass the bandpass output, nullptr when not needed
+  * @param highpass the highpass output, nullptr when not needed
+  */
+  void process(const int16_t *input, const int16_t *control, int16_t *lowpass, int16_t *bandpass=nullptr, int16_t *highpass=nullptr);
+  /**
+  * Lowpass of up to FILTER_LANES filters in lock-step, each with its own settings, same result as their process()
+  * @param filters the filters of the lanes
+  * @param blocks input of each lane, replaced by its lowpass output
+  * @param controls control of each lane as in process(), nullptr for a fixed corner
+  * @param count number of lanes, 1 to FILTER_LANES
+  */
+  static void process_lanes(voice_filter *const *filters, int16_t *const *blocks, const int16_t *const *controls, int count);
+  void reset(){ state_inputprev = state_lowpass = state_bandpass = 0; } //back to rest, for a filter that was stopped
+  private:
+  template <int lanes> static void run_lanes(voice_filter *const *filters, int16_t *const *blocks, const int16_t *const *controls);
+  int32_t setting_fcenter;
+  int32_t setting_fmult;
+  int32_t setting_octavemult;
+  int32_t setting_damp;
+  int32_t state_inputprev=0;
+  int32_t state_lowpass=0;
+  int32_t state_bandpass=0;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "table_waveshaper.h"
+
+table_waveshaper::table_waveshaper() : AudioStream(1, inputQueueArray){
+}
+
+void table_waveshaper::shape(const int16_t *table){
+  this->table = table;
+}
+
+void table_waveshaper::update(void){
+  const int16_t *current_table = table; //read once, the shape can be changed from outside the audio interrupt
+  if(!current_table){
+    return;
+  }
+  audio_block_t *block = receiveWritable();
+  if(!block){
+    return;
+  }
+  for(int i = 0; i < AUDIO_BLOCK_SAMPLES; i++){
+    //the high 8 bits index the table, the low 8 bits interpolate between two entries
+    uint16_t x = block->data[i] + 32768;
+    uint16_t index = x >> 8;
+    int16_t low = current_table[index];
+    int16_t high = current_table[index + 1];
+    block->data[i] = low + (((high - low) * (x & 0xFF)) >> 8);
+  }
+  transmit(block);
+  release(block);
+}
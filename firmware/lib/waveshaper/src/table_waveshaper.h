@@ -0,0 +1,23 @@
+#ifndef TABLE_WAVESHAPER_H
+#define TABLE_WAVESHAPER_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+
+//same processing as AudioEffectWaveshaper, but the transfer function is a table of 257 int16_t owned by the caller
+//AudioEffectWaveshaper::shape() frees, allocates and converts its own copy, here changing the shape only swaps a pointer, so the tables can stay in flash
+class table_waveshaper : public AudioStream{
+  public:
+  table_waveshaper();
+  virtual void update(void);
+  /**
+  * Select the transfer function
+  * @param table 257 values from -32767 to 32767, for inputs from -32768 to 32768, must outlive its use, nullptr stops the output
+  */
+  void shape(const int16_t *table);
+  private:
+  audio_block_t *inputQueueArray[1];
+  const int16_t *volatile table=nullptr;
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "wide_mixer.h"
+#include "utility/dspinst.h"
+
+#define MULTI_UNITYGAIN 65536
+
+wide_mixer_base::wide_mixer_base(unsigned char channels, audio_block_t **queue, int32_t *multiplier) : AudioStream(channels, queue){
+  this->channels = channels;
+  this->multiplier = multiplier;
+  for(int i = 0; i < channels; i++){
+    multiplier[i] = MULTI_UNITYGAIN;
+  }
+}
+
+void wide_mixer_base::gain(unsigned int channel, float gain){
+  if(channel >= channels){
+    return;
+  }
+  if(gain > 32767.0f){
+    gain = 32767.0f;
+  }else if(gain < -32767.0f){
+    gain = -32767.0f;
+  }
+  multiplier[channel] = gain * 65536.0f;
+}
+
+//the gain and saturation of AudioMixer4, two samples at a time
+static void apply_gain(int16_t *data, const int16_t *input, int32_t mult){
+  uint32_t *p = (uint32_t *)data;
+  const uint32_t *in = (const uint32_t *)input;
+  const uint32_t *end = (uint32_t *)(data + AUDIO_BLOCK_SAMPLES);
+  do{
+    uint32_t tmp32 = *in++;
+    int32_t val1 = signed_saturate_rshift(signed_multiply_32x16b(mult, tmp32), 16, 0);
+    int32_t val2 = signed_saturate_rshift(signed_multiply_32x16t(mult, tmp32), 16, 0);
+    *p++ = pack_16b_16b(val2, val1);
+  }while(p < end);
+}
+
+static void add_with_gain(int16_t *data, const int16_t *input, int32_t mult){
+  uint32_t *p = (uint32_t *)data;
+  const uint32_t *in = (const uint32_t *)input;
+  const uint32_t *end = (uint32_t *)(data + AUDIO_BLOCK_SAMPLES);
+  if(mult == MULTI_UNITYGAIN){
+    do{
+      *p = signed_add_16_and_16(*p, *in++);
+      p++;
+    }while(p < end);
+  }else{
+    do{
+      uint32_t tmp32 = *in++;
+      int32_t val1 = signed_saturate_rshift(signed_multiply_32x16b(mult, tmp32), 16, 0);
+      int32_t val2 = signed_saturate_rshift(signed_multiply_32x16t(mult, tmp32), 16, 0);
+      *p = signed_add_16_and_16(pack_16b_16b(val2, val1), *p);
+      p++;
+    }while(p < end);
+  }
+}
+
+void wide_mixer_base::update(void){
+  audio_block_t *inputs[WIDE_MIXER_MAX_CHANNELS];
+  int count = 0;
+  for(int i = 0; i < channels; i++){
+    audio_block_t *block = receiveReadOnly(i);
+    if(block && multiplier[i] == 0){
+      release(block);
+      block = nullptr;
+    }
+    inputs[i] = block;
+    if(block){
+      count++;
+    }
+  }
+  if(count == 0){
+    return;
+  }
+  audio_block_t *out = nullptr;
+  for(int i = 0; i < channels; i++){
+    audio_block_t *in = inputs[i];
+    if(!in){
+      continue;
+    }
+    if(!out){
+      if(count == 1 && multiplier[i] == MULTI_UNITYGAIN){
+        transmit(in);
+        release(in);
+        return;
+      }
+      //the first input becomes the output when no other object holds it, as receiveWritable() would do
+      if(in->ref_count == 1){
+        out = in;
+        if(multiplier[i] != MULTI_UNITYGAIN){
+          apply_gain(out->data, out->data, multiplier[i]);
+        }
+        continue;
+      }
+      out = allocate();
+      if(!out){
+        //no block left, the inputs are dropped as AudioMixer4 would
+        for(int j = i; j < channels; j++){
+          if(inputs[j]){
+            release(inputs[j]);
+          }
+        }
+        return;
+      }
+      if(multiplier[i] == MULTI_UNITYGAIN){
+        memcpy(out->data, in->data, sizeof(out->data));
+      }else{
+        apply_gain(out->data, in->data, multiplier[i]);
+      }
+    }else{
+      add_with_gain(out->data, in->data, multiplier[i]);
+    }
+    release(in);
+  }
+  transmit(out);
+  release(out);
+}
@@ -0,0 +1,34 @@
+#ifndef WIDE_MIXER_H
+#define WIDE_MIXER_H
+
+#include "Arduino.h"
+#include "AudioStream.h"
+
+#define WIDE_MIXER_MAX_CHANNELS 16
+
+//same result and gain() as AudioMixer4, for up to WIDE_MIXER_MAX_CHANNELS inputs summed in a single pass
+//inputs at zero gain are dropped unread and inputs at unity gain are added without multiply
+//a single input at unity gain is passed on as is, without a new block
+class wide_mixer_base : public AudioStream{
+  public:
+  wide_mixer_base(unsigned char channels, audio_block_t **queue, int32_t *multiplier);
+  virtual void update(void);
+  void gain(unsigned int channel, float gain);
+  bool muted(unsigned int channel){ return channel >= channels || multiplier[channel] == 0; } //the input is dropped unread
+  private:
+  unsigned char channels;
+  int32_t *multiplier; //65536 is unity gain
+};
+
+template <unsigned char inputs>
+class wide_mixer : public wide_mixer_base{
+  static_assert(inputs > 0 && inputs <= WIDE_MIXER_MAX_CHANNELS, "wide_mixer takes 1 to 16 inputs");
+  public:
+  wide_mixer() : wide_mixer_base(inputs, inputQueueArray, multiplier_array){
+  }
+  private:
+  audio_block_t *inputQueueArray[inputs];
+  int32_t multiplier_array[inputs];
+};
+
+#endif
@@ -10,9 +10,10 @@
 #include <debouncer.h>
 #include <harp.h>
 #include <potentiometer.h>
+#include <preset_storage.h>
 
 //>>SOFWTARE VERSION 
-int version_ID=8; //to be read 00.03, stored at adress 7 in memory
+int version_ID=9; //to be read 00.03, stored at adress 7 in memory
 //>>BUTTON ARRAYS<<
 debouncer harp_array[12];
 debouncer chord_matrix_array[22];
@@ -29,6 +30,24 @@ potentiometer chord_pot(POT_CHORD_PIN);
 potentiometer harp_pot(POT_HARP_PIN);
 potentiometer mod_pot(POT_MOD_PIN);
 LittleFS_Program myfs; // to save the settings
+preset_storage presets; // RAM copy of all the banks, written back to myfs in the background
+uint32_t last_save_slice_update = 0; // to do a single save slice per audio update
+elapsedMicros boot_stage_timer; // to report the duration of each stage of the boot
+#define AUDIO_MEMORY_MARGIN 64 // blocks kept above the measured peak
+#ifdef AUDIO_MEMORY_FROM_PEAK
+// AUDIO_MEMORY_MEASURED_PEAK is the peak block usage reported by an AUDIO_POOL_STRESS build of the same graph, it has no default
+#ifndef AUDIO_MEMORY_MEASURED_PEAK
+#error "AUDIO_MEMORY_FROM_PEAK needs -D AUDIO_MEMORY_MEASURED_PEAK=<peak>, as reported by an AUDIO_POOL_STRESS build of this graph"
+#endif
+const uint16_t audio_memory_blocks = AUDIO_MEMORY_MEASURED_PEAK + AUDIO_MEMORY_MARGIN;
+#else
+const uint16_t audio_memory_blocks = 784; // the delays keep their history in their own ring buffers, not in these blocks
+#endif
+#define MAIN_REVERB_SCALE 1.0f // size of the plate, each reverb begun on the arena gets its own
+DMAMEM uint8_t reverb_memory[AudioEffectPlateReverb::memory_size(MAIN_REVERB_SCALE)] __attribute__((aligned(4))); // lines of the reverb, to be enlarged by the memory_size() of each added instance
+#define DELAY_MAX_MS 600 // longest delay length of the sysex parameters
+DMAMEM int16_t string_delay_memory[feedback_delay::memory_samples(DELAY_MAX_MS)]; // ring buffers of the delays
+DMAMEM int16_t chord_delay_memory[feedback_delay::memory_samples(DELAY_MAX_MS)];
 float color_led_blink_val = 1.0;
 bool led_blinking_flag = false;
 float led_attenuation = 0.0; 
@@ -110,20 +129,9 @@ bool chromatic_harp_mode = false; // to switch the harp to chromatic mode
 // SYSEX midi message are used to control up to 256 synthesis parameters.
 const uint16_t parameter_size = 256;
 const uint8_t preset_number = 12;
-int16_t default_bank_sysex_parameters[preset_number][parameter_size] = {
-  {0,0,50,50,512,512,512,0,0,0,192,100,49,100,184,100,157,100,0,0,0,0,0,0,43,0,50,37,38,67,0,0,0,0,0,0,0,0,0,0,0,16,0,8,8,12,42,1171,1,423,20,70,3,35,83,59,2658,1,0,0,0,0,0,0,0,1,1,1,100,1,1,0,1,1,1,1,14,0,0,70,0,0,0,100,0,6,0,0,755,195,23,61,29,0,0,0,0,162,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,13,8,100,16,0,200,0,0,50,0,50,18,32,50,0,0,10,66,353,65,995,1,569,16,141,32,83,28,48,54,1,0,0,0,56,0,389,0,20,0,0,0,0,1,1,1,0,1,1,0,1,1,1,1,0,0,0,70,0,0,0,100,0,64,0,0,80,16,4,94,753,474,70,5,100,100,100,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,16,0,6,6,32,0,6,0,16,0,6,6,32,0,6,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,194,100,85,100,60,100,61,100,0,0,10,1,0,0,0,0,0,0,0,100,0,0,0,0,0,0,0,0,0,0,4,25,8,3,29,18,65,488,3,159,25,70,5,18,4,26,6,1,77,0,587,32,0,390,0,76,1,1,100,1,1,68,17,14,22,20,0,340,1682,70,48,0,0,100,18,54,0,0,800,70,57,100,100,0,0,0,0,199,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,4,7,0,100,0,0,100,6,8,200,2,50,36,75,50,28,0,3,1,1,80,1218,2,1659,38,114,19,8,32,80,1,1,0,30,0,0,0,0,0,0,0,24,0,3,1,1,1,100,1,1,100,1,1,1,1,31,0,0,70,0,0,0,100,0,33,2,1,162,16,4,100,100,1436,118,100,50,32,107,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,7,0,0,0,13,0,4,0,7,0,0,2,13,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,192,100,49,100,184,100,157,100,0,0,30,0,1,1,87,33,62,12,80,67,0,0,0,0,0,0,0,0,0,0,0,6,3,8,8,12,42,1855,1,42,20,217,3,35,83,59,2658,1,185,0,282,14,0,247,11,1,1,1,100,1,1,0,1,1,1,1,14,0,0,70,0,0,0,100,0,23,0,0,755,195,82,61,29,0,0,0,0,162,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,13,0,100,23,8,200,0,0,50,0,50,18,32,50,0,0,10,66,353,44,1452,1,569,16,141,32,83,28,48,54,1,0,698,82,56,0,579,0,28,0,0,0,0,1,1,1,0,1,1,100,1,1,1,1,0,0,0,70,0,0,0,100,0,100,0,0,80,16,4,94,753,474,70,5,100,100,100,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,16,0,6,6,32,0,6,0,16,0,6,6,32,0,6,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,196,76,92,100,184,100,85,100,0,0,60,0,1,0,14,0,0,0,42,46,0,0,0,0,0,0,0,0,0,0,3,10,8,11,42,30,61,2137,1,106,22,140,4,35,83,24,1956,1,139,0,282,0,0,247,10,1,1,1,100,1,1,0,1,1,1,1,0,0,0,70,0,0,0,100,0,57,0,1,858,70,66,100,100,0,0,0,0,127,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,17,8,200,11,0,134,10,0,100,7,50,59,15,50,0,15,10,10,45,61,1489,1,652,16,84,32,21,15,33,19,1,0,490,0,109,0,252,0,8,0,244,1,49,1,1,1,15,1,1,100,1,1,1,1,26,479,1931,70,0,50,0,100,40,78,21,0,162,16,4,100,1000,639,140,100,47,100,85,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,65,0,12,0,0,12,0,0,65,0,6,0,0,6,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,146,100,76,100,85,79,184,100,0,0,110,0,0,0,57,0,0,0,67,58,0,0,0,0,0,0,0,0,0,0,0,6,8,8,65,12,38,1855,5,57,24,152,3,35,83,59,2658,6,137,0,640,8,0,247,11,1,1,1,100,1,1,131,4,116,3,1,11,424,1360,70,46,0,0,100,60,85,0,0,996,125,82,61,71,0,0,0,0,90,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,20,0,100,23,0,200,15,8,100,0,50,0,18,50,0,0,2,293,17,44,1012,1,10,33,141,32,83,28,67,239,1,0,0,0,287,0,579,0,0,0,366,0,35,5,52,12,0,1,1,100,1,1,1,1,16,0,0,70,0,0,0,100,0,50,0,0,184,16,4,100,100,657,70,86,100,100,95,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,7,0,0,2,4,2,15,0,2,2,6,2,6,15,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,192,60,47,56,159,100,157,100,0,0,138,1,0,0,0,0,0,0,27,74,0,0,0,0,0,0,0,0,0,0,4,14,11,3,29,18,65,1102,3,302,11,70,5,18,4,26,6,1,38,0,516,16,0,0,0,76,1,1,100,1,1,68,17,14,22,20,0,340,1682,70,48,0,0,100,18,58,0,0,800,70,43,100,100,0,0,0,0,200,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,4,10,11,100,9,0,200,4,8,200,0,50,36,75,50,0,0,3,1,1,80,1855,2,769,15,114,19,8,32,80,1,1,0,30,0,11,0,467,0,35,0,24,0,3,1,1,1,100,1,1,100,1,1,1,1,0,341,2164,70,54,0,0,100,36,42,0,1,80,16,4,100,20,2101,70,100,6,22,55,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,2,4,8,17,0,12,0,1,2,4,8,16,6,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,192,100,61,100,130,100,83,100,0,0,175,0,0,0,0,0,0,0,0,35,0,0,0,0,0,0,0,0,0,0,0,12,9,11,1,1,70,2141,1,383,17,302,101,103,34,30,1,12,0,0,367,17,0,363,5,1,1,1,86,1,1,0,1,1,1,1,8,0,0,70,0,0,0,100,0,33,50,0,5000,70,100,0,0,0,0,0,0,90,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,5,9,9,200,13,6,99,6,0,50,27,50,50,50,50,0,0,345,1,1,80,800,32,2200,0,70,1,1,1,100,1,1,0,30,0,0,0,166,0,6,0,0,0,0,1,1,1,0,1,1,100,1,1,1,1,0,0,0,70,0,0,0,100,0,59,100,0,80,16,4,100,100,2366,70,100,40,23,57,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,4,4,16,16,12,0,1,6,8,6,0,6,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,146,100,76,100,85,79,184,100,0,0,220,0,0,0,0,0,0,86,55,63,0,0,0,0,0,0,0,0,0,0,0,6,8,8,65,12,38,1855,5,57,24,152,3,35,83,59,2658,6,137,0,640,8,0,247,11,1,1,1,100,1,1,131,4,116,3,1,11,424,1360,70,46,0,0,100,60,84,0,0,996,125,82,61,71,0,0,0,0,90,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,20,0,100,23,0,200,15,8,100,0,50,0,18,50,0,0,2,293,17,44,1012,1,10,33,141,32,83,28,67,239,1,0,0,0,287,0,579,0,0,0,366,0,35,5,52,12,0,1,1,100,1,1,1,1,16,0,0,70,0,0,0,100,0,50,0,0,184,16,4,100,100,657,70,86,100,100,95,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,7,0,0,2,4,2,15,0,2,2,6,2,6,15,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,196,100,47,56,159,100,157,100,0,0,253,1,0,0,0,0,0,0,0,59,0,0,0,0,0,0,0,0,0,0,4,15,11,3,29,18,65,1102,3,302,11,70,5,18,4,26,6,1,38,0,516,16,0,0,12,76,1,22,100,1,1,68,17,14,22,20,0,340,1682,70,48,0,0,100,18,58,0,0,800,70,43,100,100,0,0,0,0,158,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,4,10,0,100,9,0,200,4,8,200,0,50,36,75,50,0,0,3,1,1,80,1855,2,769,15,114,19,8,32,80,1,1,0,30,0,11,0,467,0,22,0,24,0,3,1,1,1,100,1,1,100,1,1,1,1,0,341,2164,70,54,0,0,100,36,42,0,1,80,16,4,100,20,532,70,100,6,82,96,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,2,4,8,17,0,12,0,1,2,4,8,16,6,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,149,69,76,100,85,79,184,100,0,0,266,0,0,0,0,0,0,0,65,70,0,0,0,0,0,0,0,0,0,0,0,5,0,8,65,12,38,1855,5,57,24,152,3,35,83,59,2658,6,137,0,640,8,0,247,11,1,1,1,100,1,1,131,4,116,3,1,0,424,1360,70,46,0,0,100,60,81,0,0,996,125,82,61,71,0,0,0,0,108,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,20,12,100,23,0,200,15,8,100,0,50,45,17,0,0,0,2,293,17,44,1012,1,10,33,141,32,83,28,67,239,1,0,0,0,287,0,579,0,0,0,366,0,35,5,52,12,0,1,1,100,1,1,1,1,16,0,0,70,0,0,0,100,0,50,0,0,184,16,4,100,100,857,70,42,100,100,158,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,7,0,0,2,4,2,15,0,2,2,6,2,6,15,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,192,55,61,100,184,100,85,100,0,0,310,0,0,0,86,0,56,87,37,60,0,0,0,0,0,0,0,0,0,0,4,15,12,36,42,30,59,1410,1,30,33,140,4,35,83,24,615,1,94,0,282,15,0,247,0,1,1,1,100,1,1,0,1,1,1,1,0,0,0,70,0,0,0,100,0,40,0,1,858,70,46,100,82,0,0,0,0,124,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,16,8,200,18,0,134,21,0,200,2,50,59,15,50,18,15,10,66,43,35,711,1,271,16,84,32,83,733,31,54,1,0,698,0,220,0,252,0,8,0,244,1,49,1,1,1,15,1,1,100,1,1,1,1,26,479,1931,70,0,50,0,100,34,75,0,0,162,16,4,100,1000,1889,116,49,100,42,129,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,65,0,12,0,0,12,0,0,65,0,6,0,0,6,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-  {0,0,50,50,512,512,512,0,0,0,194,100,85,100,60,100,61,100,0,0,340,1,0,0,0,0,0,0,0,62,0,0,0,0,0,0,0,0,0,0,4,25,3,3,29,18,65,488,3,159,25,70,5,18,4,26,40,1,77,0,587,32,0,715,11,76,1,1,100,1,1,68,17,14,22,20,17,340,1682,70,48,0,0,100,18,54,0,0,800,70,57,100,100,0,0,0,0,199,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,3,1,100,0,0,100,6,8,200,2,50,36,75,50,28,0,3,1,1,80,1218,2,706,38,114,19,8,32,80,1,1,0,30,0,0,0,0,0,0,0,24,0,3,1,1,1,100,1,1,100,1,1,1,1,31,0,0,70,0,0,0,100,0,33,2,1,162,16,4,100,100,678,118,100,50,32,168,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,7,0,0,0,13,0,4,0,7,0,0,2,13,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
-}; 
+// the autogenerated factory presets and waveshaper tables (see ./generator for the script)
+#include <factory_presets.h>
+#include <waveshaper_tables.h>
 int16_t current_sysex_parameters[parameter_size] = {0,0,50,50,512,512,512,1,0,0,192,100,49,100,184,100,157,100,0,0,0,0,0,0,0,0,0,0,0,67,0,0,0,0,0,0,0,0,0,0,0,16,0,8,8,12,42,1171,1,423,20,70,3,35,83,59,2658,1,0,0,0,0,0,0,0,1,1,1,100,1,1,0,1,1,1,1,14,0,0,70,0,0,0,100,0,6,0,0,755,195,23,61,29,0,0,0,0,162,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,13,8,100,16,0,200,0,0,50,0,50,18,32,50,0,0,10,66,353,65,995,1,569,16,141,32,83,28,48,54,1,0,0,0,56,0,389,0,20,0,0,0,0,1,1,1,0,1,1,0,1,1,1,1,0,0,0,70,0,0,0,100,0,38,0,0,80,16,4,94,753,474,70,5,100,100,100,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,16,0,6,6,32,0,6,0,16,0,6,6,32,0,6,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 const char *bank_name[preset_number] = {"a.txt", "b.txt", "c.txt", "d.txt", "e.txt", "f.txt", "g.txt", "h.txt", "i.txt", "j.txt", "k.txt", "l.txt"};
 int8_t current_bank_number = 0;
@@ -154,6 +162,28 @@ int8_t mod_pot_alternate_range = 17;
 bool sysex_controler_connected=false; //bool to remember if there is a controller that is connected to avoid saving any change
 
 //>>AUDIO OBJECT ARRAYS<<
+#ifdef SYNTH_FUSED_VOICES
+// for the strings
+voice_oscillator *string_waveform_array[12] = {&harp_strings.strings[0].oscillator, &harp_strings.strings[1].oscillator, &harp_strings.strings[2].oscillator, &harp_strings.strings[3].oscillator, &harp_strings.strings[4].oscillator, &harp_strings.strings[5].oscillator, &harp_strings.strings[6].oscillator, &harp_strings.strings[7].oscillator, &harp_strings.strings[8].oscillator, &harp_strings.strings[9].oscillator, &harp_strings.strings[10].oscillator, &harp_strings.strings[11].oscillator};
+voice_envelope *string_enveloppe_array[12] = {&harp_strings.strings[0].envelope, &harp_strings.strings[1].envelope, &harp_strings.strings[2].envelope, &harp_strings.strings[3].envelope, &harp_strings.strings[4].envelope, &harp_strings.strings[5].envelope, &harp_strings.strings[6].envelope, &harp_strings.strings[7].envelope, &harp_strings.strings[8].envelope, &harp_strings.strings[9].envelope, &harp_strings.strings[10].envelope, &harp_strings.strings[11].envelope};
+voice_envelope *string_enveloppe_filter_array[12] = {&harp_strings.strings[0].envelope_filter, &harp_strings.strings[1].envelope_filter, &harp_strings.strings[2].envelope_filter, &harp_strings.strings[3].envelope_filter, &harp_strings.strings[4].envelope_filter, &harp_strings.strings[5].envelope_filter, &harp_strings.strings[6].envelope_filter, &harp_strings.strings[7].envelope_filter, &harp_strings.strings[8].envelope_filter, &harp_strings.strings[9].envelope_filter, &harp_strings.strings[10].envelope_filter, &harp_strings.strings[11].envelope_filter};
+voice_filter *string_filter_array[12] = {&harp_strings.strings[0].filter, &harp_strings.strings[1].filter, &harp_strings.strings[2].filter, &harp_strings.strings[3].filter, &harp_strings.strings[4].filter, &harp_strings.strings[5].filter, &harp_strings.strings[6].filter, &harp_strings.strings[7].filter, &harp_strings.strings[8].filter, &harp_strings.strings[9].filter, &harp_strings.strings[10].filter, &harp_strings.strings[11].filter};
+voice_oscillator *string_transient_waveform_array[12] = {&harp_strings.strings[0].transient, &harp_strings.strings[1].transient, &harp_strings.strings[2].transient, &harp_strings.strings[3].transient, &harp_strings.strings[4].transient, &harp_strings.strings[5].transient, &harp_strings.strings[6].transient, &harp_strings.strings[7].transient, &harp_strings.strings[8].transient, &harp_strings.strings[9].transient, &harp_strings.strings[10].transient, &harp_strings.strings[11].transient};
+voice_envelope *string_transient_envelope_array[12] = {&harp_strings.strings[0].transient_envelope, &harp_strings.strings[1].transient_envelope, &harp_strings.strings[2].transient_envelope, &harp_strings.strings[3].transient_envelope, &harp_strings.strings[4].transient_envelope, &harp_strings.strings[5].transient_envelope, &harp_strings.strings[6].transient_envelope, &harp_strings.strings[7].transient_envelope, &harp_strings.strings[8].transient_envelope, &harp_strings.strings[9].transient_envelope, &harp_strings.strings[10].transient_envelope, &harp_strings.strings[11].transient_envelope};
+// for the chord
+voice_envelope *chord_vibrato_envelope_array[4] = {&voice1.vibrato_envelope, &voice2.vibrato_envelope, &voice3.vibrato_envelope, &voice4.vibrato_envelope};
+voice_envelope *chord_vibrato_dc_envelope_array[4] = {&voice1.vibrato_dc_envelope, &voice2.vibrato_dc_envelope, &voice3.vibrato_dc_envelope, &voice4.vibrato_dc_envelope};
+voice_mixer *chord_vibrato_mixer_array[4] = {&voice1.vibrato_mixer, &voice2.vibrato_mixer, &voice3.vibrato_mixer, &voice4.vibrato_mixer};
+voice_oscillator *chord_osc_1_array[4] = {&voice1.osc1, &voice2.osc1, &voice3.osc1, &voice4.osc1};
+voice_oscillator *chord_osc_2_array[4] = {&voice1.osc2, &voice2.osc2, &voice3.osc2, &voice4.osc2};
+voice_oscillator *chord_osc_3_array[4] = {&voice1.osc3, &voice2.osc3, &voice3.osc3, &voice4.osc3};
+voice_dc *chord_freq_dc_array[4] = {&voice1.frequency_dc, &voice2.frequency_dc, &voice3.frequency_dc, &voice4.frequency_dc};
+voice_noise *chord_noise_array[4] = {&voice1.noise, &voice2.noise, &voice3.noise, &voice4.noise};
+voice_mixer *chord_voice_mixer_array[4] = {&voice1.mixer, &voice2.mixer, &voice3.mixer, &voice4.mixer};
+voice_filter *chord_voice_filter_array[4] = {&voice1.filter, &voice2.filter, &voice3.filter, &voice4.filter};
+voice_envelope *chord_envelope_filter_array[4] = {&voice1.envelope_filter, &voice2.envelope_filter, &voice3.envelope_filter, &voice4.envelope_filter};
+voice_envelope *chord_envelope_array[4] = {&voice1.envelope, &voice2.envelope, &voice3.envelope, &voice4.envelope};
+#else
 // for the strings
 AudioSynthWaveformModulated *string_waveform_array[12] = {&waveform_string_1, &waveform_string_2, &waveform_string_3, &waveform_string_4, &waveform_string_5, &waveform_string_6, &waveform_string_7, &waveform_string_8, &waveform_string_9, &waveform_string_10, &waveform_string_11, &waveform_string_12};
 AudioEffectEnvelope *string_enveloppe_array[12] = {&envelope_string_1, &envelope_string_2, &envelope_string_3, &envelope_string_4, &envelope_string_5, &envelope_string_6, &envelope_string_7, &envelope_string_8, &envelope_string_9, &envelope_string_10, &envelope_string_11, &envelope_string_12};
@@ -178,10 +208,11 @@ AudioEffectEnvelope *chord_envelope_filter_array[4] = {&voice1_envelope_filter,
 AudioEffectMultiply *chord_tremolo_mult_array[4] = {&voice1_tremolo_mult, &voice2_tremolo_mult, &voice3_tremolo_mult, &voice4_tremolo_mult};
 AudioEffectEnvelope *chord_envelope_array[4] = {&voice1_envelope, &voice2_envelope, &voice3_envelope, &voice4_envelope};
 
+#endif
+
 //>>SYNTHESIS VARIABLE<<
-// waveshaper shape
-float wave_shape[257] = {};
-float ws_sin_param = 1;
+// waveshaper shape, the crunch type selecting one of the tables of waveshaper_tables.h
+int ws_sin_param = 1;
 // waveform array 
 int8_t waveform_array[12] = {
     0, //WAVEFORM_SINE
@@ -293,7 +324,6 @@ void recalculate_timer();
 uint8_t calculate_note_harp(uint8_t string, bool slashed, bool sharp);
 uint8_t calculate_note_chord(uint8_t voice, bool slashed, bool sharp);
 void set_chord_voice_frequency(uint8_t i, uint16_t current_note);
-void calculate_ws_array();
 void rythm_tick_function();
 
 //-->>LED HSV CALCULATION
@@ -374,7 +404,9 @@ void control_command(uint8_t command, uint8_t parameter) {
   case 1: // SIGNAL TO WIPE MEMORY
     Serial.println("Wiping memory");
     digitalWrite(_MUTE_PIN, LOW); // muting the DAC
+    presets.cancel_save();
     myfs.quickFormat();
+    presets.load_all(); // every bank goes back to default and will be rewritten
     current_bank_number = 0;
     load_config(current_bank_number);
     digitalWrite(_MUTE_PIN, HIGH); // unmuting the DAC
@@ -395,6 +427,69 @@ void control_command(uint8_t command, uint8_t parameter) {
     break;
   }
 }
+//-->>AUDIO PRUNING
+// the sections whose contribution to the output is exactly zero are taken out of the graph
+// called by the sysex methods of the gains they depend on, with the audio interrupt held so that the gain and the graph change in the same update
+// a waveshaper is cut at its input and does nothing, the output filters and the delays are suspended
+// a suspended output filter restarts from rest, a suspended delay keeps recording its input and fades its tap back in
+// with SYNTH_FUSED_VOICES the harp strings and chord voices are suspended at the source, only their envelopes and phases keep moving
+// the transients and the chord noise skip themselves when their level is 0
+bool audio_pruning_enabled = true; // false runs the whole graph, to measure what the pruning saves
+bool string_waveshape_cut = false;
+bool chord_waveshape_cut = false;
+
+// connects or cuts a cord when its state changes
+void prune_cord(AudioConnection &cord, bool &cut, bool silent) {
+  if (silent == cut) {
+    return;
+  }
+  if (silent) {
+    cord.disconnect();
+  } else {
+    cord.connect();
+  }
+  cut = silent;
+}
+
+void prune_audio_sections() {
+  bool strings_heard = !audio_pruning_enabled || !string_filter_mixer.muted(0) || !string_filter_mixer.muted(1) || !string_filter_mixer.muted(2);
+  bool chords_heard = !audio_pruning_enabled || !chords_main_filter_mixer.muted(0) || !chords_main_filter_mixer.muted(1) || !chords_main_filter_mixer.muted(2);
+  string_filter.suspend(!strings_heard);
+  chords_main_filter.suspend(!chords_heard);
+  prune_cord(patchCord176, string_waveshape_cut, !strings_heard || (audio_pruning_enabled && string_waveshaper_mix.muted(1)));
+  prune_cord(patchCord189, chord_waveshape_cut, !chords_heard || (audio_pruning_enabled && chord_waveshaper_mix.muted(1)));
+  delay_strings.suspend(!strings_heard || (audio_pruning_enabled && strings_effect_mix.muted(1)));
+  delay_chords.suspend(!chords_heard || (audio_pruning_enabled && chords_effect_mix.muted(1)));
+#ifdef SYNTH_FUSED_VOICES
+  harp_strings.suspend(!strings_heard);
+  voice1.suspend(!chords_heard);
+  voice2.suspend(!chords_heard);
+  voice3.suspend(!chords_heard);
+  voice4.suspend(!chords_heard);
+#endif
+}
+
+// the sections out of the graph, comma separated
+void print_pruned_sections(Print &output) {
+  const char *names[8] = {"harp strings", "chord voices", "string filter", "chord filter", "string waveshaper", "chord waveshaper", "string delay", "chord delay"};
+#ifdef SYNTH_FUSED_VOICES
+  bool sources_suspended[2] = {harp_strings.is_suspended(), voice1.is_suspended()};
+#else
+  bool sources_suspended[2] = {false, false}; // the library voices have no suspend
+#endif
+  bool pruned[8] = {sources_suspended[0], sources_suspended[1], string_filter.is_suspended(), chords_main_filter.is_suspended(), string_waveshape_cut, chord_waveshape_cut, delay_strings.is_suspended(), delay_chords.is_suspended()};
+  bool first = true;
+  for (int i = 0; i < 8; i++) {
+    if (pruned[i]) {
+      output.printf("%s%s", first ? "" : ", ", names[i]);
+      first = false;
+    }
+  }
+  if (first) {
+    output.print("none");
+  }
+}
+
 // the autogenerated code (see ./generator for the script)
 #include <sysex_handler.h>
 void processMIDI(void) {
@@ -452,6 +547,80 @@ void processMIDI(void) {
   }
 }
 
+//-->>MODULATION ROUTES
+// the routes of the modulation matrix that target a sysex parameter move it around its base value, as the potentiometers do
+// the base is the value a potentiometer applied on the adress, or the stored value when no potentiometer applied one over it
+// only the continuous parameters of is_modulatable() can be routed, a route to another adress does nothing
+// the modulated value is kept within the range of the parameter by constrain_modulated(), so that no route drives a feedback above unity or a delay past its memory
+// a value is applied only when it changes, and never stored so that the presets keep the unmodulated setting
+#define POT_RECORDS 6 // the main and alternate adresses of the three potentiometers
+uint8_t pot_record_adress[POT_RECORDS] = {0};
+int pot_record_value[POT_RECORDS] = {0};
+int pot_record_stored[POT_RECORDS] = {0}; // the stored value it was applied over, a new stored value makes the record stale
+uint8_t pot_record_next = 0;
+uint8_t route_applied_adress[MODULATION_ROUTES] = {0};
+int route_applied_value[MODULATION_ROUTES] = {0};
+int route_applied_base[MODULATION_ROUTES] = {0};
+
+// the value the routes move around
+int route_base(uint8_t adress) {
+  for (uint8_t i = 0; i < POT_RECORDS; i++) {
+    if (pot_record_adress[i] == adress && pot_record_stored[i] == current_sysex_parameters[adress]) {
+      return pot_record_value[i];
+    }
+  }
+  return current_sysex_parameters[adress];
+}
+
+// the callback of the potentiometers, a routed adress is left to its route which moves around the new value
+void apply_pot_parameter(int adress, int value) {
+  uint8_t record = pot_record_next;
+  for (uint8_t i = 0; i < POT_RECORDS; i++) {
+    if (pot_record_adress[i] == adress) {
+      record = i;
+    }
+  }
+  if (record == pot_record_next) {
+    pot_record_next = (pot_record_next + 1) % POT_RECORDS;
+  }
+  pot_record_adress[record] = adress;
+  pot_record_value[record] = value;
+  pot_record_stored[record] = current_sysex_parameters[adress];
+  for (uint8_t i = 0; i < MODULATION_ROUTES; i++) {
+    if (route_applied_adress[i] == adress) {
+      return;
+    }
+  }
+  apply_audio_parameter(adress, value);
+}
+
+void handle_modulation_routes() {
+  for (uint8_t i = 0; i < MODULATION_ROUTES; i++) {
+    uint8_t adress = modulation.sysex_destination(i);
+    if (!is_modulatable(adress)) {
+      adress = 0;
+    }
+    if (adress != route_applied_adress[i]) {
+      uint8_t left_adress = route_applied_adress[i];
+      route_applied_adress[i] = adress;
+      route_applied_value[i] = -1;
+      if (left_adress != 0) {
+        apply_audio_parameter(left_adress, route_base(left_adress)); // the route left it, back to the value it moved around
+      }
+    }
+    if (adress == 0) {
+      continue;
+    }
+    int base = route_base(adress);
+    int value = constrain_modulated(adress, (int)(base * (1.0 + modulation.route_value(i))));
+    if (value != route_applied_value[i] || base != route_applied_base[i]) { // the base can be changed by a potentiometer, a sysex or a preset
+      apply_audio_parameter(adress, value);
+      route_applied_value[i] = value;
+      route_applied_base[i] = base;
+    }
+  }
+}
+
 //-->>TIMER FUNCTIONS
 // function to handle the delayed chord activation
 void play_single_note(int i, IntervalTimer *timer) {
@@ -492,16 +661,6 @@ void turn_off_led(IntervalTimer *timer) {
 }
 
 //-->>AUDIO HELPER FUNCTIONS
-// calculationg the ws array
-void calculate_ws_array() {
-  for (int i = 0; i < 257; i++) {
-    float current_x = (i / 256.0 - 0.5) * 2.0 * PI;
-    wave_shape[i] = sin(current_x);
-    for (int j = 0; j < ws_sin_param; j++) {
-      wave_shape[i] = sin(wave_shape[i] * PI);
-    }
-  }
-}
 // setting the pad_frequency
 void set_chord_voice_frequency(uint8_t i, uint16_t current_note) {
   float note_freq = pow(2,chord_octave_change)*c_frequency/8 * pow(2, (current_note+transpose_semitones) / 12.0); //down one octave to let more possibilities with the shuffling array
@@ -691,65 +850,40 @@ void recalculate_timer() {
 }
 
 //--->>FILE HANDLING UTILITIES
-String serialize(int16_t data_array[], u_int16_t array_size) {
-  String dataString = "0,";
-  dataString += String(current_bank_number); // to save the number of the bank for the online display
-  dataString += ",";
-  for (u_int16_t i = 2; i < array_size; i++) {
-    dataString += String(data_array[i]);
-    dataString += ",";
-  }
-  return dataString;
-}
-
-void deserialize(String input, int16_t data_array[]) {
-  int len = input.length() + 1;
-  char string[len];
-  char *p;
-  input.toCharArray(string, len);
-  p = strtok(string, ",");
-  int i = 0;
-  while (p && i < parameter_size) {
-    data_array[i] = atoi(p);
-    p = strtok(NULL, ",");
-    i++;
-  }
-}
-
 void save_config(int bank_number, bool default_save) {
   if (bank_number < 0 || bank_number >= preset_number) {
     Serial.printf("Error: Invalid bank_number %d in save_config\n", bank_number);
     return;
   }
-  digitalWrite(_MUTE_PIN, LOW); // muting the DAC
   current_bank_number=bank_number; //save to correctly write in the memory 
-  AudioNoInterrupts();
-  // myfs.quickFormat();  // performs a quick format of the created di
-  myfs.remove(bank_name[bank_number]);
-  File dataFile = myfs.open(bank_name[bank_number], FILE_WRITE);
-
   if (default_save) {
     // if we need to put the default in memory
     Serial.println("Writing the default file");
-    Serial.println(bank_name[bank_number]);
-    String return_data = serialize(default_bank_sysex_parameters[bank_number], parameter_size);
-    dataFile.println(return_data);
+    presets.reset(bank_number);
   } else {
     Serial.println("Saving current settings");
-    for (u_int16_t i = 0; i < parameter_size; i++) {
-          Serial.println(current_sysex_parameters[i]);
-    }
-    dataFile.println(serialize(current_sysex_parameters, parameter_size));
+    presets.write(bank_number, current_sysex_parameters);
   }
-  Serial.print("Saved preset: ");
-  Serial.println(dataFile.name());
-  dataFile.close();
-
   load_config(current_bank_number); //we do a full reload to initialise values
-  
-  // add something to set config_bit in the parameters to zero
-  AudioInterrupts();
-  digitalWrite(_MUTE_PIN, HIGH); // unmuting the DAC
+}
+
+// write back the dirty banks one slice at a time, the flash access disables interrupts
+void handle_preset_write_back() {
+  // right after an audio update, so that a flash program is over before the next one
+  if (output_monitor.micros_since_update() > 200 || output_monitor.update_count() == last_save_slice_update) {
+    return;
+  }
+  last_save_slice_update = output_monitor.update_count();
+  bool silent = output_monitor.is_silent();
+#if AUDIO_BLOCK_SAMPLES < 128
+  // with blocks smaller than the default the update period is shorter than the time a flash program is expected to take, and that has not been timed on the device,
+  // so nothing is written while there is sound
+  if (!silent) {
+    return;
+  }
+#endif
+  // erasing a sector blocks the audio for ~45ms, which is only inaudible if the output is silent
+  presets.save_step(silent);
 }
 
 void load_config(int bank_number) {
@@ -767,29 +901,20 @@ void load_config(int bank_number) {
   }
   trigger_chord = true; //to be ready to retrigger if needed
 
-  File entry = myfs.open(bank_name[bank_number]);
-  if (entry) {
-    String data_string = "";
-    while (entry.available()) {
-      data_string += char(entry.read());
-    }
-    deserialize(data_string, current_sysex_parameters);
-    Serial.print("Loaded preset: ");
-    Serial.println(entry.name());
-    entry.close();
-  } else {
-    entry.close();
-    Serial.print("No preset, writing factory default");
-    save_config(bank_number, true); // reboot with default value
-  }
+  presets.read(bank_number, current_sysex_parameters);
+  Serial.print("Loaded preset: ");
+  Serial.println(bank_name[bank_number]);
   // Loading the potentiometer
-  chord_pot.setup(chord_volume_sysex, 100, current_sysex_parameters[chord_pot_alternate_control], current_sysex_parameters[chord_pot_alternate_range], current_sysex_parameters,current_sysex_parameters[chord_pot_alternate_storage],apply_audio_parameter,chord_pot_alternate_storage);
-  harp_pot.setup(harp_volume_sysex, 100, current_sysex_parameters[harp_pot_alternate_control], current_sysex_parameters[harp_pot_alternate_range], current_sysex_parameters,current_sysex_parameters[harp_pot_alternate_storage],apply_audio_parameter,harp_pot_alternate_storage);
-  mod_pot.setup(current_sysex_parameters[mod_pot_main_control], current_sysex_parameters[mod_pot_main_range], current_sysex_parameters[mod_pot_alternate_control], current_sysex_parameters[mod_pot_alternate_range], current_sysex_parameters,current_sysex_parameters[mod_pot_alternate_storage],apply_audio_parameter,mod_pot_alternate_storage);
+  chord_pot.setup(chord_volume_sysex, 100, current_sysex_parameters[chord_pot_alternate_control], current_sysex_parameters[chord_pot_alternate_range], current_sysex_parameters,current_sysex_parameters[chord_pot_alternate_storage],apply_pot_parameter,chord_pot_alternate_storage);
+  harp_pot.setup(harp_volume_sysex, 100, current_sysex_parameters[harp_pot_alternate_control], current_sysex_parameters[harp_pot_alternate_range], current_sysex_parameters,current_sysex_parameters[harp_pot_alternate_storage],apply_pot_parameter,harp_pot_alternate_storage);
+  mod_pot.setup(current_sysex_parameters[mod_pot_main_control], current_sysex_parameters[mod_pot_main_range], current_sysex_parameters[mod_pot_alternate_control], current_sysex_parameters[mod_pot_alternate_range], current_sysex_parameters,current_sysex_parameters[mod_pot_alternate_storage],apply_pot_parameter,mod_pot_alternate_storage);
   Serial.println("pot setup done");
   for (int i = 1; i < parameter_size; i++) {
     apply_audio_parameter(i, current_sysex_parameters[i]);
   }
+  for (int i = 0; i < MODULATION_ROUTES; i++) {
+    route_applied_value[i] = -1; // the routed adresses were just set to their stored value, the routes apply theirs again
+  }
   control_command(0, 0); // tell itself to update the remote controller if present
   chord_pot.force_update();
   harp_pot.force_update();
@@ -798,34 +923,328 @@ void load_config(int bank_number) {
   //digitalWrite(_MUTE_PIN, HIGH); // unmuting the DAC
 }
 
+void report_boot_stage(const char *stage_name) {
+  Serial.printf("Boot stage %s: %lu us\n", stage_name, (unsigned long)boot_stage_timer);
+  boot_stage_timer = 0;
+}
+
+extern unsigned long _heap_end; // from the Teensy 4 linker script, DMAMEM not statically used is left to the heap
+extern char *__brkval;
+
+void report_memory_budget() {
+  Serial.printf("Memory: audio blocks %u bytes, reverb %u bytes, delays %u bytes, presets %u bytes, %u bytes of DMAMEM left\n", (unsigned)(audio_memory_blocks * sizeof(audio_block_t)), (unsigned)sizeof(reverb_memory), (unsigned)(sizeof(string_delay_memory) + sizeof(chord_delay_memory)), (unsigned)sizeof(presets), (unsigned)((char *)&_heap_end - __brkval));
+}
+
+#ifdef AUDIO_POOL_STRESS
+//scripted performance played from the loop, to measure the audio blocks needed by the graph
+//both delays at their longest, then strums, chords, both together, and the release of every tail
+#define STRESS_PHASE_MS 5000
+const char *const stress_phase_names[] = {"strums", "chords", "strums and chords", "release"};
+uint8_t stress_phase = 0;
+elapsedMillis stress_timer;
+elapsedMillis stress_step_timer;
+elapsedMillis stress_report_timer;
+uint8_t stress_string = 0;
+uint16_t stress_overall_peak = 0;
+
+void start_audio_stress() {
+  delay_strings.delay(DELAY_MAX_MS);
+  delay_chords.delay(DELAY_MAX_MS);
+  AudioMemoryUsageMaxReset();
+  audio_pool_probe::reset();
+  stress_timer = 0;
+  Serial.printf("Audio pool stress: %u blocks allocated\n", audio_memory_blocks);
+}
+
+void handle_audio_stress() {
+  if (stress_phase >= 4) {
+    return;
+  }
+  bool strums = stress_phase == 0 || stress_phase == 2;
+  bool chords = stress_phase == 1 || stress_phase == 2;
+  if (strums && stress_step_timer >= 30) {
+    set_harp_voice_frequency(stress_string, current_harp_notes[stress_string]);
+    AudioNoInterrupts();
+    envelope_string_vibrato_lfo.noteOn();
+    envelope_string_vibrato_dc.noteOn();
+    string_enveloppe_filter_array[stress_string]->noteOn();
+    string_enveloppe_array[stress_string]->noteOn();
+    string_transient_envelope_array[stress_string]->noteOn();
+    AudioInterrupts();
+    stress_string = (stress_string + 1) % 12;
+    stress_step_timer = 0;
+  }
+  if (chords && !strums && stress_step_timer >= 200) {
+    for (int i = 0; i < 4; i++) {
+      set_chord_voice_frequency(i, current_applied_chord_notes[i]);
+      chord_vibrato_envelope_array[i]->noteOn();
+      chord_vibrato_dc_envelope_array[i]->noteOn();
+      chord_envelope_array[i]->noteOn();
+      chord_envelope_filter_array[i]->noteOn();
+    }
+    stress_step_timer = 0;
+  }
+  if (stress_report_timer >= 1000) {
+    uint16_t peak = AudioMemoryUsageMax();
+    if (peak > stress_overall_peak) {
+      stress_overall_peak = peak;
+    }
+    Serial.printf("Audio pool %s: %u blocks in use, peak %u over the last second, cpu peak %.1f%%\n", stress_phase_names[stress_phase], AudioMemoryUsage(), peak, AudioProcessorUsageMax());
+    AudioMemoryUsageMaxReset();
+    AudioProcessorUsageMaxReset();
+    stress_report_timer = 0;
+  }
+  if (stress_timer >= STRESS_PHASE_MS) {
+    stress_timer = 0;
+    stress_phase++;
+    if (stress_phase == 2) {
+      // the chords are held through the third phase
+      for (int i = 0; i < 4; i++) {
+        set_chord_voice_frequency(i, current_applied_chord_notes[i]);
+        chord_envelope_array[i]->noteOn();
+        chord_envelope_filter_array[i]->noteOn();
+      }
+    } else if (stress_phase == 3) {
+      AudioNoInterrupts();
+      for (int i = 0; i < 12; i++) {
+        string_enveloppe_array[i]->noteOff();
+        string_transient_envelope_array[i]->noteOff();
+        string_enveloppe_filter_array[i]->noteOff();
+      }
+      for (int i = 0; i < 4; i++) {
+        chord_vibrato_envelope_array[i]->noteOff();
+        chord_vibrato_dc_envelope_array[i]->noteOff();
+        chord_envelope_array[i]->noteOff();
+        chord_envelope_filter_array[i]->noteOff();
+      }
+      AudioInterrupts();
+    } else if (stress_phase == 4) {
+      audio_pool_probe::report(Serial);
+      Serial.printf("Audio pool stress done: peak %u blocks, build with -D AUDIO_MEMORY_FROM_PEAK -D AUDIO_MEMORY_MEASURED_PEAK=%u\n", stress_overall_peak, stress_overall_peak);
+    }
+  }
+}
+#endif
+
+#ifdef AUDIO_LATENCY_BENCHMARK
+//touch to sound latency and audio cpu load, to compare the builds with different AUDIO_BLOCK_SAMPLES
+//strings are triggered from silence with no envelope delay or attack, then strums over held chords load the audio
+//the latency starts when the note is triggered, the scan of the touch before it is not included
+#define LATENCY_TRIALS 24
+#define LATENCY_TIMEOUT_MS 1000
+#define LATENCY_LOAD_MS 5000
+uint8_t latency_trial = 0;
+bool latency_waiting = false;
+uint32_t latency_min = UINT32_MAX;
+uint32_t latency_max = 0;
+uint32_t latency_sum = 0;
+uint8_t latency_count = 0;
+bool load_running = false;
+bool benchmark_done = false;
+float load_usage_sum = 0;
+uint32_t load_usage_count = 0;
+uint8_t load_string = 0;
+elapsedMillis latency_timer;
+elapsedMillis load_step_timer;
+elapsedMillis load_sample_timer;
+
+void start_latency_benchmark() {
+  for (int i = 0; i < 12; i++) {
+    string_enveloppe_array[i]->delay(0);
+    string_enveloppe_array[i]->attack(0);
+  }
+  latency_timer = 0;
+  Serial.printf("Latency benchmark: %u samples per block, %.2f ms per update\n", AUDIO_BLOCK_SAMPLES, AUDIO_BLOCK_SAMPLES * 1000.0f / AUDIO_SAMPLE_RATE_EXACT);
+}
+
+void handle_latency_benchmark() {
+  if (benchmark_done) {
+    return;
+  }
+  if (latency_trial < LATENCY_TRIALS) {
+    uint8_t string = latency_trial % 12;
+    if (latency_waiting) {
+      if (!latency_probe.measured() && latency_timer < LATENCY_TIMEOUT_MS) {
+        return;
+      }
+      if (latency_probe.measured()) {
+        uint32_t latency = latency_probe.latency_micros();
+        latency_min = min(latency_min, latency);
+        latency_max = max(latency_max, latency);
+        latency_sum += latency;
+        latency_count++;
+      }
+      AudioNoInterrupts();
+      string_enveloppe_array[string]->noteOff();
+      string_transient_envelope_array[string]->noteOff();
+      string_enveloppe_filter_array[string]->noteOff();
+      AudioInterrupts();
+      latency_waiting = false;
+      latency_trial++;
+      latency_timer = 0;
+      return;
+    }
+    // each note starts from silence, the loop timing being unrelated to the audio updates
+    if (latency_timer < 100 || !output_monitor.is_silent()) {
+      return;
+    }
+    set_harp_voice_frequency(string, current_harp_notes[string]);
+    AudioNoInterrupts();
+    string_enveloppe_filter_array[string]->noteOn();
+    string_enveloppe_array[string]->noteOn();
+    string_transient_envelope_array[string]->noteOn();
+    latency_probe.arm();
+    AudioInterrupts();
+    latency_waiting = true;
+    latency_timer = 0;
+    return;
+  }
+  if (!load_running) {
+    if (latency_count) {
+      Serial.printf("Latency: %u notes, touch to I2S output min %.2f ms, average %.2f ms, max %.2f ms\n", latency_count, latency_min / 1000.0f, latency_sum / 1000.0f / latency_count, latency_max / 1000.0f);
+      Serial.printf("Latency: plus %.2f ms of I2S buffering to the DAC, assumed from the buffer layout and not measured\n", audio_latency_probe::assumed_output_micros() / 1000.0f);
+    } else {
+      Serial.println("Latency: no note was heard");
+    }
+    for (int i = 0; i < 4; i++) {
+      set_chord_voice_frequency(i, current_applied_chord_notes[i]);
+      chord_envelope_array[i]->noteOn();
+      chord_envelope_filter_array[i]->noteOn();
+    }
+    AudioProcessorUsageMaxReset();
+    load_running = true;
+    latency_timer = 0;
+    return;
+  }
+  if (load_step_timer >= 30) {
+    set_harp_voice_frequency(load_string, current_harp_notes[load_string]);
+    AudioNoInterrupts();
+    string_enveloppe_filter_array[load_string]->noteOn();
+    string_enveloppe_array[load_string]->noteOn();
+    string_transient_envelope_array[load_string]->noteOn();
+    AudioInterrupts();
+    load_string = (load_string + 1) % 12;
+    load_step_timer = 0;
+  }
+  if (load_sample_timer >= 10) {
+    load_usage_sum += AudioProcessorUsage();
+    load_usage_count++;
+    load_sample_timer = 0;
+  }
+  if (latency_timer >= LATENCY_LOAD_MS) {
+    float usage = load_usage_sum / load_usage_count;
+    float update_micros = AUDIO_BLOCK_SAMPLES * 1000000.0f / AUDIO_SAMPLE_RATE_EXACT;
+    Serial.printf("Load: strums over 4 chords, cpu average %.1f%% (%.0f us per update), peak %.1f%% (%.0f us per update)\n", usage, usage * update_micros / 100.0f, AudioProcessorUsageMax(), AudioProcessorUsageMax() * update_micros / 100.0f);
+    Serial.printf("Latency benchmark done: %u samples per block, latency average %.2f ms, cpu average %.1f%%\n", AUDIO_BLOCK_SAMPLES, latency_count ? latency_sum / 1000.0f / latency_count : 0.0f, usage);
+    benchmark_done = true;
+  }
+}
+#endif
+
+#ifdef AUDIO_PRUNING_BENCHMARK
+//cpu load of each factory preset played with the whole graph, then with the silent sections pruned
+//each run strums the strings over held chords, the preset of the current bank is loaded again at the end
+#define PRUNING_RUN_MS 3000
+uint8_t pruning_preset = 0;
+bool pruning_run_pruned = false;
+bool pruning_benchmark_done = false;
+float pruning_usage_sum = 0;
+uint32_t pruning_usage_count = 0;
+float pruning_whole_usage = 0;
+uint8_t pruning_string = 0;
+elapsedMillis pruning_timer;
+elapsedMillis pruning_step_timer;
+elapsedMillis pruning_sample_timer;
+
+void start_pruning_run() {
+  audio_pruning_enabled = pruning_run_pruned;
+  for (int i = 1; i < parameter_size; i++) {
+    current_sysex_parameters[i] = factory_bank_sysex_parameters[pruning_preset][i];
+    apply_audio_parameter(i, current_sysex_parameters[i]);
+  }
+  prune_audio_sections();
+  for (int i = 0; i < 4; i++) {
+    set_chord_voice_frequency(i, current_applied_chord_notes[i]);
+    chord_envelope_array[i]->noteOn();
+    chord_envelope_filter_array[i]->noteOn();
+  }
+  pruning_usage_sum = 0;
+  pruning_usage_count = 0;
+  pruning_timer = 0;
+}
+
+void start_pruning_benchmark() {
+  Serial.printf("Pruning benchmark: %u factory presets, %u ms per run\n", preset_number, PRUNING_RUN_MS);
+  start_pruning_run();
+}
+
+void handle_pruning_benchmark() {
+  if (pruning_benchmark_done) {
+    return;
+  }
+  if (pruning_step_timer >= 30) {
+    set_harp_voice_frequency(pruning_string, current_harp_notes[pruning_string]);
+    AudioNoInterrupts();
+    string_enveloppe_filter_array[pruning_string]->noteOn();
+    string_enveloppe_array[pruning_string]->noteOn();
+    string_transient_envelope_array[pruning_string]->noteOn();
+    AudioInterrupts();
+    pruning_string = (pruning_string + 1) % 12;
+    pruning_step_timer = 0;
+  }
+  if (pruning_sample_timer >= 10) {
+    pruning_usage_sum += AudioProcessorUsage();
+    pruning_usage_count++;
+    pruning_sample_timer = 0;
+  }
+  if (pruning_timer < PRUNING_RUN_MS) {
+    return;
+  }
+  float usage = pruning_usage_sum / pruning_usage_count;
+  if (!pruning_run_pruned) {
+    pruning_whole_usage = usage;
+    pruning_run_pruned = true;
+    start_pruning_run();
+    return;
+  }
+  Serial.printf("Preset %u: cpu whole graph %.1f%%, pruned %.1f%%, saved %.1f%%, pruned sections: ", pruning_preset, pruning_whole_usage, usage, pruning_whole_usage - usage);
+  print_pruned_sections(Serial);
+  Serial.println();
+  pruning_run_pruned = false;
+  pruning_preset++;
+  if (pruning_preset < preset_number) {
+    start_pruning_run();
+    return;
+  }
+  audio_pruning_enabled = true;
+  load_config(current_bank_number);
+  Serial.println("Pruning benchmark done");
+  pruning_benchmark_done = true;
+}
+#endif
+
 void setup() {
   Serial.begin(9600);
+  boot_stage_timer = 0;
   Serial.println("Initialising audio parameters");
-  AudioMemory(1200);
+  AudioMemory(audio_memory_blocks);
+  main_reverb.begin(reverb_memory, sizeof(reverb_memory), MAIN_REVERB_SCALE);
+  output_bus.attach(&main_reverb);
+  delay_strings.begin(string_delay_memory, sizeof(string_delay_memory) / sizeof(int16_t));
+  delay_chords.begin(chord_delay_memory, sizeof(chord_delay_memory) / sizeof(int16_t));
   //>>STATIC AUDIO PARAMETERS
   // the waveshaper
-  calculate_ws_array();
-  chord_waveshape.shape(wave_shape, 257);
-  string_waveshape.shape(wave_shape, 257);
+  chord_waveshape.shape(waveshaper_tables[ws_sin_param]);
+  string_waveshape.shape(waveshaper_tables[ws_sin_param]);
   //the base DC value for strings
   filter_dc.amplitude(1);
   // the delay passthrough
-  string_delay_mix.gain(0, 1);
-  chord_delay_mix.gain(0, 1);
+  delay_strings.mix.gain(0, 1);
+  delay_chords.mix.gain(0, 1);
   // simple mixers
   string_vibrato_mixer.gain(0,0.5);
   string_vibrato_mixer.gain(1,0.5);
   envelope_string_vibrato_dc.sustain(0);
-  for (int i = 0; i < 3; i++) {
-    string_mixer_array[i]->gain(0, 1);
-    string_mixer_array[i]->gain(1, 1);
-    string_mixer_array[i]->gain(2, 1);
-    string_mixer_array[i]->gain(3, 1);
-    transient_mixer_array[i]->gain(0, 1);
-    transient_mixer_array[i]->gain(1, 1);
-    transient_mixer_array[i]->gain(2, 1);
-    transient_mixer_array[i]->gain(3, 1);
-  }
   for (int i = 0; i < 4; i++) {
     chord_voice_mixer_array[i]->gain(0, 1);
     chord_voice_mixer_array[i]->gain(1, 1);
@@ -839,18 +1258,32 @@ void setup() {
     chord_vibrato_mixer_array[i]->gain(1,0.5); 
 
     chord_vibrato_dc_envelope_array[i]->sustain(0); //for the pitch bend no need for sustain
-    transient_full_mix.gain(i, 1);
-    all_string_mix.gain(i, 1);
   }
   for(int i=0;i<12;i++){
     string_transient_envelope_array[i]->sustain(0);//don't need sustain for the transient
   }
+#ifdef SYNTH_FUSED_VOICES
+  harp_strings.transient_gain(0.02);
+#else
+  for (int i = 0; i < 3; i++) {
+    string_mixer_array[i]->gain(0, 1);
+    string_mixer_array[i]->gain(1, 1);
+    string_mixer_array[i]->gain(2, 1);
+    string_mixer_array[i]->gain(3, 1);
+    transient_mixer_array[i]->gain(0, 1);
+    transient_mixer_array[i]->gain(1, 1);
+    transient_mixer_array[i]->gain(2, 1);
+    transient_mixer_array[i]->gain(3, 1);
+    transient_full_mix.gain(i, 1);
+    all_string_mix.gain(i, 1);
+  }
   all_string_mix.gain(3,0.02); //for the transient
+#endif
+  report_boot_stage("audio");
+  report_memory_budget();
 
   // initialising the rest of the hardware
   chord_matrix.setup();
-  harp_sensor.setup();
-  harp_sensor.recalibrate();
   pinMode(BATT_LBO_PIN, INPUT);
   pinMode(DOWN_PGM_PIN, INPUT);
   pinMode(UP_PGM_PIN, INPUT);
@@ -858,6 +1291,7 @@ void setup() {
   if (continuous_chord) {
     analogWrite(RYTHM_LED_PIN, 255);
   }
+  report_boot_stage("buttons");
   // loading the preset
   Serial.println("Initialising filesystem");
   if (!myfs.begin(1024 * 1024)) { // Need to check that size
@@ -866,8 +1300,16 @@ void setup() {
       set_led_color(0, 1.0, 1.0); // turn red light
     }
   }
+  report_boot_stage("filesystem");
   Serial.println("Loading the preset");
+  presets.setup(&myfs, bank_name, factory_bank_sysex_parameters);
+  presets.begin_load(); // only the current bank is decoded now, the others from the loop
   load_config(current_bank_number);
+  report_boot_stage("preset");
+  // the harp is enabled from the loop once its calibration is done
+  harp_sensor.setup();
+  harp_sensor.start_calibration();
+  report_boot_stage("harp setup");
   // initializing the strings
   for (int i = 0; i < 12; i++) {
     current_harp_notes[i] = calculate_note_harp(i, slash_chord, sharp_active);
@@ -882,6 +1324,15 @@ void setup() {
 
   Serial.println("Initialisation complete");
   digitalWrite(_MUTE_PIN, HIGH);
+#ifdef AUDIO_POOL_STRESS
+  start_audio_stress();
+#endif
+#ifdef AUDIO_LATENCY_BENCHMARK
+  start_latency_benchmark();
+#endif
+#ifdef AUDIO_PRUNING_BENCHMARK
+  start_pruning_benchmark();
+#endif
 }
 
 void handle_chords_button() {
@@ -1118,7 +1569,7 @@ void handle_preset_change() {
   if (up_button.read_transition() > 1) {
     Serial.println("Switching to next preset");
     if (!sysex_controler_connected && flag_save_needed) {
-      save_config(current_bank_number, false);
+      presets.write(current_bank_number, current_sysex_parameters); // written back to the flash later
     }
     current_bank_number = (current_bank_number + 1) % 12;
     load_config(current_bank_number);
@@ -1126,7 +1577,7 @@ void handle_preset_change() {
   if (down_button.read_transition() > 1) {
     Serial.println("Switching to last preset");
     if (!sysex_controler_connected && flag_save_needed) {
-      save_config(current_bank_number, false);
+      presets.write(current_bank_number, current_sysex_parameters); // written back to the flash later
     }
     current_bank_number = (current_bank_number - 1);
     if (current_bank_number == -1) {
@@ -1208,6 +1659,9 @@ void loop() {
   flag_save_needed |= harp_pot.update_parameter(alternate);
   flag_save_needed |= mod_pot.update_parameter(alternate);
 
+  // Apply the modulation routed to sysex parameters
+  handle_modulation_routes();
+
   // Handle continuous mode logic
   if (!continuous_chord && !rythm_mode) {
     handle_continuous_mode();
@@ -1229,6 +1683,26 @@ void loop() {
   // Handle chord button transitions
   handle_chords_button();
 
-  // Handle harp functions
-  handle_harp();
+  // Handle harp functions, once the calibration started at boot is done
+  if (harp_sensor.is_ready()) {
+    handle_harp();
+  } else if (harp_sensor.calibration_step()) {
+    Serial.printf("Boot stage harp calibration: ready %lu ms after boot\n", millis());
+  }
+
+  // Decode the other banks after boot
+  presets.load_step();
+
+  // Write back the modified presets
+  handle_preset_write_back();
+
+#ifdef AUDIO_POOL_STRESS
+  handle_audio_stress();
+#endif
+#ifdef AUDIO_LATENCY_BENCHMARK
+  handle_latency_benchmark();
+#endif
+#ifdef AUDIO_PRUNING_BENCHMARK
+  handle_pruning_benchmark();
+#endif
 }
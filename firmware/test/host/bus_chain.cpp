@@ -0,0 +1,229 @@
+// the stereo bus against the objects it replaced: for each section a DC gain times the input in an AudioEffectMultiply, an AudioAmplifier,
+// a DC pan gain times the amplified section for each side, the stereo mixers summing harp, chords and the reverb return,
+// and the reverb mixer summing the amplified sections into the reverb send
+// ramps of the DC gains, amplifier gains at zero, unity and above, and missing input blocks
+// without a reverb the bus must give the blocks of the previous chain sample for sample, and transmit when it did
+// with a reverb the previous chain sent it int16 blocks and mixed its int16 outputs, the bus keeps both in float:
+// its output must stay within REVERB_TOLERANCE of the previous chain fed to an identical reverb, as long as the send does not saturate
+// no block may be left held
+#include "stereo_bus.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define BLOCKS 100000
+#define REVERB_BLOCKS 20000
+#define REVERB_TOLERANCE 4 // LSB, the previous chain truncated each send channel and the return to int16, the reverb carries the first ones to its output
+
+static uint32_t seed = 7;
+
+static uint32_t draw(uint32_t n)
+{
+  seed = seed * 1664525u + 1013904223u;
+  return (seed >> 8) % n;
+}
+
+static int16_t saturate(int32_t value)
+{
+  return value > 32767 ? 32767 : value < -32768 ? -32768 : value;
+}
+
+// the objects of one section, the DC gains are voice_dc which library_equivalence holds to AudioSynthWaveformDc
+struct previous_section {
+  voice_dc gain, left_gain, right_gain;
+  int32_t amplifier = 65536;
+  // AudioEffectMultiply then AudioAmplifier then one AudioEffectMultiply per side, false when the amplifier or the multiply transmits nothing
+  bool update(const int16_t *input, int16_t *amplified, int16_t *left, int16_t *right)
+  {
+    int16_t gains[AUDIO_BLOCK_SAMPLES], left_gains[AUDIO_BLOCK_SAMPLES], right_gains[AUDIO_BLOCK_SAMPLES];
+    gain.process(gains);
+    left_gain.process(left_gains);
+    right_gain.process(right_gains);
+    if (!input || amplifier == 0) {
+      return false;
+    }
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      int16_t multiplied = saturate((input[i] * gains[i]) >> 15);
+      amplified[i] = amplifier == 65536 ? multiplied : saturate(((int64_t)amplifier * multiplied) >> 16);
+      left[i] = saturate((amplified[i] * left_gains[i]) >> 15);
+      right[i] = saturate((amplified[i] * right_gains[i]) >> 15);
+    }
+    return true;
+  }
+};
+
+// one input of an AudioMixer4, the first one present overwrites the sum
+static void mix(int16_t *output, const int16_t *input, int32_t multiplier, bool &any)
+{
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    int32_t scaled = multiplier == 65536 ? input[i] : saturate(((int64_t)multiplier * input[i]) >> 16);
+    output[i] = any ? saturate(output[i] + scaled) : scaled;
+  }
+  any = true;
+}
+
+struct previous_chain {
+  previous_section sections[2];
+  int32_t reverb_gain[2] = {65536, 65536};
+  AudioEffectPlateReverb *reverb = nullptr;
+  // false when the stereo mixers transmit nothing
+  bool update(int16_t (*inputs)[AUDIO_BLOCK_SAMPLES], const bool *present, int16_t *left, int16_t *right)
+  {
+    int16_t amplified[2][AUDIO_BLOCK_SAMPLES], lefts[2][AUDIO_BLOCK_SAMPLES], rights[2][AUDIO_BLOCK_SAMPLES], send[AUDIO_BLOCK_SAMPLES];
+    bool any = false, any_right = false, sent = false;
+    bool added[2];
+    for (int s = 0; s < 2; s++) {
+      added[s] = sections[s].update(present[s] ? inputs[s] : nullptr, amplified[s], lefts[s], rights[s]);
+    }
+    for (int s = 0; s < 2; s++) {
+      if (added[s]) {
+        mix(left, lefts[s], 65536, any);
+        mix(right, rights[s], 65536, any_right);
+        mix(send, amplified[s], reverb_gain[s], sent);
+      }
+    }
+    if (!reverb) {
+      return any;
+    }
+    // the reverb updated between the reverb mixer and the stereo mixers, its outputs crossed over
+    if (sent) {
+      reverb->inputQueue[0] = AudioStream::allocate();
+      memcpy(reverb->inputQueue[0]->data, send, sizeof(send));
+    }
+    reverb->update();
+    if (reverb->out[0]) {
+      mix(left, reverb->out[1]->data, 65536, any);
+      mix(right, reverb->out[0]->data, 65536, any_right);
+    }
+    for (int c = 0; c < 2; c++) {
+      delete reverb->out[c];
+      reverb->out[c] = nullptr;
+    }
+    return any;
+  }
+};
+
+// the same random settings on both sides, reverb sends up to max_send so that the int16 send of the previous chain does not saturate
+static void set(stereo_bus &bus, previous_chain &chain, float max_send)
+{
+  static const float amplifier_gains[] = {0.0f, 1.0f, 0.3f, 1.5f, 2.0f};
+  for (int s = 0; s < 2; s++) {
+    voice_dc *bus_gains[3] = {s ? &bus.chords_gain : &bus.string_gain, s ? &bus.chords_l_stereo_gain : &bus.string_l_stereo_gain,
+                              s ? &bus.chords_r_stereo_gain : &bus.string_r_stereo_gain};
+    voice_dc *chain_gains[3] = {&chain.sections[s].gain, &chain.sections[s].left_gain, &chain.sections[s].right_gain};
+    for (int g = 0; g < 3; g++) {
+      if (draw(40) == 0) {
+        float level = draw(1000) / 999.0f;
+        float milliseconds = draw(3) * 50.0f;
+        bus_gains[g]->amplitude(level, milliseconds);
+        chain_gains[g]->amplitude(level, milliseconds);
+      }
+    }
+    if (draw(50) == 0) {
+      float gain = amplifier_gains[draw(5)];
+      (s ? bus.chords_amplifier : bus.string_amplifier).gain(gain);
+      chain.sections[s].amplifier = gain * 65536.0f;
+    }
+    if (draw(50) == 0) {
+      float gain = draw(5) * max_send / 4;
+      bus.reverb_mixer.gain(s, gain);
+      chain.reverb_gain[s] = gain * 65536.0f;
+    }
+  }
+}
+
+// one update of both, the largest difference of their outputs, -1 when only one of them transmitted
+static int compare(stereo_bus &bus, previous_chain &chain)
+{
+  int16_t inputs[2][AUDIO_BLOCK_SAMPLES];
+  bool present[2];
+  for (int s = 0; s < 2; s++) {
+    present[s] = draw(5) != 0;
+    int shift = draw(2) ? 0 : 3; // loud blocks, and quieter ones that the gains do not saturate
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      inputs[s][i] = (int16_t)(draw(65536) - 32768) >> shift;
+    }
+    if (present[s]) {
+      bus.inputQueue[s] = AudioStream::allocate();
+      memcpy(bus.inputQueue[s]->data, inputs[s], sizeof(inputs[s]));
+    }
+  }
+  int16_t left[AUDIO_BLOCK_SAMPLES], right[AUDIO_BLOCK_SAMPLES];
+  bool any = chain.update(inputs, present, left, right);
+  bus.update();
+  int largest = 0;
+  if (any != (bus.out[0] != nullptr) || any != (bus.out[1] != nullptr)) {
+    largest = -1;
+  } else if (any) {
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      largest = std::max(largest, abs(bus.out[0]->data[i] - left[i]));
+      largest = std::max(largest, abs(bus.out[1]->data[i] - right[i]));
+    }
+  }
+  for (int c = 0; c < 2; c++) {
+    delete bus.out[c];
+    bus.out[c] = nullptr;
+  }
+  return largest;
+}
+
+static void setup(AudioEffectPlateReverb &reverb)
+{
+  reverb.size(0.8f);
+  reverb.hidamp(0.3f);
+  reverb.lodamp(0.1f);
+  reverb.lowpass(0.6f);
+  reverb.diffusion(0.7f);
+}
+
+int main()
+{
+  bool passed = true;
+  {
+    stereo_bus bus;
+    previous_chain chain;
+    long differing = 0, transmitted = 0;
+    for (int b = 0; b < BLOCKS; b++) {
+      set(bus, chain, 1.0f);
+      int largest = compare(bus, chain);
+      transmitted += largest < 0;
+      differing += largest > 0;
+    }
+    printf("bus_chain: no reverb, %d blocks, %ld differ, %ld transmitted by one side only\n", BLOCKS, differing, transmitted);
+    passed &= !differing && !transmitted;
+  }
+  {
+    static AudioEffectPlateReverb bus_reverb, chain_reverb;
+    static float bus_arena[AudioEffectPlateReverb::memory_size() / sizeof(float) + 1];
+    static float chain_arena[AudioEffectPlateReverb::memory_size() / sizeof(float) + 1];
+    bus_reverb.begin(bus_arena, sizeof(bus_arena));
+    chain_reverb.begin(chain_arena, sizeof(chain_arena));
+    setup(bus_reverb);
+    setup(chain_reverb);
+    stereo_bus bus;
+    bus.attach(&bus_reverb);
+    previous_chain chain;
+    chain.reverb = &chain_reverb;
+    long differing = 0, transmitted = 0;
+    int largest = 0;
+    for (int b = 0; b < REVERB_BLOCKS; b++) {
+      set(bus, chain, 0.5f);
+      int difference = compare(bus, chain);
+      transmitted += difference < 0;
+      differing += difference > 0;
+      largest = std::max(largest, difference);
+    }
+    printf("bus_chain: reverb in float, %d blocks, %ld differ, by at most %d, %ld transmitted by one side only\n", REVERB_BLOCKS, differing, largest, transmitted);
+    passed &= largest <= REVERB_TOLERANCE && !transmitted;
+  }
+  if (AudioStream::memory_used) {
+    printf("%d audio blocks leaked\n", AudioStream::memory_used);
+    return 1;
+  }
+  if (!passed) {
+    printf("bus_chain: the stereo bus differs from the previous chain\n");
+    return 1;
+  }
+  printf("bus_chain: the stereo bus is bit identical to the previous chain without reverb, and within %d of it with the reverb in float\n", REVERB_TOLERANCE);
+  return 0;
+}
@@ -0,0 +1,143 @@
+// the feedback delay against a model of the loop it replaced: a mixer, an AudioEffectDelay and a state variable filter
+// the model mixes the input with the three filter outputs, delays the mix by the delay time, and filters the delay output of the previous update
+// its mixer and filter are voice_mixer and voice_filter, which library_equivalence holds to AudioMixer4 and AudioFilterStateVariable
+// the feedback delay must give the output of the model sample for sample, at several delay times, with all the feedback paths on and input blocks missing,
+// then a change of delay time must not step further than the signal itself does between two samples
+#include "feedback_delay.h"
+#include <stdio.h>
+#include <math.h>
+#include <deque>
+
+#define BLOCKS 3000
+#define DELAY_MAX_MS 600
+
+static uint32_t seed = 1;
+
+static int32_t noise()
+{
+  seed = seed * 1664525u + 1013904223u;
+  return (int32_t)seed >> 21; // +-1024
+}
+
+// the previous graph, one update at a time: mixer, delay of the mix, filter of the delay output of the previous update
+struct previous_loop {
+  voice_mixer mixer;
+  voice_filter filter;
+  std::deque<int16_t> delayed; // the samples AudioEffectDelay holds
+  int16_t previous_tap[AUDIO_BLOCK_SAMPLES] = {};
+  previous_loop(float milliseconds) : delayed((uint32_t)(milliseconds * (AUDIO_SAMPLE_RATE_EXACT / 1000.0f) + 0.5f), 0) {}
+  void update(const int16_t *input, int16_t *output)
+  {
+    int16_t low[AUDIO_BLOCK_SAMPLES], band[AUDIO_BLOCK_SAMPLES], high[AUDIO_BLOCK_SAMPLES];
+    filter.process(previous_tap, nullptr, low, band, high);
+    bool first = true;
+    if (input) {
+      mixer.mix_in(0, input, output, true);
+      first = false;
+    }
+    mixer.mix_in(1, low, output, first);
+    mixer.mix_in(2, band, output, false);
+    mixer.mix_in(3, high, output, false);
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      delayed.push_back(output[i]);
+      previous_tap[i] = delayed.front();
+      delayed.pop_front();
+    }
+  }
+};
+
+static void setup(voice_mixer &mixer, voice_filter &filter)
+{
+  filter.frequency(3000);
+  filter.resonance(1.5f);
+  mixer.gain(0, 1);
+  mixer.gain(1, 0.48f);
+  mixer.gain(2, 0.2f);
+  mixer.gain(3, 0.1f);
+}
+
+// bursts of a sine and noise, 4000 samples every second, with some blocks missing as when the section before is silent
+static bool input_block(int block, int16_t *data)
+{
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    long n = (long)block * AUDIO_BLOCK_SAMPLES + i;
+    data[i] = n % 44100 < 4000 ? (int16_t)(8000.0f * sinf(n * 0.05f)) + noise() : 0;
+  }
+  return block % 37 < 30;
+}
+
+// one update of the delay, a copy of its output
+static void run(feedback_delay &delay, const int16_t *input, int16_t *output)
+{
+  if (input) {
+    delay.inputQueue[0] = AudioStream::allocate();
+    memcpy(delay.inputQueue[0]->data, input, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+  }
+  delay.update();
+  memcpy(output, delay.out[0]->data, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+  delete delay.out[0];
+  delay.out[0] = nullptr;
+}
+
+int main()
+{
+  static int16_t memory[feedback_delay::memory_samples(DELAY_MAX_MS)];
+  static const float times[] = {0.0f, 1.0f, 340.0f, DELAY_MAX_MS};
+  bool passed = true;
+  for (float milliseconds : times) {
+    feedback_delay delay;
+    delay.delay(milliseconds);
+    delay.begin(memory, sizeof(memory) / sizeof(memory[0]));
+    setup(delay.mix, delay.filter);
+    previous_loop reference(milliseconds);
+    setup(reference.mixer, reference.filter);
+    long differing = 0;
+    for (int b = 0; b < BLOCKS; b++) {
+      int16_t input[AUDIO_BLOCK_SAMPLES], expected[AUDIO_BLOCK_SAMPLES], output[AUDIO_BLOCK_SAMPLES];
+      bool present = input_block(b, input);
+      reference.update(present ? input : nullptr, expected);
+      run(delay, present ? input : nullptr, output);
+      differing += memcmp(expected, output, sizeof(output)) != 0;
+    }
+    printf("delay_loop: %5.0f ms, %d blocks, %ld differ from the previous loop\n", milliseconds, BLOCKS, differing);
+    passed &= differing == 0;
+  }
+
+  // a steady sine through delay changes, one to a time longer than the ring holds
+  feedback_delay delay;
+  delay.delay(340);
+  delay.begin(memory, sizeof(memory) / sizeof(memory[0]));
+  setup(delay.mix, delay.filter);
+  int steady_step = 0, change_step = 0;
+  int16_t last = 0;
+  for (int b = 0; b < 2000; b++) {
+    if (b == 1000) delay.delay(120);
+    if (b == 1003) delay.delay(590);
+    if (b == 1500) delay.delay(5000);
+    int16_t input[AUDIO_BLOCK_SAMPLES], output[AUDIO_BLOCK_SAMPLES];
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      input[i] = (int16_t)(6000.0f * sinf((b * AUDIO_BLOCK_SAMPLES + i) * 0.02f));
+    }
+    run(delay, input, output);
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      int step = abs(output[i] - last);
+      last = output[i];
+      if (b > 10) {
+        int &largest = b < 1000 ? steady_step : change_step;
+        largest = std::max(largest, step);
+      }
+    }
+  }
+  printf("delay_loop: largest step between two samples %d steady, %d through the delay changes\n", steady_step, change_step);
+  passed &= change_step <= steady_step;
+  if (AudioStream::memory_used) {
+    printf("%d audio blocks leaked\n", AudioStream::memory_used);
+    return 1;
+  }
+  if (!passed) {
+    printf("delay_loop: the feedback delay differs from the previous loop\n");
+    return 1;
+  }
+  printf("delay_loop: the feedback delay is bit identical to the previous loop and changes time without steps\n");
+  return 0;
+}
@@ -0,0 +1,314 @@
+// the envelope bank against the envelope it replaced, one voice_envelope object per envelope as voice_components had it before the banks
+// the previous envelope is kept below as it was, under another name
+// 16 channels of a bank and 16 previous envelopes get the same settings and note events, and blocks with audio or without, as the voices give them
+// a block without audio is given to the bank as process() with no input for some channels and as an advance() of a mask for the others
+// the shaped blocks, the blocks transmitted and the states must be the same
+#include "voice_components.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BLOCKS 40000
+
+#define ENVELOPE_IDLE 0
+#define ENVELOPE_DELAY 1
+#define ENVELOPE_ATTACK 2
+#define ENVELOPE_HOLD 3
+#define ENVELOPE_DECAY 4
+#define ENVELOPE_SUSTAIN 5
+#define ENVELOPE_RELEASE 6
+#define ENVELOPE_FORCED 7
+#define ENVELOPE_UNITY 0x40000000
+#define SAMPLES_PER_MSEC (AUDIO_SAMPLE_RATE_EXACT/1000.0f)
+
+class previous_envelope{
+  public:
+  previous_envelope();
+  void noteOn();
+  void noteOff();
+  void delay(float milliseconds);
+  void attack(float milliseconds);
+  void hold(float milliseconds);
+  void decay(float milliseconds);
+  void sustain(float level);
+  void release(float milliseconds);
+  void releaseNoteOn(float milliseconds);
+  bool isActive();
+  bool isSustain();
+  bool process(const int16_t *input, int16_t *output);
+  private:
+  uint16_t milliseconds2count(float milliseconds);
+  void start_attack();
+  uint8_t state;
+  uint16_t count;
+  int32_t mult_hires;
+  int32_t inc_hires;
+  uint16_t delay_count;
+  uint16_t attack_count;
+  uint16_t hold_count;
+  uint16_t decay_count;
+  int32_t sustain_mult;
+  uint16_t release_count;
+  uint16_t release_forced_count;
+};
+
+previous_envelope::previous_envelope(){
+  state = ENVELOPE_IDLE;
+  count = 0;
+  mult_hires = 0;
+  inc_hires = 0;
+  delay(0.0f);
+  attack(10.5f);
+  hold(2.5f);
+  decay(35.0f);
+  sustain(0.5f);
+  release(300.0f);
+  releaseNoteOn(5.0f);
+}
+
+uint16_t previous_envelope::milliseconds2count(float milliseconds){
+  if(milliseconds < 0.0f){
+    milliseconds = 0.0f;
+  }
+  uint32_t c = ((uint32_t)(milliseconds * SAMPLES_PER_MSEC) + 7) >> 3;
+  if(c > 65535){
+    c = 65535;
+  }
+  return c;
+}
+
+void previous_envelope::delay(float milliseconds){
+  delay_count = milliseconds2count(milliseconds);
+}
+
+void previous_envelope::attack(float milliseconds){
+  attack_count = milliseconds2count(milliseconds);
+  if(attack_count == 0){
+    attack_count = 1;
+  }
+}
+
+void previous_envelope::hold(float milliseconds){
+  hold_count = milliseconds2count(milliseconds);
+}
+
+void previous_envelope::decay(float milliseconds){
+  decay_count = milliseconds2count(milliseconds);
+  if(decay_count == 0){
+    decay_count = 1;
+  }
+}
+
+void previous_envelope::sustain(float level){
+  if(level < 0.0f){
+    level = 0.0f;
+  }else if(level > 1.0f){
+    level = 1.0f;
+  }
+  sustain_mult = level * 1073741824.0f;
+}
+
+void previous_envelope::release(float milliseconds){
+  release_count = milliseconds2count(milliseconds);
+  if(release_count == 0){
+    release_count = 1;
+  }
+}
+
+void previous_envelope::releaseNoteOn(float milliseconds){
+  release_forced_count = milliseconds2count(milliseconds);
+}
+
+void previous_envelope::start_attack(){
+  mult_hires = 0;
+  count = delay_count;
+  if(count > 0){
+    state = ENVELOPE_DELAY;
+    inc_hires = 0;
+  }else{
+    state = ENVELOPE_ATTACK;
+    count = attack_count;
+    inc_hires = ENVELOPE_UNITY / (int32_t)count;
+  }
+}
+
+void previous_envelope::noteOn(){
+  __disable_irq();
+  if(state == ENVELOPE_IDLE || state == ENVELOPE_DELAY || release_forced_count == 0){
+    start_attack();
+  }else if(state != ENVELOPE_FORCED){
+    //quick fade out of the sound still playing before the attack
+    state = ENVELOPE_FORCED;
+    count = release_forced_count;
+    inc_hires = (-mult_hires) / (int32_t)count;
+  }
+  __enable_irq();
+}
+
+void previous_envelope::noteOff(){
+  __disable_irq();
+  if(state != ENVELOPE_IDLE && state != ENVELOPE_FORCED){
+    state = ENVELOPE_RELEASE;
+    count = release_count;
+    inc_hires = (-mult_hires) / (int32_t)count;
+  }
+  __enable_irq();
+}
+
+bool previous_envelope::isActive(){
+  return *(volatile uint8_t *)&state != ENVELOPE_IDLE;
+}
+
+bool previous_envelope::isSustain(){
+  return *(volatile uint8_t *)&state == ENVELOPE_SUSTAIN;
+}
+
+bool previous_envelope::process(const int16_t *input, int16_t *output){
+  if(state == ENVELOPE_IDLE){
+    return false;
+  }
+  for(int i = 0; i < AUDIO_BLOCK_SAMPLES;){
+    //the state only matters when completing a region
+    if(count == 0){
+      if(state == ENVELOPE_ATTACK){
+        count = hold_count;
+        if(count > 0){
+          state = ENVELOPE_HOLD;
+          mult_hires = ENVELOPE_UNITY;
+          inc_hires = 0;
+        }else{
+          state = ENVELOPE_DECAY;
+          count = decay_count;
+          inc_hires = (sustain_mult - ENVELOPE_UNITY) / (int32_t)count;
+        }
+        continue;
+      }else if(state == ENVELOPE_HOLD){
+        state = ENVELOPE_DECAY;
+        count = decay_count;
+        inc_hires = (sustain_mult - ENVELOPE_UNITY) / (int32_t)count;
+        continue;
+      }else if(state == ENVELOPE_DECAY){
+        state = ENVELOPE_SUSTAIN;
+        count = 0xFFFF;
+        mult_hires = sustain_mult;
+        inc_hires = 0;
+      }else if(state == ENVELOPE_SUSTAIN){
+        count = 0xFFFF;
+      }else if(state == ENVELOPE_RELEASE){
+        state = ENVELOPE_IDLE;
+        if(input){
+          memset(output + i, 0, (AUDIO_BLOCK_SAMPLES - i) * sizeof(int16_t));
+        }
+        break;
+      }else if(state == ENVELOPE_FORCED){
+        start_attack();
+      }else if(state == ENVELOPE_DELAY){
+        state = ENVELOPE_ATTACK;
+        count = attack_count;
+        inc_hires = ENVELOPE_UNITY / (int32_t)count;
+        continue;
+      }
+    }
+    if(input){
+      //8 samples at 16 bit resolution, the long term gain is kept at 30 bit
+      int32_t mult = mult_hires >> 14;
+      int32_t inc = inc_hires >> 17;
+      for(int j = i; j < i + 8; j++){
+        mult += inc;
+        output[j] = (mult * input[j]) >> 16;
+      }
+    }
+    mult_hires += inc_hires;
+    count--;
+    i += 8;
+  }
+  return true;
+}
+
+static uint32_t seed = 1;
+
+static uint32_t draw(uint32_t n)
+{
+  seed = seed * 1664525u + 1013904223u;
+  return (seed >> 8) % n;
+}
+
+// milliseconds from 0 to limit, 0 one time in four
+static float duration(uint32_t limit)
+{
+  return draw(4) ? draw(limit * 10) / 10.0f : 0.0f;
+}
+
+template <class Envelope>
+static void set_envelope(Envelope &envelope, const float *settings)
+{
+  envelope.delay(settings[0]);
+  envelope.attack(settings[1]);
+  envelope.hold(settings[2]);
+  envelope.decay(settings[3]);
+  envelope.sustain(settings[4]);
+  envelope.release(settings[5]);
+  envelope.releaseNoteOn(settings[6]);
+}
+
+int main()
+{
+  static previous_envelope previous[ENVELOPE_BANK_CHANNELS];
+  voice_envelope_bank bank;
+  voice_envelope channels[ENVELOPE_BANK_CHANNELS];
+  for (int c = 0; c < ENVELOPE_BANK_CHANNELS; c++) {
+    channels[c].attach(&bank, c);
+  }
+  long shaped = 0, differing = 0, transmitted = 0, states = 0, advanced = 0;
+  for (int b = 0; b < BLOCKS; b++) {
+    uint16_t advance_mask = 0;
+    for (int c = 0; c < ENVELOPE_BANK_CHANNELS; c++) {
+      if (draw(200) == 0) {
+        float settings[7] = {draw(3) ? 0.0f : duration(30), duration(80), duration(20), duration(200), draw(1001) / 1000.0f, duration(300), duration(10)};
+        set_envelope(previous[c], settings);
+        set_envelope(channels[c], settings);
+      }
+      uint32_t event = draw(60);
+      if (event == 0) {
+        previous[c].noteOn();
+        channels[c].noteOn();
+      } else if (event == 1) {
+        previous[c].noteOff();
+        channels[c].noteOff();
+      }
+      uint32_t kind = draw(4); // 0 and 1 audio, 2 no input, 3 advanced with the mask
+      if (kind < 2) {
+        int16_t input[AUDIO_BLOCK_SAMPLES], expected[AUDIO_BLOCK_SAMPLES], output[AUDIO_BLOCK_SAMPLES];
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+          input[i] = draw(65536) - 32768;
+        }
+        bool expected_transmitted = previous[c].process(input, expected);
+        bool output_transmitted = channels[c].process(input, output);
+        transmitted += expected_transmitted != output_transmitted;
+        if (expected_transmitted && output_transmitted) {
+          shaped++;
+          differing += memcmp(expected, output, sizeof(output)) != 0;
+        }
+      } else {
+        bool expected_active = previous[c].process(nullptr, nullptr);
+        if (kind == 2) {
+          transmitted += channels[c].process(nullptr, nullptr) != expected_active;
+        } else {
+          advance_mask |= channels[c].mask();
+          advanced++;
+        }
+      }
+    }
+    bank.advance(advance_mask);
+    for (int c = 0; c < ENVELOPE_BANK_CHANNELS; c++) {
+      states += previous[c].isActive() != channels[c].isActive() || previous[c].isSustain() != channels[c].isSustain();
+    }
+  }
+  printf("envelope_bank: %d channels, %d blocks, %ld shaped, %ld differ, %ld transmitted by one side only, %ld advanced by mask, %ld states differ\n",
+         ENVELOPE_BANK_CHANNELS, BLOCKS, shaped, differing, transmitted, advanced, states);
+  if (differing || transmitted || states) {
+    printf("envelope_bank: the bank differs from the previous envelopes\n");
+    return 1;
+  }
+  printf("envelope_bank: the bank is bit identical to the previous envelopes\n");
+  return 0;
+}
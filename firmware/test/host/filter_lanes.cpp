@@ -0,0 +1,84 @@
+// runs the 12 harp string filters as 12 separate process() calls and as process_lanes() in groups of FILTER_LANES
+// each filter has its own corner, resonance and octave control, every other one is modulated as by its filter envelope
+// the two must give the same blocks bit for bit, the time of both is reported per block of the 12 filters
+#include "voice_components.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#define FILTERS 12
+#define BLOCKS 20000
+
+static uint32_t seed = 1;
+
+static int16_t noise()
+{
+  seed = seed * 1664525u + 1013904223u;
+  return (int16_t)(seed >> 17) - 8192;
+}
+
+static double median(std::vector<double> &times)
+{
+  std::sort(times.begin(), times.end());
+  return times[times.size() / 2];
+}
+
+int main()
+{
+  static voice_filter separate[FILTERS], lanes[FILTERS];
+  for (int f = 0; f < FILTERS; f++) {
+    for (voice_filter *filter : {&separate[f], &lanes[f]}) {
+      filter->frequency(200.0f * powf(1.3f, f));
+      filter->resonance(0.7f + 0.25f * (f % 5));
+      filter->octaveControl(1.0f + 0.5f * (f % 4));
+    }
+  }
+  static int16_t inputs[FILTERS][AUDIO_BLOCK_SAMPLES], controls[FILTERS][AUDIO_BLOCK_SAMPLES];
+  static int16_t separate_out[FILTERS][AUDIO_BLOCK_SAMPLES], lanes_out[FILTERS][AUDIO_BLOCK_SAMPLES];
+  std::vector<double> separate_times, lanes_times;
+  long differences = 0;
+  for (int b = 0; b < BLOCKS; b++) {
+    for (int f = 0; f < FILTERS; f++) {
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        int n = b * AUDIO_BLOCK_SAMPLES + i;
+        inputs[f][i] = (int16_t)(12000.0f * sinf(n * 0.013f * (f + 1))) + noise();
+        controls[f][i] = (int16_t)(32767.0f * expf(-(n % 22050) / (2000.0f + 500.0f * f)));
+      }
+    }
+    const int16_t *control_blocks[FILTERS];
+    for (int f = 0; f < FILTERS; f++) control_blocks[f] = f % 2 ? controls[f] : nullptr;
+
+    voice_filter *lane_filters[FILTERS];
+    int16_t *lane_blocks[FILTERS];
+    for (int f = 0; f < FILTERS; f++) {
+      lane_filters[f] = &lanes[f];
+      lane_blocks[f] = lanes_out[f];
+    }
+    memcpy(lanes_out, inputs, sizeof(inputs));
+    // the one run second finds the inputs in the cache, so the order changes every block
+    for (int run = 0; run < 2; run++) {
+      auto start = std::chrono::steady_clock::now();
+      if ((run + b) % 2) {
+        for (int f = 0; f < FILTERS; f += FILTER_LANES) {
+          voice_filter::process_lanes(lane_filters + f, lane_blocks + f, control_blocks + f, FILTER_LANES);
+        }
+      } else {
+        for (int f = 0; f < FILTERS; f++) separate[f].process(inputs[f], control_blocks[f], separate_out[f]);
+      }
+      double microseconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6;
+      ((run + b) % 2 ? lanes_times : separate_times).push_back(microseconds);
+    }
+
+    if (memcmp(separate_out, lanes_out, sizeof(lanes_out))) differences++;
+  }
+  printf("%d filters, %d blocks: separate %.2f us per block, lanes %.2f us per block (medians)\n", FILTERS, BLOCKS, median(separate_times), median(lanes_times));
+  if (differences) {
+    printf("%ld blocks differ between the separate filters and the lanes\n", differences);
+    return 1;
+  }
+  printf("filter_lanes: the lanes are bit identical to the separate filters\n");
+  return 0;
+}
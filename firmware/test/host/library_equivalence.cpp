@@ -0,0 +1,799 @@
+// the fused voice components, ChordVoice, HarpStringBank and the wide mixer against the Teensy audio library objects they replace
+// built by the library_equivalence target with the library sources of TEENSY_AUDIO, both sides get the same settings, note events and input blocks
+// a component must give the blocks of its library object sample for sample, and transmit when it does, apart from these departures, measured instead:
+//   the band limited waveforms, drawn with polynomial steps rather than the step table of the library, must keep their level
+//   the noise of the chord voices after the first one, read from the generator shared by the voices, must keep its level and stay uncorrelated
+//   the timed DC transitions are kept within +-0.45 of full scale, the fused DC computes its step in 64 bits where the library wraps around in 32
+// the voices are compared on notes played from rest, each on new objects, without noise, and must be identical too
+// a voice which went idle does not run its filter and advances its phases without the modulation, so later notes start from another state
+// the harp transients are scaled one by one before being summed, where the library scales their sum, which may round by a LSB per transient
+// the library saturates that sum at full scale before scaling it, the fused bank does not
+// the strings are saturated as they are added one by one to the mix, the library saturates the sums of its mixers
+// so the strings and transients are kept quiet enough not to saturate, where both departures would show
+#include "Audio.h"
+#include "effect_envelope.h"
+#include "synth_waveform.h"
+#include "synth_dc.h"
+#include "synth_whitenoise.h"
+#include "mixer.h"
+#include "filter_variable.h"
+#include "effect_multiply.h"
+#include "chord_voice.h"
+#include "harp_string_bank.h"
+#include "wide_mixer.h"
+#include <stdio.h>
+#include <math.h>
+#include <memory>
+#include <initializer_list>
+
+#define CHORD_TRIALS 24
+#define HARP_TRIALS 12
+#define BAND_LIMITED_LEVEL_DB 0.5 // largest level difference of the band limited waveforms
+#define NOISE_LEVEL_DB 0.1 // largest level difference of the shared noise
+#define NOISE_CORRELATION 0.05 // largest correlation between the noises of two voices
+
+static uint32_t seed = 1;
+
+static uint32_t draw()
+{
+  seed = seed * 1664525u + 1013904223u;
+  return seed;
+}
+
+static float uniform(float low, float high)
+{
+  return low + (high - low) * (draw() >> 8) * (1.0f / 16777216.0f);
+}
+
+static int pick(int n)
+{
+  return (draw() >> 8) % n;
+}
+
+// a block of random samples, or of a sine when frequency is not 0
+static void fill(int16_t *block, float level, float frequency = 0.0f, int n = 0)
+{
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    float s = frequency ? sinf(6.2831853f * frequency * (n + i) / AUDIO_SAMPLE_RATE_EXACT) : uniform(-1.0f, 1.0f);
+    block[i] = (int16_t)(s * level * 32767.0f);
+  }
+}
+
+static const int16_t *output(AudioStream &object, int index = 0)
+{
+  return object.out[index] ? object.out[index]->data : nullptr;
+}
+
+// one update of a library object, given copies of the blocks of its inputs as its connections would, nullptr for an input which got nothing
+// returns its output 0, nullptr when it transmitted nothing, the outputs are kept until its next update
+static const int16_t *run(AudioStream &object, std::initializer_list<const int16_t *> inputs = {})
+{
+  int i = 0;
+  for (const int16_t *input : inputs) {
+    audio_block_t *block = nullptr;
+    if (input) {
+      block = AudioStream::allocate();
+      memcpy(block->data, input, sizeof(block->data));
+    }
+    object.inputQueue[i++] = block;
+  }
+  for (audio_block_t *&block : object.out) {
+    delete block;
+    block = nullptr;
+  }
+  object.update();
+  for (i = 0; i < object.num_inputs; i++) {
+    AudioStream::release(object.inputQueue[i]);
+    object.inputQueue[i] = nullptr;
+  }
+  return output(object);
+}
+
+// blocks of a library object against those of its fused version, a missing block counting as silence
+struct comparison {
+  const char *name;
+  long blocks = 0;
+  long differing = 0; // blocks with a different sample
+  long presence = 0; // blocks transmitted by one side only
+  int largest = 0; // largest difference of a sample
+  double library_energy = 0.0, fused_energy = 0.0, error_energy = 0.0;
+  comparison(const char *name) : name(name) {}
+  void add(const int16_t *library, const int16_t *fused)
+  {
+    blocks++;
+    presence += (library != nullptr) != (fused != nullptr);
+    bool differ = false;
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      int l = library ? library[i] : 0, f = fused ? fused[i] : 0;
+      int d = abs(l - f);
+      differ |= d != 0;
+      largest = std::max(largest, d);
+      library_energy += (double)l * l;
+      fused_energy += (double)f * f;
+      error_energy += (double)d * d;
+    }
+    differing += differ;
+  }
+  double snr() const { return error_energy ? 10.0 * log10(library_energy / error_energy) : INFINITY; }
+  double level_db() const { return 10.0 * log10(fused_energy / library_energy); }
+  bool identical() const { return !differing && !presence; }
+  // prints the result against the check made, returns it
+  bool report(bool passed) const
+  {
+    printf("library_equivalence: %-36s %6ld blocks, %5ld differ, %4ld transmitted by one side only, largest difference %5d, snr %6.1f dB, level %+.2f dB: %s\n",
+           name, blocks, differing, presence, largest, snr(), library_energy ? level_db() : 0.0, passed ? "ok" : "FAILED");
+    return passed;
+  }
+};
+
+static void random_envelope(float settings[7])
+{
+  settings[0] = pick(3) ? 0.0f : uniform(0.0f, 20.0f); // delay
+  settings[1] = uniform(0.0f, 60.0f); // attack
+  settings[2] = pick(2) ? 0.0f : uniform(0.0f, 20.0f); // hold
+  settings[3] = uniform(0.0f, 100.0f); // decay
+  settings[4] = uniform(0.0f, 1.0f); // sustain
+  settings[5] = uniform(0.0f, 200.0f); // release
+  settings[6] = pick(3) ? uniform(0.0f, 10.0f) : 0.0f; // releaseNoteOn
+}
+
+template <class Envelope>
+static void set_envelope(Envelope &envelope, const float settings[7])
+{
+  envelope.delay(settings[0]);
+  envelope.attack(settings[1]);
+  envelope.hold(settings[2]);
+  envelope.decay(settings[3]);
+  envelope.sustain(settings[4]);
+  envelope.release(settings[5]);
+  envelope.releaseNoteOn(settings[6]);
+}
+
+// the channels of a bank against as many AudioEffectEnvelope, with notes at random and blocks sometimes missing
+static bool check_envelopes()
+{
+  comparison result("envelope bank");
+  static AudioEffectEnvelope library[ENVELOPE_BANK_CHANNELS];
+  voice_envelope_bank bank;
+  voice_envelope fused[ENVELOPE_BANK_CHANNELS];
+  long state_mismatches = 0;
+  for (int c = 0; c < ENVELOPE_BANK_CHANNELS; c++) {
+    fused[c].attach(&bank, c);
+  }
+  for (int b = 0; b < 6000; b++) {
+    for (int c = 0; c < ENVELOPE_BANK_CHANNELS; c++) {
+      if (pick(60) == 0) {
+        float settings[7];
+        random_envelope(settings);
+        set_envelope(library[c], settings);
+        set_envelope(fused[c], settings);
+      }
+      int event = pick(30);
+      if (event == 0) {
+        library[c].noteOn();
+        fused[c].noteOn();
+      } else if (event == 1) {
+        library[c].noteOff();
+        fused[c].noteOff();
+      }
+      int16_t input[AUDIO_BLOCK_SAMPLES], shaped[AUDIO_BLOCK_SAMPLES];
+      fill(input, uniform(0.1f, 1.0f));
+      bool present = pick(8) != 0; // without input the library envelope does not run, the fused one is not called
+      const int16_t *expected = run(library[c], {present ? input : nullptr});
+      bool transmitted = present && fused[c].process(input, shaped);
+      result.add(expected, transmitted ? shaped : nullptr);
+      state_mismatches += library[c].isActive() != fused[c].isActive() || library[c].isSustain() != fused[c].isSustain();
+    }
+  }
+  if (state_mismatches) {
+    printf("library_equivalence: the envelope bank reports another state than the library %ld times\n", state_mismatches);
+  }
+  return result.report(result.identical() && !state_mismatches);
+}
+
+// a modulated oscillator of each waveform against an AudioSynthWaveformModulated, with and without a modulation block
+static bool check_oscillators()
+{
+  static const short exact[] = {WAVEFORM_SINE, WAVEFORM_SAWTOOTH, WAVEFORM_SQUARE, WAVEFORM_TRIANGLE, WAVEFORM_PULSE, WAVEFORM_SAWTOOTH_REVERSE, WAVEFORM_SAMPLE_HOLD, WAVEFORM_TRIANGLE_VARIABLE};
+  static const short band_limited[] = {WAVEFORM_BANDLIMIT_SAWTOOTH, WAVEFORM_BANDLIMIT_SAWTOOTH_REVERSE, WAVEFORM_BANDLIMIT_SQUARE, WAVEFORM_BANDLIMIT_PULSE};
+  comparison exact_result("modulated oscillator"), band_limited_result("modulated oscillator, band limited");
+  for (int set = 0; set < 2; set++) {
+    const short *types = set ? band_limited : exact;
+    int count = set ? 4 : 8;
+    comparison &result = set ? band_limited_result : exact_result;
+    for (int t = 0; t < count; t++) {
+      auto library = std::make_unique<AudioSynthWaveformModulated>();
+      voice_oscillator fused;
+      library->begin(types[t]);
+      fused.begin(types[t]);
+      for (int b = 0; b < 800; b++) {
+        if (b % 100 == 0) {
+          float frequency = uniform(30.0f, 4000.0f), level = b % 300 ? uniform(0.1f, 1.0f) : 0.0f, octaves = uniform(0.5f, 4.0f);
+          library->frequency(frequency);
+          fused.frequency(frequency);
+          library->amplitude(level);
+          fused.amplitude(level);
+          library->frequencyModulation(octaves);
+          fused.frequencyModulation(octaves);
+        }
+        int16_t modulation[AUDIO_BLOCK_SAMPLES], drawn[AUDIO_BLOCK_SAMPLES];
+        fill(modulation, uniform(0.0f, 0.3f), 5.0f, b * AUDIO_BLOCK_SAMPLES);
+        int16_t offset = pick(65536) - 32768;
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+          modulation[i] = std::max(-32768, std::min(32767, modulation[i] / 2 + offset / 4));
+        }
+        bool modulated = pick(4) != 0;
+        uint32_t scale[AUDIO_BLOCK_SAMPLES];
+        if (modulated) {
+          voice_oscillator::modulation_scale(modulation, fused.modulation_factor(), scale);
+        }
+        // the sample and hold draws from random(), both sides get the same sequence
+        srand(b);
+        const int16_t *expected = run(*library, {modulated ? modulation : nullptr});
+        srand(b);
+        bool drawn_block = fused.process(modulated ? scale : nullptr, drawn);
+        result.add(expected, drawn_block ? drawn : nullptr);
+      }
+    }
+  }
+  bool passed = exact_result.report(exact_result.identical());
+  return band_limited_result.report(!band_limited_result.presence && fabs(band_limited_result.level_db()) <= BAND_LIMITED_LEVEL_DB) && passed;
+}
+
+// the harp transients, oscillators without modulation, against AudioSynthWaveform
+// the pulse and variable triangle are left out, AudioSynthWaveform draws them with a pulse width the fused oscillator does not have
+static bool check_transients()
+{
+  static const short types[] = {WAVEFORM_SINE, WAVEFORM_SAWTOOTH, WAVEFORM_SQUARE, WAVEFORM_TRIANGLE, WAVEFORM_SAWTOOTH_REVERSE, WAVEFORM_SAMPLE_HOLD};
+  comparison result("transient oscillator");
+  for (short type : types) {
+    auto library = std::make_unique<AudioSynthWaveform>();
+    voice_oscillator fused;
+    float frequency = uniform(50.0f, 8000.0f), level = uniform(0.1f, 1.0f);
+    library->begin(level, frequency, type);
+    fused.begin(level, frequency, type);
+    for (int b = 0; b < 400; b++) {
+      if (b % 50 == 0) {
+        frequency = uniform(50.0f, 8000.0f);
+        library->frequency(frequency);
+        fused.frequency(frequency);
+      }
+      int16_t drawn[AUDIO_BLOCK_SAMPLES];
+      srand(b);
+      const int16_t *expected = run(*library);
+      srand(b);
+      bool drawn_block = fused.process(nullptr, drawn);
+      result.add(expected, drawn_block ? drawn : nullptr);
+    }
+  }
+  return result.report(result.identical());
+}
+
+// steps and timed transitions, sometimes advanced without drawing as by an idle voice
+static bool check_dc()
+{
+  comparison result("dc");
+  AudioSynthWaveformDc library;
+  voice_dc fused;
+  for (int b = 0; b < 6000; b++) {
+    if (pick(20) == 0) {
+      float level = uniform(-0.45f, 0.45f);
+      if (pick(3) == 0) {
+        library.amplitude(level);
+        fused.amplitude(level);
+      } else {
+        float milliseconds = uniform(0.0f, 60.0f);
+        library.amplitude(level, milliseconds);
+        fused.amplitude(level, milliseconds);
+      }
+    }
+    const int16_t *expected = run(library);
+    if (pick(4) == 0) {
+      fused.advance();
+      continue;
+    }
+    int16_t drawn[AUDIO_BLOCK_SAMPLES];
+    fused.process(drawn);
+    result.add(expected, drawn);
+  }
+  return result.report(result.identical());
+}
+
+// the first noise must be the first AudioSynthNoiseWhite, the next ones read the same shared block and keep the level of theirs
+// the library noises are made before any other so that they get the seeds of the first ones, as do the fused noises
+static bool check_noise(AudioSynthNoiseWhite *library, voice_noise *fused)
+{
+  comparison first("noise of the first voice");
+  comparison others("noise of the other voices");
+  double correlation[4] = {0.0}, energy[4] = {0.0};
+  for (int v = 0; v < 4; v++) {
+    library[v].amplitude(0.5f);
+    fused[v].amplitude(0.5f);
+  }
+  for (int b = 0; b < 4000; b++) {
+    int16_t drawn[4][AUDIO_BLOCK_SAMPLES];
+    for (int v = 0; v < 4; v++) {
+      const int16_t *expected = run(library[v]);
+      fused[v].process(drawn[v]);
+      (v ? others : first).add(expected, drawn[v]);
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        correlation[v] += (double)drawn[0][i] * drawn[v][i];
+        energy[v] += (double)drawn[v][i] * drawn[v][i];
+      }
+    }
+  }
+  double largest_correlation = 0.0;
+  for (int v = 1; v < 4; v++) {
+    largest_correlation = std::max(largest_correlation, fabs(correlation[v]) / sqrt(energy[0] * energy[v]));
+  }
+  printf("library_equivalence: largest correlation between the noise of two voices %.4f\n", largest_correlation);
+  bool passed = first.report(first.identical());
+  return others.report(!others.presence && fabs(others.level_db()) <= NOISE_LEVEL_DB && largest_correlation <= NOISE_CORRELATION) && passed;
+}
+
+// unity, zero, fractional, negative and large gains, with inputs missing at random and loud enough to saturate
+static bool check_mixer()
+{
+  static const float gains[] = {1.0f, 0.0f, 0.5f, 0.02f, -0.75f, 2.5f};
+  comparison result("mixer");
+  AudioMixer4 library;
+  voice_mixer fused;
+  for (int b = 0; b < 20000; b++) {
+    if (pick(10) == 0) {
+      for (int c = 0; c < 4; c++) {
+        float gain = pick(2) ? gains[pick(6)] : uniform(-3.0f, 3.0f);
+        library.gain(c, gain);
+        fused.gain(c, gain);
+      }
+    }
+    int16_t inputs[4][AUDIO_BLOCK_SAMPLES], mix[AUDIO_BLOCK_SAMPLES];
+    bool present[4];
+    bool first = true;
+    for (int c = 0; c < 4; c++) {
+      present[c] = pick(4) != 0;
+      fill(inputs[c], uniform(0.0f, 1.0f));
+      if (present[c]) {
+        fused.mix_in(c, inputs[c], mix, first);
+        first = false;
+      }
+    }
+    const int16_t *expected = run(library, {present[0] ? inputs[0] : nullptr, present[1] ? inputs[1] : nullptr, present[2] ? inputs[2] : nullptr, present[3] ? inputs[3] : nullptr});
+    result.add(expected, first ? nullptr : mix);
+  }
+  return result.report(result.identical());
+}
+
+// the wide mixer of the effect and output stages against AudioMixer4, which transmits zeros where every present input is at zero gain and the wide mixer nothing
+static bool check_wide_mixer()
+{
+  static const float gains[] = {1.0f, 0.0f, 0.5f, 0.02f, -0.75f, 2.5f};
+  comparison result("wide mixer");
+  long zero_blocks = 0;
+  AudioMixer4 library;
+  wide_mixer<4> wide;
+  for (int b = 0; b < 20000; b++) {
+    for (int c = 0; c < 4; c++) {
+      float gain = gains[pick(6)];
+      library.gain(c, gain);
+      wide.gain(c, gain);
+    }
+    int16_t inputs[4][AUDIO_BLOCK_SAMPLES];
+    const int16_t *present[4];
+    for (int c = 0; c < 4; c++) {
+      fill(inputs[c], uniform(0.0f, 1.0f));
+      present[c] = pick(4) ? inputs[c] : nullptr;
+      if (present[c]) {
+        wide.inputQueue[c] = AudioStream::allocate();
+        memcpy(wide.inputQueue[c]->data, inputs[c], sizeof(inputs[c]));
+      }
+    }
+    const int16_t *expected = run(library, {present[0], present[1], present[2], present[3]});
+    wide.update();
+    const int16_t *mixed = output(wide);
+    if (expected && !mixed) {
+      // allowed only for a block of zeros
+      bool silent = true;
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        silent &= expected[i] == 0;
+      }
+      zero_blocks += silent;
+      if (silent) {
+        expected = nullptr;
+      }
+    }
+    result.add(expected, mixed);
+    delete wide.out[0];
+    wide.out[0] = nullptr;
+  }
+  printf("library_equivalence: %ld blocks of zeros from AudioMixer4 are not transmitted by the wide mixer\n", zero_blocks);
+  return result.report(result.identical());
+}
+
+// the gain of the stereo bus against AudioAmplifier, which transmits nothing at a gain of 0
+static bool check_amplifier()
+{
+  comparison result("amplifier");
+  AudioAmplifier library;
+  voice_amplifier fused;
+  for (int b = 0; b < 4000; b++) {
+    if (b % 20 == 0) {
+      float gain = pick(4) ? uniform(-4.0f, 4.0f) : (float)pick(2);
+      library.gain(gain);
+      fused.gain(gain);
+    }
+    int16_t input[AUDIO_BLOCK_SAMPLES], amplified[AUDIO_BLOCK_SAMPLES];
+    fill(input, uniform(0.0f, 1.0f));
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      amplified[i] = fused.apply(input[i]);
+    }
+    const int16_t *expected = run(library, {input});
+    result.add(expected, fused.active() ? amplified : nullptr);
+  }
+  return result.report(result.identical());
+}
+
+// the three outputs with a fixed and a modulated corner, then the lowpass of FILTER_LANES filters run in lock-step
+static bool check_filters()
+{
+  comparison single("filter, three outputs"), lanes("filter, lanes in lock-step");
+  AudioFilterStateVariable library[FILTER_LANES];
+  voice_filter fused[FILTER_LANES], fused_lanes[FILTER_LANES];
+  for (int b = 0; b < 6000; b++) {
+    if (b % 40 == 0) {
+      for (int l = 0; l < FILTER_LANES; l++) {
+        float frequency = uniform(20.0f, 18000.0f), q = uniform(0.7f, 5.0f), octaves = uniform(0.0f, 7.0f);
+        library[l].frequency(frequency);
+        fused[l].frequency(frequency);
+        fused_lanes[l].frequency(frequency);
+        library[l].resonance(q);
+        fused[l].resonance(q);
+        fused_lanes[l].resonance(q);
+        library[l].octaveControl(octaves);
+        fused[l].octaveControl(octaves);
+        fused_lanes[l].octaveControl(octaves);
+      }
+    }
+    int16_t inputs[FILTER_LANES][AUDIO_BLOCK_SAMPLES], controls[FILTER_LANES][AUDIO_BLOCK_SAMPLES];
+    int16_t low[AUDIO_BLOCK_SAMPLES], band[AUDIO_BLOCK_SAMPLES], high[AUDIO_BLOCK_SAMPLES];
+    int16_t *lane_blocks[FILTER_LANES];
+    const int16_t *lane_controls[FILTER_LANES];
+    for (int l = 0; l < FILTER_LANES; l++) {
+      fill(inputs[l], uniform(0.0f, 0.9f), pick(2) ? 0.0f : uniform(50.0f, 5000.0f), b * AUDIO_BLOCK_SAMPLES);
+      fill(controls[l], uniform(0.0f, 1.0f), uniform(0.5f, 20.0f), b * AUDIO_BLOCK_SAMPLES);
+      bool modulated = pick(2);
+      run(library[l], {inputs[l], modulated ? controls[l] : nullptr});
+      fused[l].process(inputs[l], modulated ? controls[l] : nullptr, low, band, high);
+      single.add(output(library[l], 0), low);
+      single.add(output(library[l], 1), band);
+      single.add(output(library[l], 2), high);
+      lane_blocks[l] = inputs[l];
+      lane_controls[l] = modulated ? controls[l] : nullptr;
+    }
+    voice_filter *filters[FILTER_LANES];
+    for (int l = 0; l < FILTER_LANES; l++) {
+      filters[l] = &fused_lanes[l];
+    }
+    voice_filter::process_lanes(filters, lane_blocks, lane_controls, FILTER_LANES);
+    for (int l = 0; l < FILTER_LANES; l++) {
+      lanes.add(output(library[l], 0), lane_blocks[l]);
+    }
+  }
+  bool passed = single.report(single.identical());
+  return lanes.report(lanes.identical()) && passed;
+}
+
+// the 13 library objects of a chord voice, updated in the order of audio_definition.h
+struct library_voice {
+  AudioEffectEnvelope vibrato_envelope;
+  AudioEffectEnvelope vibrato_dc_envelope;
+  AudioSynthWaveformDc frequency_dc;
+  AudioMixer4 vibrato_mixer;
+  AudioSynthNoiseWhite noise;
+  AudioSynthWaveformModulated osc3;
+  AudioSynthWaveformModulated osc1;
+  AudioSynthWaveformModulated osc2;
+  AudioEffectEnvelope envelope_filter;
+  AudioMixer4 mixer;
+  AudioFilterStateVariable filter;
+  AudioEffectEnvelope envelope;
+  AudioEffectMultiply tremolo_mult;
+  // inputs as those of ChordVoice: vibrato LFO, vibrato DC, filter LFO, tremolo LFO
+  const int16_t *update(const int16_t *const inputs[4])
+  {
+    const int16_t *vibrato = run(vibrato_envelope, {inputs[0]});
+    const int16_t *vibrato_dc = run(vibrato_dc_envelope, {inputs[1]});
+    const int16_t *dc = run(frequency_dc);
+    const int16_t *modulation = run(vibrato_mixer, {vibrato, vibrato_dc, dc});
+    const int16_t *white = run(noise);
+    const int16_t *tone3 = run(osc3, {modulation});
+    const int16_t *tone1 = run(osc1, {modulation});
+    const int16_t *tone2 = run(osc2, {modulation});
+    const int16_t *filter_control = run(envelope_filter, {inputs[2]});
+    const int16_t *mix = run(mixer, {tone1, tone2, tone3, white});
+    const int16_t *filtered = run(filter, {mix, filter_control});
+    const int16_t *amplitude = run(envelope, {inputs[3]});
+    return run(tremolo_mult, {filtered, amplitude});
+  }
+};
+
+// the settings of setup() and of a random preset, on either kind of voice
+template <class Voice>
+static void set_voice(Voice &voice, const float *settings, const float envelopes[4][7])
+{
+  static const short waveforms[] = {WAVEFORM_SINE, WAVEFORM_SAWTOOTH, WAVEFORM_SQUARE, WAVEFORM_TRIANGLE};
+  auto oscillators = {&voice.osc1, &voice.osc2, &voice.osc3};
+  int o = 0;
+  for (auto oscillator : oscillators) {
+    oscillator->begin(waveforms[(int)settings[o] & 3]);
+    oscillator->amplitude(settings[3 + o]);
+    oscillator->frequency(settings[6 + o]);
+    oscillator->frequencyModulation(2);
+    voice.mixer.gain(o, 1);
+    o++;
+  }
+  voice.mixer.gain(3, 0);
+  voice.noise.amplitude(0);
+  voice.vibrato_mixer.gain(0, settings[9]);
+  voice.vibrato_mixer.gain(1, 0.5f);
+  voice.filter.frequency(settings[10]);
+  voice.filter.resonance(settings[11]);
+  voice.filter.octaveControl(settings[12]);
+  set_envelope(voice.vibrato_envelope, envelopes[0]);
+  set_envelope(voice.vibrato_dc_envelope, envelopes[1]);
+  set_envelope(voice.envelope_filter, envelopes[2]);
+  set_envelope(voice.envelope, envelopes[3]);
+  voice.vibrato_dc_envelope.sustain(0);
+}
+
+// events of the note: on at block 0, a glide, a filter sweep, off at release_block
+template <class Voice>
+static void voice_event(Voice &voice, int block, int release_block, const float *settings)
+{
+  if (block == 0) {
+    voice.frequency_dc.amplitude(settings[13]);
+    voice.frequency_dc.amplitude(settings[14], settings[15]);
+    voice.vibrato_envelope.noteOn();
+    voice.vibrato_dc_envelope.noteOn();
+    voice.envelope_filter.noteOn();
+    voice.envelope.noteOn();
+  } else if (block == release_block / 2) {
+    voice.filter.frequency(settings[10] * 0.5f);
+  } else if (block == release_block) {
+    voice.vibrato_envelope.noteOff();
+    voice.vibrato_dc_envelope.noteOff();
+    voice.envelope_filter.noteOff();
+    voice.envelope.noteOff();
+  }
+}
+
+// notes from rest on new voices, until the amplitude envelope is idle again
+static bool check_chord_voice()
+{
+  comparison result("ChordVoice");
+  for (int trial = 0; trial < CHORD_TRIALS; trial++) {
+    auto library = std::make_unique<library_voice>();
+    auto fused = std::make_unique<ChordVoice>();
+    float settings[16], envelopes[4][7];
+    for (int o = 0; o < 3; o++) {
+      settings[o] = pick(4);
+      settings[3 + o] = uniform(0.0f, 0.35f);
+      settings[6 + o] = uniform(60.0f, 2000.0f);
+    }
+    settings[9] = uniform(0.0f, 0.25f);
+    settings[10] = uniform(100.0f, 10000.0f);
+    settings[11] = uniform(0.7f, 5.0f);
+    settings[12] = uniform(0.0f, 4.0f);
+    settings[13] = uniform(-0.4f, 0.4f);
+    settings[14] = uniform(-0.4f, 0.4f);
+    settings[15] = pick(2) ? 0.0f : uniform(1.0f, 200.0f);
+    for (int e = 0; e < 4; e++) {
+      random_envelope(envelopes[e]);
+    }
+    set_voice(*library, settings, envelopes);
+    set_voice(*fused, settings, envelopes);
+    int release_block = 20 + pick(200);
+    float vibrato_rate = uniform(1.0f, 8.0f), filter_rate = uniform(0.1f, 4.0f), tremolo_rate = uniform(1.0f, 10.0f);
+    for (int b = 0; b < 10000; b++) {
+      voice_event(*library, b, release_block, settings);
+      voice_event(*fused, b, release_block, settings);
+      int16_t vibrato[AUDIO_BLOCK_SAMPLES], bend[AUDIO_BLOCK_SAMPLES], filter_lfo[AUDIO_BLOCK_SAMPLES], tremolo[AUDIO_BLOCK_SAMPLES];
+      fill(vibrato, 1.0f, vibrato_rate, b * AUDIO_BLOCK_SAMPLES);
+      fill(bend, 0.0f);
+      fill(filter_lfo, 1.0f, filter_rate, b * AUDIO_BLOCK_SAMPLES);
+      fill(tremolo, 0.5f, tremolo_rate, b * AUDIO_BLOCK_SAMPLES);
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        tremolo[i] += 16384; // the tremolo of the modulation matrix, around half scale
+      }
+      const int16_t *inputs[4] = {vibrato, bend, filter_lfo, tremolo};
+      const int16_t *expected = library->update(inputs);
+      for (int i = 0; i < 4; i++) {
+        fused->inputQueue[i] = AudioStream::allocate();
+        memcpy(fused->inputQueue[i]->data, inputs[i], sizeof(fused->inputQueue[i]->data));
+      }
+      fused->update();
+      result.add(expected, output(*fused));
+      delete fused->out[0];
+      fused->out[0] = nullptr;
+      if (b > release_block && !library->envelope.isActive()) {
+        break;
+      }
+    }
+  }
+  return result.report(result.identical());
+}
+
+// the library objects of the 12 strings and transients with their mixers, updated in the order of audio_definition.h
+struct library_strings {
+  AudioSynthWaveformModulated oscillator[HARP_STRINGS];
+  AudioSynthWaveform transient[HARP_STRINGS];
+  AudioEffectEnvelope envelope_filter[HARP_STRINGS];
+  AudioEffectEnvelope envelope[HARP_STRINGS];
+  AudioEffectEnvelope transient_envelope[HARP_STRINGS];
+  AudioFilterStateVariable filter[HARP_STRINGS];
+  AudioMixer4 transient_mix[3];
+  AudioMixer4 transient_full_mix;
+  AudioMixer4 string_mix[3];
+  AudioMixer4 all_string_mix;
+  library_strings()
+  {
+    all_string_mix.gain(3, 0.02f);
+  }
+  // inputs as those of HarpStringBank: vibrato modulation, filter envelope source
+  const int16_t *update(const int16_t *vibrato, const int16_t *filter_dc)
+  {
+    const int16_t *strings[HARP_STRINGS], *transients[HARP_STRINGS];
+    for (int s = 0; s < HARP_STRINGS; s++) {
+      run(oscillator[s], {vibrato});
+      run(transient[s]);
+      run(envelope_filter[s], {filter_dc});
+    }
+    for (int s = 0; s < HARP_STRINGS; s++) {
+      run(envelope[s], {output(oscillator[s])});
+      transients[s] = run(transient_envelope[s], {output(transient[s])});
+    }
+    for (int s = 0; s < HARP_STRINGS; s++) {
+      strings[s] = run(filter[s], {output(envelope[s]), output(envelope_filter[s])});
+    }
+    for (int m = 0; m < 3; m++) {
+      run(transient_mix[m], {transients[4 * m], transients[4 * m + 1], transients[4 * m + 2], transients[4 * m + 3]});
+    }
+    const int16_t *all_transients = run(transient_full_mix, {output(transient_mix[0]), output(transient_mix[1]), output(transient_mix[2])});
+    for (int m = 0; m < 3; m++) {
+      run(string_mix[m], {strings[4 * m], strings[4 * m + 1], strings[4 * m + 2], strings[4 * m + 3]});
+    }
+    return run(all_string_mix, {output(string_mix[0]), output(string_mix[1]), output(string_mix[2]), all_transients});
+  }
+};
+
+// the members of one string under the names of HarpStringBank, on the library side
+struct library_string {
+  AudioSynthWaveformModulated &oscillator;
+  AudioEffectEnvelope &envelope;
+  AudioEffectEnvelope &envelope_filter;
+  AudioFilterStateVariable &filter;
+  AudioSynthWaveform &transient;
+  AudioEffectEnvelope &transient_envelope;
+};
+
+template <class String>
+static void set_string(String &&string, const float *settings, const float envelopes[3][7])
+{
+  static const short waveforms[] = {WAVEFORM_SINE, WAVEFORM_SAWTOOTH, WAVEFORM_SQUARE, WAVEFORM_TRIANGLE};
+  string.oscillator.begin(waveforms[(int)settings[0] & 3]);
+  string.oscillator.amplitude(settings[1]);
+  string.oscillator.frequency(settings[2]);
+  string.oscillator.frequencyModulation(settings[3]);
+  string.transient.begin(settings[4], settings[5], waveforms[(int)settings[6] & 3]);
+  string.filter.frequency(settings[7]);
+  string.filter.resonance(settings[8]);
+  string.filter.octaveControl(settings[9]);
+  set_envelope(string.envelope, envelopes[0]);
+  set_envelope(string.envelope_filter, envelopes[1]);
+  set_envelope(string.transient_envelope, envelopes[2]);
+  string.transient_envelope.sustain(0);
+}
+
+// each string plucked once and released at its own block
+template <class String>
+static void string_event(String &&string, int block, int release_block)
+{
+  if (block == 0) {
+    string.envelope.noteOn();
+    string.envelope_filter.noteOn();
+    string.transient_envelope.noteOn();
+  } else if (block == release_block) {
+    string.envelope.noteOff();
+    string.envelope_filter.noteOff();
+    string.transient_envelope.noteOff();
+  }
+}
+
+// the strings plucked together from rest on new objects, until all of them are idle again
+// a string not plucked yet would already have drifted, its oscillator advancing without the vibrato
+static bool check_harp_strings()
+{
+  comparison result("HarpStringBank");
+  for (int trial = 0; trial < HARP_TRIALS; trial++) {
+    auto library = std::make_unique<library_strings>();
+    auto fused = std::make_unique<HarpStringBank>();
+    fused->transient_gain(0.02f);
+    int release[HARP_STRINGS];
+    for (int s = 0; s < HARP_STRINGS; s++) {
+      float settings[10], envelopes[3][7];
+      settings[0] = pick(4);
+      settings[1] = uniform(0.0f, 0.04f); // the 12 strings together below full scale, with the overshoot of the filters
+      settings[2] = uniform(80.0f, 2500.0f);
+      settings[3] = uniform(0.1f, 2.0f);
+      settings[4] = uniform(0.0f, 0.08f); // the 12 transients together below full scale
+      settings[5] = uniform(500.0f, 8000.0f);
+      settings[6] = pick(4);
+      settings[7] = uniform(200.0f, 3000.0f); // a corner the filter envelope raises past the Nyquist frequency makes the filter ring loud
+      settings[8] = uniform(0.7f, 1.2f);
+      settings[9] = uniform(0.0f, 2.0f);
+      for (int e = 0; e < 3; e++) {
+        random_envelope(envelopes[e]);
+      }
+      library_string string = {library->oscillator[s], library->envelope[s], library->envelope_filter[s], library->filter[s], library->transient[s], library->transient_envelope[s]};
+      set_string(string, settings, envelopes);
+      set_string(fused->strings[s], settings, envelopes);
+      release[s] = 1 + pick(300);
+    }
+    float vibrato_rate = uniform(1.0f, 8.0f), vibrato_level = uniform(0.0f, 0.3f);
+    for (int b = 0; b < 10000; b++) {
+      bool sounding = false;
+      for (int s = 0; s < HARP_STRINGS; s++) {
+        library_string string = {library->oscillator[s], library->envelope[s], library->envelope_filter[s], library->filter[s], library->transient[s], library->transient_envelope[s]};
+        string_event(string, b, release[s]);
+        string_event(fused->strings[s], b, release[s]);
+        sounding |= b <= release[s] || library->envelope[s].isActive() || library->transient_envelope[s].isActive();
+      }
+      if (!sounding) {
+        break;
+      }
+      int16_t vibrato[AUDIO_BLOCK_SAMPLES], filter_dc[AUDIO_BLOCK_SAMPLES];
+      fill(vibrato, vibrato_level, vibrato_rate, b * AUDIO_BLOCK_SAMPLES);
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        filter_dc[i] = 32767;
+      }
+      const int16_t *expected = library->update(vibrato, filter_dc);
+      fused->inputQueue[0] = AudioStream::allocate();
+      memcpy(fused->inputQueue[0]->data, vibrato, sizeof(vibrato));
+      fused->inputQueue[1] = AudioStream::allocate();
+      memcpy(fused->inputQueue[1]->data, filter_dc, sizeof(filter_dc));
+      fused->update();
+      result.add(expected, output(*fused));
+      delete fused->out[0];
+      fused->out[0] = nullptr;
+    }
+  }
+  // a block of silence transmitted by one side only is the same as none to the mixer downstream, add() counts it as silence
+  return result.report(result.largest < HARP_STRINGS);
+}
+
+int main()
+{
+  // made first, for the seeds of the first noises of both sides
+  static AudioSynthNoiseWhite library_noise[4];
+  static voice_noise fused_noise[4];
+  bool passed = check_noise(library_noise, fused_noise);
+  passed &= check_envelopes();
+  passed &= check_oscillators();
+  passed &= check_transients();
+  passed &= check_dc();
+  passed &= check_mixer();
+  passed &= check_wide_mixer();
+  passed &= check_amplifier();
+  passed &= check_filters();
+  passed &= check_chord_voice();
+  passed &= check_harp_strings();
+  if (AudioStream::memory_used) {
+    printf("%d audio blocks leaked\n", AudioStream::memory_used);
+    return 1;
+  }
+  if (!passed) {
+    printf("library_equivalence: the fused objects differ from the library\n");
+    return 1;
+  }
+  printf("library_equivalence: the fused objects give the output of the library objects\n");
+  return 0;
+}
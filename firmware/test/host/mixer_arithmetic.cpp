@@ -0,0 +1,107 @@
+// the wide mixer against the arithmetic of AudioMixer4, with 2, 4 and 16 inputs
+// gains at zero, unity, fractional, negative and above unity, inputs missing, and inputs shared with another object as a waveshaper mix has them
+// the mixed blocks must be the same sample for sample, the only difference allowed is the one of wide_mixer.h:
+// where every present input is at zero gain AudioMixer4 transmits zeros and the wide mixer transmits nothing
+// no block may be left held
+#include "wide_mixer.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BLOCKS 200000
+
+static uint32_t seed = 3;
+
+static uint32_t draw(uint32_t n)
+{
+  seed = seed * 1664525u + 1013904223u;
+  return (seed >> 8) % n;
+}
+
+static int16_t saturate(int32_t value)
+{
+  return value > 32767 ? 32767 : value < -32768 ? -32768 : value;
+}
+
+// AudioMixer4::update over any number of inputs: the first present input scaled unless at unity, the next ones scaled and added with saturation
+static bool audio_mixer(int channels, int16_t (*inputs)[AUDIO_BLOCK_SAMPLES], const bool *present, const int32_t *multiplier, int16_t *output)
+{
+  bool any = false;
+  for (int c = 0; c < channels; c++) {
+    if (!present[c]) {
+      continue;
+    }
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      int32_t scaled = multiplier[c] == 65536 ? inputs[c][i] : saturate(((int64_t)multiplier[c] * inputs[c][i]) >> 16);
+      output[i] = any ? saturate(output[i] + scaled) : scaled;
+    }
+    any = true;
+  }
+  return any;
+}
+
+template <unsigned char channels>
+static bool check()
+{
+  static const float gains[] = {0.0f, 1.0f, 0.5f, -0.75f, 2.0f, 0.02f};
+  wide_mixer<channels> mixer;
+  long differing = 0, transmitted = 0, mixed = 0;
+  for (int b = 0; b < BLOCKS / channels; b++) {
+    int16_t inputs[channels][AUDIO_BLOCK_SAMPLES];
+    bool present[channels];
+    int32_t multiplier[channels];
+    for (int c = 0; c < channels; c++) {
+      float gain = gains[draw(6)];
+      mixer.gain(c, gain);
+      multiplier[c] = gain * 65536.0f;
+      present[c] = draw(4) != 0;
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        inputs[c][i] = draw(65536) - 32768;
+      }
+      if (present[c]) {
+        audio_block_t *block = AudioStream::allocate();
+        memcpy(block->data, inputs[c], sizeof(inputs[c]));
+        block->ref_count = draw(2) ? 2 : 1; // 2 when another object reads it too, the mixer then copies it
+        mixer.inputQueue[c] = block;
+      }
+    }
+    int16_t expected[AUDIO_BLOCK_SAMPLES];
+    bool any = audio_mixer(channels, inputs, present, multiplier, expected);
+    bool audible = false;
+    for (int c = 0; c < channels; c++) {
+      audible |= present[c] && multiplier[c] != 0;
+    }
+    mixer.update();
+    if (audible != (mixer.out[0] != nullptr)) {
+      transmitted++;
+    } else if (audible) {
+      mixed++;
+      differing += memcmp(expected, mixer.out[0]->data, sizeof(expected)) != 0;
+    } else if (any) {
+      // zeros from AudioMixer4, nothing from the wide mixer
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        differing += expected[i] != 0;
+      }
+    }
+    delete mixer.out[0];
+    mixer.out[0] = nullptr;
+  }
+  printf("mixer_arithmetic: %2d inputs, %ld mixed blocks, %ld differ, %ld transmitted by one side only\n", channels, mixed, differing, transmitted);
+  return !differing && !transmitted;
+}
+
+int main()
+{
+  bool passed = check<2>();
+  passed &= check<4>();
+  passed &= check<16>();
+  if (AudioStream::memory_used) {
+    printf("%d audio blocks leaked\n", AudioStream::memory_used);
+    return 1;
+  }
+  if (!passed) {
+    printf("mixer_arithmetic: the wide mixer differs from AudioMixer4\n");
+    return 1;
+  }
+  printf("mixer_arithmetic: the wide mixer is bit identical to AudioMixer4\n");
+  return 0;
+}
@@ -0,0 +1,212 @@
+// the LFOs of the modulation matrix, evaluated once per block, against the same LFOs generated every sample as AudioSynthWaveform did
+// the per sample reference is voice_oscillator, which library_equivalence holds to AudioSynthWaveform, with the offset added as AudioSynthWaveform adds it
+// except for the pulse and the variable triangle, which voice_oscillator shapes as AudioSynthWaveformModulated without a shape input:
+// for these two the reference is the loop of AudioSynthWaveform at its default pulse width
+// the matrix ramps from the value at the end of one block to the value at the end of the next, so sample i of a block stands for sample i+1 of the reference
+// at the end of each block it must be within the tolerance of its shape of the reference, give or take a sample for the rounding of the two phase increments,
+// and within a block no further from the reference than a ramp can be from a curve: its largest step between two samples times half a block
+// the square, pulse and sawtooths jump, the ramp spreads each jump over the block where it falls, their error within a block is then the jump itself
+// sample and hold draws its values with random() in another order than the reference, it is left out
+// a matrix without amplitude or route must transmit nothing, a route must add its depth to an output, and no block may be left held
+#include "modulation_matrix.h"
+#include "voice_components.h"
+#include "Audio.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BLOCKS 1000
+
+struct shape {
+  const char *name;
+  short type;
+  int tolerance; // at the end of the blocks
+};
+
+static const shape shapes[] = {
+  {"sine", WAVEFORM_SINE, 4},
+  {"triangle", WAVEFORM_TRIANGLE, 4},
+  {"variable triangle", WAVEFORM_TRIANGLE_VARIABLE, 12}, // AudioSynthWaveform drops the low 16 bits of the phase, the matrix keeps them
+  {"square", WAVEFORM_SQUARE, 4},
+  {"pulse", WAVEFORM_PULSE, 4},
+  {"sawtooth", WAVEFORM_SAWTOOTH, 4},
+  {"reverse sawtooth", WAVEFORM_SAWTOOTH_REVERSE, 4},
+};
+
+// the pulse and variable triangle of AudioSynthWaveform::update(), with its default pulse width of a quarter
+struct waveform_lfo {
+  uint32_t phase = 0;
+  uint32_t increment;
+  int32_t magnitude;
+  short type;
+  waveform_lfo(float amplitude, float frequency, short type) : increment(frequency * (4294967296.0f / AUDIO_SAMPLE_RATE_EXACT)), magnitude(amplitude * 65536.0f), type(type) {}
+  void process(int16_t *output)
+  {
+    const uint32_t pulse_width = 0x40000000;
+    int16_t magnitude15 = signed_saturate_rshift(magnitude, 16, 1);
+    uint32_t rise = 0xFFFFFFFF / (pulse_width >> 16);
+    uint32_t fall = 0xFFFFFFFF / (0xFFFF - (pulse_width >> 16));
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      uint32_t ph = phase;
+      if (type == WAVEFORM_PULSE) {
+        output[i] = ph < pulse_width ? magnitude15 : -magnitude15;
+      } else if (ph < pulse_width / 2) {
+        uint32_t n = (ph >> 16) * rise;
+        output[i] = ((n >> 16) * magnitude) >> 16;
+      } else if (ph < 0xFFFFFFFF - pulse_width / 2) {
+        int32_t n = 0x7FFFFFFF - (((ph - pulse_width / 2) >> 16) * fall);
+        output[i] = ((n >> 16) * magnitude) >> 16;
+      } else {
+        uint32_t n = ((ph + pulse_width / 2) >> 16) * rise + 0x80000000;
+        output[i] = (((int32_t)n >> 16) * magnitude) >> 16;
+      }
+      phase += increment;
+    }
+  }
+};
+
+// one block of the per sample LFO
+static void reference_block(voice_oscillator &oscillator, waveform_lfo &waveform, int32_t offset, int16_t *output)
+{
+  if (waveform.type == WAVEFORM_PULSE || waveform.type == WAVEFORM_TRIANGLE_VARIABLE) {
+    waveform.process(output);
+  } else if (!oscillator.process(nullptr, output)) {
+    memset(output, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+  }
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    output[i] = signed_saturate_rshift(output[i] + offset, 16, 0);
+  }
+}
+
+static bool check_shape(const shape &s, float frequency, float amplitude, float offset)
+{
+  modulation_matrix matrix;
+  control_lfo &lfo = matrix.lfo[0];
+  lfo.begin(s.type);
+  lfo.frequency(frequency);
+  lfo.amplitude(amplitude);
+  lfo.offset(offset);
+  voice_oscillator oscillator;
+  oscillator.begin(amplitude, frequency, s.type);
+  waveform_lfo waveform(amplitude, frequency, s.type);
+  int32_t level_offset = offset * 32767.0f;
+
+  // the reference two blocks at a time, the matrix block b is compared with samples 1 to 128 of the block b of the reference
+  int16_t reference[2 * AUDIO_BLOCK_SAMPLES + 1];
+  reference_block(oscillator, waveform, level_offset, reference);
+  int end_error = 0, within_error = 0, bound = 0;
+  for (int b = 0; b < BLOCKS; b++) {
+    reference_block(oscillator, waveform, level_offset, reference + AUDIO_BLOCK_SAMPLES);
+    reference[2 * AUDIO_BLOCK_SAMPLES] = reference[2 * AUDIO_BLOCK_SAMPLES - 1];
+    matrix.update();
+    audio_block_t *block = matrix.out[0];
+    if (!block) {
+      printf("modulation_blocks: %s at %.1f Hz transmitted nothing\n", s.name, frequency);
+      return false;
+    }
+    int largest_step = 0;
+    for (int i = 1; i <= AUDIO_BLOCK_SAMPLES; i++) {
+      largest_step = std::max(largest_step, abs(reference[i] - reference[i - 1]));
+    }
+    int end = AUDIO_BLOCK_SAMPLES;
+    int error = std::min(abs(block->data[end - 1] - reference[end]), std::min(abs(block->data[end - 1] - reference[end - 1]), abs(block->data[end - 1] - reference[end + 1])));
+    // the first block ramps up from 0
+    if (b > 0) {
+      end_error = std::max(end_error, error);
+      int within = 0;
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        within = std::max(within, abs(block->data[i] - reference[i + 1]));
+      }
+      int block_bound = largest_step * AUDIO_BLOCK_SAMPLES / 2 + s.tolerance;
+      if (within > block_bound) {
+        bound = -1;
+      } else if (bound >= 0) {
+        bound = std::max(bound, block_bound);
+      }
+      within_error = std::max(within_error, within);
+    }
+    delete matrix.out[0];
+    matrix.out[0] = nullptr;
+    memcpy(reference, reference + AUDIO_BLOCK_SAMPLES, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+  }
+  printf("modulation_blocks: %-17s %5.1f Hz, at the end of the blocks within %d, within the blocks %5d (%.4f of full scale)%s\n", s.name, frequency, end_error,
+         within_error, within_error / 32768.0, bound < 0 ? ", further than a ramp can be" : "");
+  return end_error <= s.tolerance && bound >= 0;
+}
+
+// blocks transmitted by the matrix over some updates, their extremes on one output, released
+static int run(modulation_matrix &matrix, int updates, int output, int &lowest, int &highest)
+{
+  int transmitted = 0;
+  for (int u = 0; u < updates; u++) {
+    matrix.update();
+    for (int n = 0; n < MODULATION_LFOS; n++) {
+      if (!matrix.out[n]) {
+        continue;
+      }
+      transmitted++;
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES && n == output; i++) {
+        lowest = std::min(lowest, (int)matrix.out[n]->data[i]);
+        highest = std::max(highest, (int)matrix.out[n]->data[i]);
+      }
+      delete matrix.out[n];
+      matrix.out[n] = nullptr;
+    }
+  }
+  return transmitted;
+}
+
+int main()
+{
+  static const float frequencies[] = {0.5f, 5.0f, 20.0f, MODULATION_MAX_FREQUENCY};
+  bool passed = true;
+  for (const shape &s : shapes) {
+    for (float frequency : frequencies) {
+      passed &= check_shape(s, frequency, 0.7f, 0.2f);
+    }
+  }
+
+  // without amplitude nothing is transmitted, even with an offset as AudioSynthWaveform transmitted nothing at 0 amplitude
+  modulation_matrix matrix;
+  for (int n = 0; n < MODULATION_LFOS; n++) {
+    matrix.lfo[n].begin(WAVEFORM_SINE);
+    matrix.lfo[n].frequency(3);
+    matrix.lfo[n].offset(0.5f);
+  }
+  int lowest = 32767, highest = -32768;
+  int idle = run(matrix, 100, -1, lowest, highest);
+  printf("modulation_blocks: without amplitude, %d blocks transmitted\n", idle);
+  passed &= idle == 0;
+
+  // a square at a quarter depth on output 4, whose LFO is silent, and a half depth route to a sysex address
+  matrix.lfo[1].begin(WAVEFORM_SQUARE);
+  matrix.lfo[1].frequency(2);
+  matrix.route_source(0, 2);
+  matrix.route_destination(0, 4);
+  matrix.route_depth(0, 0.25f);
+  matrix.route_source(1, 2);
+  matrix.route_destination(1, 80);
+  matrix.route_depth(1, 0.5f);
+  float lowest_value = 1, highest_value = -1;
+  int transmitted = 0;
+  for (int u = 0; u < 400; u++) {
+    transmitted += run(matrix, 1, 3, lowest, highest);
+    lowest_value = std::min(lowest_value, matrix.route_value(1));
+    highest_value = std::max(highest_value, matrix.route_value(1));
+  }
+  int expected = 0.25f * 32767;
+  printf("modulation_blocks: routed to output 4 from %d to %d in %d blocks, to address %d from %.3f to %.3f, route to an output has address %d\n", lowest, highest,
+         transmitted, matrix.sysex_destination(1), lowest_value, highest_value, matrix.sysex_destination(0));
+  passed &= abs(lowest + expected) <= 1 && abs(highest - expected) <= 1 && transmitted <= 400;
+  passed &= matrix.sysex_destination(1) == 80 && matrix.sysex_destination(0) == 0 && lowest_value == -highest_value && fabsf(highest_value - 0.5f) < 0.001f;
+
+  if (AudioStream::memory_used) {
+    printf("%d audio blocks leaked\n", AudioStream::memory_used);
+    return 1;
+  }
+  if (!passed) {
+    printf("modulation_blocks: the block rate LFOs differ from the per sample ones\n");
+    return 1;
+  }
+  printf("modulation_blocks: the block rate LFOs follow the per sample ones, the idle matrix transmits nothing and the routes add their depth\n");
+  return 0;
+}
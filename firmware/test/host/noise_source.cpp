@@ -0,0 +1,160 @@
+// the four chord voice noises reading the shared voice_noise_source, against the AudioSynthNoiseWhite objects they replaced
+// the first noise must give the samples of an AudioSynthNoiseWhite of the same amplitude, that of the first instance, seeded with 1,
+// while the others are muted and unmuted at random, and when all of them are muted for a while, which must generate nothing
+// the views of the shared block must each be a permutation of it, share no more than MAX_SHARED of its samples with any other at any lag,
+// and the four noises must be as loud as four AudioSynthNoiseWhite and as uncorrelated with each other
+#include "voice_components.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define VOICES 4
+#define BLOCKS 4000
+#define MAX_SHARED 4
+#define MAX_CORRELATION 0.01
+
+static uint32_t seed = 5;
+
+static uint32_t draw(uint32_t n)
+{
+  seed = seed * 1664525u + 1013904223u;
+  return (seed >> 8) % n;
+}
+
+// AudioSynthNoiseWhite: Park-Miller, seeded with 1 plus the number of instances before it, each update scales a block by the amplitude
+// nothing is generated while the amplitude is 0
+struct white_noise {
+  uint32_t seed;
+  int32_t level = 0;
+  white_noise(int instance) : seed(1 + instance) {}
+  void amplitude(float n)
+  {
+    level = (n < 0.0f ? 0.0f : n > 1.0f ? 1.0f : n) * 65536.0f;
+  }
+  bool update(int16_t *output)
+  {
+    if (level == 0) {
+      return false;
+    }
+    uint32_t lo = seed;
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      uint32_t hi = 16807 * (lo >> 16);
+      lo = 16807 * (lo & 0xFFFF);
+      lo += (hi & 0x7FFF) << 16;
+      lo += hi >> 15;
+      lo = (lo & 0x7FFFFFFF) + (lo >> 31);
+      output[i] = (level * (int16_t)lo) >> 16;
+    }
+    seed = lo;
+    return true;
+  }
+};
+
+// sample i of the n-th view is sample i*(2n+1)+37n of the block, as in voice_noise
+static int view_index(int n, int i)
+{
+  return (i * (2 * n + 1) + 37 * n) & (AUDIO_BLOCK_SAMPLES - 1);
+}
+
+static bool check_views()
+{
+  bool passed = true;
+  for (int n = 0; n < VOICES; n++) {
+    bool read[AUDIO_BLOCK_SAMPLES] = {};
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      read[view_index(n, i)] = true;
+    }
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      passed &= read[i];
+    }
+  }
+  int largest = 0;
+  for (int a = 0; a < VOICES; a++) {
+    for (int b = 0; b < VOICES; b++) {
+      for (int lag = a < b ? 0 : 1; lag < AUDIO_BLOCK_SAMPLES && a != b; lag++) {
+        int shared = 0;
+        for (int i = 0; i + lag < AUDIO_BLOCK_SAMPLES; i++) {
+          shared += view_index(a, i) == view_index(b, i + lag);
+        }
+        largest = std::max(largest, shared);
+      }
+    }
+  }
+  printf("noise_source: the views are %spermutations of the block, two of them share at most %d of %d samples at any lag\n", passed ? "" : "not all ", largest, AUDIO_BLOCK_SAMPLES);
+  return passed && largest <= MAX_SHARED;
+}
+
+int main()
+{
+  bool passed = check_views();
+  voice_noise noises[VOICES];
+  white_noise reference(0);
+  static const float levels[] = {1.0f, 0.5f, 0.03f};
+  long differing = 0, compared = 0, silent = 0;
+  for (int b = 0; b < BLOCKS; b++) {
+    // a tenth of the blocks with every noise muted, the others with the first noise sounding
+    bool all_muted = b % 100 >= 90;
+    if (b % 10 == 0) {
+      float level = levels[draw(3)];
+      noises[0].amplitude(all_muted ? 0.0f : level);
+      reference.amplitude(all_muted ? 0.0f : level);
+      for (int n = 1; n < VOICES; n++) {
+        noises[n].amplitude(all_muted || draw(2) ? 0.0f : levels[draw(3)]);
+      }
+    }
+    int16_t output[VOICES][AUDIO_BLOCK_SAMPLES], expected[AUDIO_BLOCK_SAMPLES];
+    bool sounding = false;
+    for (int n = 0; n < VOICES; n++) {
+      sounding |= noises[n].process(output[n]);
+    }
+    if (reference.update(expected)) {
+      compared++;
+      differing += memcmp(expected, output[0], sizeof(expected)) != 0;
+    } else {
+      silent += !sounding;
+    }
+  }
+  printf("noise_source: first noise, %ld blocks, %ld differ from AudioSynthNoiseWhite, %ld blocks with every noise muted\n", compared, differing, silent);
+  passed &= !differing && compared + silent == BLOCKS;
+
+  // all four at full amplitude, levels and correlations against four AudioSynthNoiseWhite
+  double products[VOICES][VOICES] = {};
+  double reference_power[VOICES] = {};
+  white_noise references[VOICES] = {white_noise(0), white_noise(1), white_noise(2), white_noise(3)};
+  for (int n = 0; n < VOICES; n++) {
+    noises[n].amplitude(1.0f);
+    references[n].amplitude(1.0f);
+  }
+  for (int b = 0; b < BLOCKS; b++) {
+    int16_t output[VOICES][AUDIO_BLOCK_SAMPLES], expected[AUDIO_BLOCK_SAMPLES];
+    for (int n = 0; n < VOICES; n++) {
+      noises[n].process(output[n]);
+      references[n].update(expected);
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        reference_power[n] += (double)expected[i] * expected[i];
+      }
+    }
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      for (int x = 0; x < VOICES; x++) {
+        for (int y = 0; y < VOICES; y++) {
+          products[x][y] += (double)output[x][i] * output[y][i];
+        }
+      }
+    }
+  }
+  double correlation = 0, level = 0;
+  for (int x = 0; x < VOICES; x++) {
+    level = std::max(level, fabs(10 * log10(products[x][x] / reference_power[x])));
+    for (int y = x + 1; y < VOICES; y++) {
+      correlation = std::max(correlation, fabs(products[x][y] / sqrt(products[x][x] * products[y][y])));
+    }
+  }
+  printf("noise_source: the noises are within %.3f dB of AudioSynthNoiseWhite, their largest correlation is %.4f\n", level, correlation);
+  passed &= level < 0.1 && correlation < MAX_CORRELATION;
+  if (!passed) {
+    printf("noise_source: the shared noise differs from the separate AudioSynthNoiseWhite\n");
+    return 1;
+  }
+  printf("noise_source: the first noise is sample exact with AudioSynthNoiseWhite, the others are as loud and uncorrelated\n");
+  return 0;
+}
@@ -0,0 +1,121 @@
+// two plate reverbs of different sizes carved one after the other from a shared arena, as for a harp bus and a chord bus
+// the first one must give the output of a lone reverb of the same size fed the same input, so that no state is shared,
+// and the second one, larger, writes its render so that the two kernels can be compared at a scale other than 1
+// the stage by stage kernel must refuse a scale where its taps would read less than a block ahead
+#include "effect_platervbstereo.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define BLOCKS 2000
+#define SMALL_SCALE 0.6f
+#define LARGE_SCALE 1.5f
+
+static uint32_t seed = 1;
+
+static float noise()
+{
+  seed = seed * 1664525u + 1013904223u;
+  return (int32_t)seed / 2147483648.0f;
+}
+
+// bursts of noise and of two sines, each 100 blocks on and 200 off
+static void input_block(int block, int16_t *left, int16_t *right)
+{
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    int n = block * AUDIO_BLOCK_SAMPLES + i;
+    float s = 0.0f;
+    if (block % 300 < 100) s = block % 600 < 300 ? 0.4f * noise() : 0.3f * sinf(n * 0.031f) + 0.2f * sinf(n * 0.0473f);
+    left[i] = (int16_t)(s * 32767.0f);
+    right[i] = (int16_t)(s * 0.8f * 32767.0f);
+  }
+}
+
+// one update, the output blocks are copied then released, silence when the reverb is asleep
+static void run(AudioEffectPlateReverb &reverb, const int16_t *input_left, const int16_t *input_right, int16_t *output)
+{
+  audio_block_t *left = AudioStream::allocate(), *right = AudioStream::allocate();
+  memcpy(left->data, input_left, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+  memcpy(right->data, input_right, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+  reverb.inputQueue[0] = left;
+  reverb.inputQueue[1] = right;
+  reverb.update();
+  for (int c = 0; c < 2; c++) {
+    if (reverb.out[c]) memcpy(output + c * AUDIO_BLOCK_SAMPLES, reverb.out[c]->data, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+    else memset(output + c * AUDIO_BLOCK_SAMPLES, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+    delete reverb.out[c];
+    reverb.out[c] = nullptr;
+  }
+}
+
+static void setup(AudioEffectPlateReverb &reverb)
+{
+  reverb.size(0.9f);
+  reverb.hidamp(0.2f);
+  reverb.lodamp(0.1f);
+  reverb.lowpass(0.7f);
+  reverb.diffusion(0.65f);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s large_instance.raw\n", argv[0]);
+    return 2;
+  }
+  static AudioEffectPlateReverb first, second, lone, small;
+  static float arena[(AudioEffectPlateReverb::memory_size(1.0f) + AudioEffectPlateReverb::memory_size(LARGE_SCALE)) / sizeof(float) + 1];
+  static float lone_arena[AudioEffectPlateReverb::memory_size(1.0f) / sizeof(float) + 1];
+  static float small_arena[AudioEffectPlateReverb::memory_size(SMALL_SCALE) / sizeof(float) + 1];
+  size_t first_used = first.begin(arena, sizeof(arena));
+  size_t second_used = second.begin((char *)arena + first_used, sizeof(arena) - first_used, LARGE_SCALE);
+  lone.begin(lone_arena, sizeof(lone_arena));
+  size_t small_used = small.begin(small_arena, sizeof(small_arena), SMALL_SCALE);
+  printf("lines of %u bytes at a scale of 1, %u bytes at %.1f, %u bytes at %.1f\n", (unsigned)AudioEffectPlateReverb::memory_size(1.0f),
+         (unsigned)AudioEffectPlateReverb::memory_size(SMALL_SCALE), SMALL_SCALE, (unsigned)AudioEffectPlateReverb::memory_size(LARGE_SCALE), LARGE_SCALE);
+  if (!first_used || !second_used || first_used + second_used > sizeof(arena)) {
+    printf("reverb_instances: the two reverbs do not fit in the arena sized from memory_size()\n");
+    return 1;
+  }
+#ifdef REVERB_REFERENCE_KERNEL
+  bool small_expected = true;
+#else
+  bool small_expected = AUDIO_BLOCK_SAMPLES + 16 <= 145 * SMALL_SCALE; // the shortest tap offset against a block and the LFO excursion
+#endif
+  if ((small_used != 0) != small_expected) {
+    printf("reverb_instances: the scale of %.1f was %s\n", SMALL_SCALE, small_used ? "accepted" : "refused");
+    return 1;
+  }
+  setup(first);
+  setup(second);
+  setup(lone);
+  FILE *output = fopen(argv[1], "wb");
+  if (!output) {
+    perror(argv[1]);
+    return 2;
+  }
+  long differences = 0, second_differences = 0;
+  for (int b = 0; b < BLOCKS; b++) {
+    int16_t left[AUDIO_BLOCK_SAMPLES], right[AUDIO_BLOCK_SAMPLES];
+    int16_t first_out[2 * AUDIO_BLOCK_SAMPLES], second_out[2 * AUDIO_BLOCK_SAMPLES], lone_out[2 * AUDIO_BLOCK_SAMPLES];
+    input_block(b, left, right);
+    // the second reverb gets the channels swapped, the same input would hide a shared state
+    run(first, left, right, first_out);
+    run(second, right, left, second_out);
+    run(lone, left, right, lone_out);
+    if (memcmp(first_out, lone_out, sizeof(first_out))) differences++;
+    if (memcmp(first_out, second_out, sizeof(first_out))) second_differences++;
+    fwrite(second_out, sizeof(int16_t), 2 * AUDIO_BLOCK_SAMPLES, output);
+  }
+  fclose(output);
+  if (AudioStream::memory_used) {
+    printf("%d audio blocks leaked\n", AudioStream::memory_used);
+    return 1;
+  }
+  if (differences || !second_differences) {
+    printf("reverb_instances: %ld blocks of the first reverb differ from the lone one, %ld blocks differ between the two reverbs\n", differences, second_differences);
+    return 1;
+  }
+  printf("reverb_instances: %d blocks, the first reverb of the arena is identical to a lone one\n", BLOCKS);
+  return 0;
+}
@@ -0,0 +1,47 @@
+// layout of the test performance of reverb_render, shared with the programs analysing its renders
+// segments of SEGMENT_BLOCKS blocks: chords, silence, noise bursts, silence, twice, then a long silence so that the reverb can sleep
+// the size of the reverb goes from 0.9 to 0.5 at SIZE_CHANGE_BLOCK
+#ifndef REVERB_PERFORMANCE_H
+#define REVERB_PERFORMANCE_H
+
+#define SEGMENT_BLOCKS 300
+
+#ifdef REVERB_PERFORMANCE_BURSTS
+// the performance of the first measurements of the int16 storage: bursts of two sines and noise, 300 blocks on and 300 off
+#define PERFORMANCE_BLOCKS 4000
+#define SIZE_CHANGE_BLOCK 2000
+
+// 4 burst, 1 silence
+static inline int segment_type(int block)
+{
+  return (block / SEGMENT_BLOCKS) % 2 ? 1 : 4;
+}
+#else
+#define PLAYED_SEGMENTS 8
+#define FINAL_SILENCE_BLOCKS 1200
+#define PERFORMANCE_BLOCKS (PLAYED_SEGMENTS * SEGMENT_BLOCKS + FINAL_SILENCE_BLOCKS)
+#define SIZE_CHANGE_BLOCK (PLAYED_SEGMENTS / 2 * SEGMENT_BLOCKS)
+
+// 0 chords, 2 noise bursts, 1 and 3 silence
+static inline int segment_type(int block)
+{
+  int segment = block / SEGMENT_BLOCKS;
+  return segment < PLAYED_SEGMENTS ? segment % 4 : 1;
+}
+#endif
+
+static inline bool input_silent(int block)
+{
+  return segment_type(block) % 2 == 1;
+}
+
+// blocks since the input became silent, -1 while it plays
+static inline int blocks_since_input(int block)
+{
+  if (!input_silent(block)) return -1;
+  int start = block;
+  while (start > 0 && input_silent(start - 1)) start--;
+  return block - start;
+}
+
+#endif
@@ -0,0 +1,106 @@
+// renders the test performance of reverb_performance.h through the plate reverb
+// writes its stereo output as raw int16, one block of each channel in turn, and reports the update time
+// the kernel and storage switches of effect_platervbstereo.h are given as -D flags by the Makefile
+// REVERB_RENDER_ECONOMY renders in economy mode, REVERB_PERFORMANCE_BURSTS renders the other performance of reverb_performance.h
+#include "effect_platervbstereo.h"
+#include <stdio.h>
+#include <chrono>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "reverb_performance.h"
+
+static uint32_t seed = 1;
+
+static float noise()
+{
+  seed = seed * 1664525u + 1013904223u;
+  return (int32_t)seed / 2147483648.0f;
+}
+
+// input sample n of the performance, +-1.0 full scale
+static float performance(int n)
+{
+  int block = n / AUDIO_BLOCK_SAMPLES;
+#ifdef REVERB_PERFORMANCE_BURSTS
+  float r = noise(); // drawn for every sample, as in the first measurements
+  return segment_type(block) == 4 ? 0.3f * sinf(n * 0.031f) + 0.2f * sinf(n * 0.0473f) + 0.1f * r : 0.0f;
+#else
+  float t = (n % (SEGMENT_BLOCKS * AUDIO_BLOCK_SAMPLES)) / AUDIO_SAMPLE_RATE_EXACT;
+  switch (segment_type(block)) {
+    case 0: {
+      // three chords of four notes, each with a quick attack and a slow decay
+      static const float chords[3][4] = {{261.6f, 329.6f, 392.0f, 493.9f}, {220.0f, 261.6f, 329.6f, 392.0f}, {174.6f, 220.0f, 261.6f, 329.6f}};
+      int chord = (int)(t / 1.2f) % 3;
+      float since = fmodf(t, 1.2f);
+      float envelope = fminf(since * 50.0f, 1.0f) * expf(-since * 2.0f);
+      float s = 0.0f;
+      for (int i = 0; i < 4; i++) s += sinf(2.0f * (float)M_PI * chords[chord][i] * t);
+      return 0.15f * envelope * s;
+    }
+    case 2:
+      // white noise bursts of 50ms every 400ms
+      return fmodf(t, 0.4f) < 0.05f ? 0.5f * noise() : 0.0f;
+    default:
+      return 0.0f;
+  }
+#endif
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s output.raw [blocks]\n", argv[0]);
+    return 2;
+  }
+  int blocks = argc > 2 ? atoi(argv[2]) : PERFORMANCE_BLOCKS;
+  static AudioEffectPlateReverb reverb;
+  static float arena[AudioEffectPlateReverb::memory_size() / sizeof(float) + 1];
+  reverb.begin(arena, sizeof(arena));
+  reverb.size(0.9f);
+  reverb.hidamp(0.2f);
+  reverb.lodamp(0.1f);
+  reverb.lowpass(0.7f);
+  reverb.diffusion(0.65f);
+#ifdef REVERB_RENDER_ECONOMY
+  reverb.economy(true);
+#endif
+  FILE *output = fopen(argv[1], "wb");
+  if (!output) {
+    perror(argv[1]);
+    return 2;
+  }
+  static const int16_t silence[AUDIO_BLOCK_SAMPLES] = {};
+  std::vector<double> times; // of each update that computed a block, the median is steadier than the mean on a busy host
+  for (int b = 0; b < blocks; b++) {
+    audio_block_t *left = AudioStream::allocate(), *right = AudioStream::allocate();
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      float s = performance(b * AUDIO_BLOCK_SAMPLES + i);
+      left->data[i] = (int16_t)(s * 32767.0f);
+      right->data[i] = (int16_t)(s * 0.8f * 32767.0f);
+    }
+    reverb.inputQueue[0] = left;
+    reverb.inputQueue[1] = right;
+    if (b == SIZE_CHANGE_BLOCK) reverb.size(0.5f);
+    auto start = std::chrono::steady_clock::now();
+    reverb.update();
+    double microseconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6;
+    if (reverb.out[0]) times.push_back(microseconds);
+    // an asleep reverb transmits nothing, which is silence
+    for (int c = 0; c < 2; c++) {
+      fwrite(reverb.out[c] ? reverb.out[c]->data : silence, sizeof(int16_t), AUDIO_BLOCK_SAMPLES, output);
+      delete reverb.out[c];
+      reverb.out[c] = nullptr;
+    }
+  }
+  fclose(output);
+  if (AudioStream::memory_used) {
+    fprintf(stderr, "%d audio blocks leaked\n", AudioStream::memory_used);
+    return 1;
+  }
+  double total = 0;
+  for (double t : times) total += t;
+  std::sort(times.begin(), times.end());
+  printf("%s: %d blocks, %d computed, %.2f us per computed update on average, median %.2f us, %u bytes of lines\n", argv[1], blocks, (int)times.size(), total / times.size(), times[times.size() / 2], (unsigned)AudioEffectPlateReverb::memory_size());
+  return 0;
+}
@@ -0,0 +1,145 @@
+// the output filters and delays as prune_audio_sections() suspends and restarts them
+// section_filter running must give the three outputs of voice_filter sample for sample, with a fixed and a modulated corner,
+// suspended it must transmit nothing, and once restarted give the outputs of a filter starting from rest, not the state it was suspended in
+// the feedback delay restarted must fade its tap in: no step between two samples larger than the signal itself makes
+// no block may be left held
+#include "section_filter.h"
+#include "feedback_delay.h"
+#include <stdio.h>
+#include <math.h>
+
+#define BLOCKS 2000
+#define SUSPEND_FROM 800
+#define SUSPEND_TO 1000
+#define DELAY_MAX_MS 600
+
+static uint32_t seed = 11;
+
+static int32_t noise()
+{
+  seed = seed * 1664525u + 1013904223u;
+  return (int32_t)seed >> 20; // +-2048
+}
+
+// a loud chord of sines with noise, and the sine of a filter LFO
+static void input_block(int block, int16_t *data, int16_t *control)
+{
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    long n = (long)block * AUDIO_BLOCK_SAMPLES + i;
+    data[i] = (int16_t)(7000.0f * sinf(n * 0.031f) + 5000.0f * sinf(n * 0.0472f)) + noise();
+    control[i] = (int16_t)(12000.0f * sinf(n * 0.0004f));
+  }
+}
+
+static void setup(section_filter &section, voice_filter &filter)
+{
+  section.frequency(900);
+  section.resonance(3.0f);
+  section.octaveControl(1.5f);
+  filter.frequency(900);
+  filter.resonance(3.0f);
+  filter.octaveControl(1.5f);
+}
+
+static bool check_filter(bool modulated)
+{
+  section_filter section;
+  voice_filter kept_state, restarted;
+  setup(section, kept_state);
+  setup(section, restarted);
+  long differing = 0, transmitted = 0, stale = 0;
+  for (int b = 0; b < BLOCKS; b++) {
+    section.suspend(b >= SUSPEND_FROM && b < SUSPEND_TO);
+    int16_t input[AUDIO_BLOCK_SAMPLES], control[AUDIO_BLOCK_SAMPLES];
+    input_block(b, input, control);
+    section.inputQueue[0] = AudioStream::allocate();
+    memcpy(section.inputQueue[0]->data, input, sizeof(input));
+    if (modulated) {
+      section.inputQueue[1] = AudioStream::allocate();
+      memcpy(section.inputQueue[1]->data, control, sizeof(control));
+    }
+    section.update();
+    // the filter keeping its state over the cut, as an AudioFilterStateVariable reconnected did, and the one starting from rest at the restart
+    int16_t expected[3][AUDIO_BLOCK_SAMPLES], kept[3][AUDIO_BLOCK_SAMPLES];
+    bool suspended = b >= SUSPEND_FROM && b < SUSPEND_TO;
+    if (!suspended) {
+      kept_state.process(input, modulated ? control : nullptr, kept[0], kept[1], kept[2]);
+      restarted.process(input, modulated ? control : nullptr, expected[0], expected[1], expected[2]);
+    }
+    if (b == SUSPEND_FROM) {
+      restarted.reset();
+    }
+    for (int o = 0; o < 3; o++) {
+      if (suspended || !section.out[o]) {
+        transmitted += suspended == (section.out[o] != nullptr);
+      } else {
+        differing += memcmp(expected[o], section.out[o]->data, sizeof(expected[o])) != 0;
+        stale += b >= SUSPEND_TO && memcmp(kept[o], section.out[o]->data, sizeof(kept[o])) != 0;
+      }
+      delete section.out[o];
+      section.out[o] = nullptr;
+    }
+  }
+  printf("section_resume: filter, %s corner, %d blocks, %ld differ from voice_filter, %ld transmitted when they should not or not when they should,"
+         " %ld blocks after the restart differ from the state it was suspended in\n", modulated ? "modulated" : "fixed", BLOCKS, differing, transmitted, stale);
+  return !differing && !transmitted && stale;
+}
+
+// a steady sine with feedback through the loop, set as in delay_loop, the largest step between two samples while running and over the restart
+static bool check_delay()
+{
+  static int16_t memory[feedback_delay::memory_samples(DELAY_MAX_MS)];
+  feedback_delay delay;
+  delay.delay(340);
+  delay.begin(memory, sizeof(memory) / sizeof(memory[0]));
+  delay.filter.frequency(3000);
+  delay.filter.resonance(1.5f);
+  delay.mix.gain(0, 1);
+  delay.mix.gain(1, 0.48f);
+  delay.mix.gain(2, 0.2f);
+  delay.mix.gain(3, 0.1f);
+  int steady_step = 0, restart_step = 0, transmitted = 0;
+  int16_t last = 0;
+  for (int b = 0; b < BLOCKS; b++) {
+    bool suspended = b >= SUSPEND_FROM && b < SUSPEND_TO;
+    delay.suspend(suspended);
+    delay.inputQueue[0] = AudioStream::allocate();
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      delay.inputQueue[0]->data[i] = (int16_t)(6000.0f * sinf((b * AUDIO_BLOCK_SAMPLES + i) * 0.02f));
+    }
+    delay.update();
+    if (suspended) {
+      transmitted += delay.out[0] != nullptr;
+    } else if (delay.out[0]) {
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        int step = abs(delay.out[0]->data[i] - last);
+        last = delay.out[0]->data[i];
+        if (b > 10 && (b != SUSPEND_TO || i > 0)) {
+          int &largest = b < SUSPEND_FROM ? steady_step : restart_step;
+          largest = std::max(largest, step);
+        }
+      }
+    }
+    delete delay.out[0];
+    delay.out[0] = nullptr;
+  }
+  printf("section_resume: delay, largest step between two samples %d running, %d through the restart, %d blocks transmitted suspended\n", steady_step, restart_step, transmitted);
+  return restart_step <= steady_step && !transmitted;
+}
+
+int main()
+{
+  bool passed = check_filter(false);
+  passed &= check_filter(true);
+  passed &= check_delay();
+  if (AudioStream::memory_used) {
+    printf("%d audio blocks leaked\n", AudioStream::memory_used);
+    return 1;
+  }
+  if (!passed) {
+    printf("section_resume: a section does not restart from rest\n");
+    return 1;
+  }
+  printf("section_resume: the suspended filters and delays restart from rest\n");
+  return 0;
+}
@@ -0,0 +1,136 @@
+// time of the harp strings and the four chord voices, rendered then suspended as prune_audio_sections() does for a muted section
+// the strings are strummed over held chords, as in the AUDIO_PRUNING_BENCHMARK build
+// a suspended source must transmit nothing, keep its envelopes running so that released notes end, and sound again once restarted
+#include "chord_voice.h"
+#include "harp_string_bank.h"
+#include "Audio.h"
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#define RUN_BLOCKS 6000
+#define STRUM_BLOCKS 10 // one string every 29ms
+
+static HarpStringBank strings;
+static ChordVoice voices[4];
+
+static void setup()
+{
+  for (int s = 0; s < HARP_STRINGS; s++) {
+    harp_string &string = strings.strings[s];
+    string.oscillator.begin(0.8f, 110.0f * powf(2.0f, s / 12.0f), WAVEFORM_BANDLIMIT_SAWTOOTH);
+    string.envelope.attack(2.0f);
+    string.envelope.decay(800.0f);
+    string.envelope.sustain(0.0f);
+    string.envelope.release(300.0f);
+    string.envelope_filter.attack(1.0f);
+    string.envelope_filter.decay(300.0f);
+    string.envelope_filter.sustain(0.2f);
+    string.filter.frequency(1500.0f);
+    string.filter.resonance(1.2f);
+    string.filter.octaveControl(2.0f);
+    string.transient.begin(0.5f, 2400.0f, WAVEFORM_SINE);
+    string.transient_envelope.attack(0.5f);
+    string.transient_envelope.decay(20.0f);
+    string.transient_envelope.sustain(0.0f);
+  }
+  strings.transient_gain(0.3f);
+  static const float chord[4] = {130.8f, 164.8f, 196.0f, 246.9f};
+  for (int v = 0; v < 4; v++) {
+    ChordVoice &voice = voices[v];
+    voice.osc1.begin(0.5f, chord[v], WAVEFORM_BANDLIMIT_SAWTOOTH);
+    voice.osc2.begin(0.5f, chord[v] * 1.005f, WAVEFORM_BANDLIMIT_SQUARE);
+    voice.osc3.begin(0.3f, chord[v] * 0.5f, WAVEFORM_SINE);
+    voice.noise.amplitude(0.05f);
+    voice.envelope.attack(10.0f);
+    voice.envelope.sustain(1.0f);
+    voice.envelope_filter.sustain(1.0f);
+    voice.filter.frequency(1200.0f);
+    voice.filter.resonance(0.9f);
+    voice.filter.octaveControl(1.5f);
+    voice.envelope.noteOn();
+    voice.envelope_filter.noteOn();
+  }
+}
+
+// one update of the sources, inputs as the shared LFOs and DC objects of the graph would send them
+// returns the time of the updates and counts the blocks transmitted
+static double render(int block, int &transmitted)
+{
+  if (block % STRUM_BLOCKS == 0) {
+    int s = (block / STRUM_BLOCKS) % HARP_STRINGS;
+    strings.strings[s].envelope_filter.noteOn();
+    strings.strings[s].envelope.noteOn();
+    strings.strings[s].transient_envelope.noteOn();
+  }
+  audio_block_t *vibrato = AudioStream::allocate(), *filter_control = AudioStream::allocate();
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    vibrato->data[i] = (int16_t)(800.0f * sinf((block * AUDIO_BLOCK_SAMPLES + i) * 0.0007f));
+    filter_control->data[i] = 16384;
+  }
+  strings.inputQueue[0] = vibrato;
+  strings.inputQueue[1] = filter_control;
+  for (int v = 0; v < 4; v++) {
+    audio_block_t *tremolo = AudioStream::allocate(), *filter_lfo = AudioStream::allocate();
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      tremolo->data[i] = 32767;
+      filter_lfo->data[i] = (int16_t)(8000.0f * sinf((block * AUDIO_BLOCK_SAMPLES + i) * 0.0003f));
+    }
+    voices[v].inputQueue[2] = filter_lfo;
+    voices[v].inputQueue[3] = tremolo;
+  }
+  auto start = std::chrono::steady_clock::now();
+  strings.update();
+  for (int v = 0; v < 4; v++) voices[v].update();
+  double microseconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6;
+  AudioStream *sources[5] = {&strings, &voices[0], &voices[1], &voices[2], &voices[3]};
+  for (AudioStream *source : sources) {
+    if (source->out[0]) transmitted++;
+    delete source->out[0];
+    source->out[0] = nullptr;
+  }
+  return microseconds;
+}
+
+static double run(bool suspended, int &transmitted)
+{
+  strings.suspend(suspended);
+  for (int v = 0; v < 4; v++) voices[v].suspend(suspended);
+  std::vector<double> times;
+  transmitted = 0;
+  for (int b = 0; b < RUN_BLOCKS; b++) times.push_back(render(b, transmitted));
+  std::sort(times.begin(), times.end());
+  return times[times.size() / 2];
+}
+
+int main()
+{
+  setup();
+  int rendered_blocks, suspended_blocks, restarted_blocks;
+  double rendered = run(false, rendered_blocks);
+  double suspended = run(true, suspended_blocks);
+  // the strings struck while suspended are released and must have ended, then the sources restart
+  for (int s = 0; s < HARP_STRINGS; s++) strings.strings[s].envelope.noteOff();
+  strings.suspend(true);
+  for (int b = 0; b < 200; b++) {
+    int ignored = 0;
+    render(1, ignored); // not a strum block
+  }
+  bool released = true;
+  for (int s = 0; s < HARP_STRINGS; s++) released &= !strings.strings[s].envelope.isActive();
+  double restarted = run(false, restarted_blocks);
+  printf("strings and 4 chord voices, %d blocks: rendered %.2f us per update, suspended %.2f us per update (medians)\n", RUN_BLOCKS, rendered, suspended);
+  printf("restarted %.2f us per update, %d blocks transmitted before, %d suspended, %d after\n", restarted, rendered_blocks, suspended_blocks, restarted_blocks);
+  if (AudioStream::memory_used) {
+    printf("%d audio blocks leaked\n", AudioStream::memory_used);
+    return 1;
+  }
+  if (suspended_blocks || !released || restarted_blocks != rendered_blocks) {
+    printf("source_pruning: a suspended source %s\n", suspended_blocks ? "transmitted" : !released ? "kept its released strings sounding" : "did not sound again after the restart");
+    return 1;
+  }
+  printf("source_pruning: the suspended sources transmit nothing and sound again once restarted\n");
+  return 0;
+}
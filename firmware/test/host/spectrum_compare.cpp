@@ -0,0 +1,107 @@
+// compares two renders of reverb_render by their averaged spectra, per third octave band from 50Hz to 16kHz
+// 4096 point Hann frames with half overlap, both channels
+// usage: spectrum_compare reference.raw test.raw [limit_dB] [-v]
+// fails when a band of the test render deviates from the reference by more than the limit, 0.5dB by default
+#include "AudioStream.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <complex>
+#include <vector>
+
+typedef std::complex<double> complex_t;
+
+#define FRAME 4096
+
+static void fft(std::vector<complex_t> &a)
+{
+  int n = a.size();
+  for (int i = 1, j = 0; i < n; i++) {
+    int bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) std::swap(a[i], a[j]);
+  }
+  for (int len = 2; len <= n; len <<= 1) {
+    complex_t w(cos(-2 * M_PI / len), sin(-2 * M_PI / len));
+    for (int i = 0; i < n; i += len) {
+      complex_t wn(1);
+      for (int j = 0; j < len / 2; j++) {
+        complex_t u = a[i + j], v = a[i + j + len / 2] * wn;
+        a[i + j] = u + v;
+        a[i + j + len / 2] = u - v;
+        wn *= w;
+      }
+    }
+  }
+}
+
+// one channel of a render, written a block of each channel in turn
+static std::vector<double> load(const char *path, int channel)
+{
+  std::vector<double> samples;
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    exit(2);
+  }
+  int16_t blocks[2][AUDIO_BLOCK_SAMPLES];
+  while (fread(blocks, sizeof(blocks), 1, f) == 1) {
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) samples.push_back(blocks[channel][i]);
+  }
+  fclose(f);
+  return samples;
+}
+
+static std::vector<double> power_spectrum(const std::vector<double> &x)
+{
+  std::vector<double> power(FRAME / 2);
+  for (size_t start = 0; start + FRAME <= x.size(); start += FRAME / 2) {
+    std::vector<complex_t> frame(FRAME);
+    for (int i = 0; i < FRAME; i++) frame[i] = x[start + i] * (0.5 - 0.5 * cos(2 * M_PI * i / FRAME));
+    fft(frame);
+    for (int k = 0; k < FRAME / 2; k++) power[k] += norm(frame[k]);
+  }
+  return power;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s reference.raw test.raw [limit_dB] [-v]\n", argv[0]);
+    return 2;
+  }
+  double limit = argc > 3 && strcmp(argv[3], "-v") ? atof(argv[3]) : 0.5;
+  bool verbose = !strcmp(argv[argc - 1], "-v");
+  double worst = 0, error = 0, signal = 0;
+  for (int channel = 0; channel < 2; channel++) {
+    std::vector<double> x = load(argv[1], channel), y = load(argv[2], channel);
+    if (x.size() != y.size()) {
+      fprintf(stderr, "the renders have different lengths\n");
+      return 2;
+    }
+    std::vector<double> px = power_spectrum(x), py = power_spectrum(y);
+    for (size_t i = 0; i < x.size(); i++) {
+      signal += x[i] * x[i];
+      error += (x[i] - y[i]) * (x[i] - y[i]);
+    }
+    for (double low = 50; low < 16000; low *= pow(2, 1.0 / 3)) {
+      double high = low * pow(2, 1.0 / 3), ex = 0, ey = 0;
+      for (int k = 0; k < FRAME / 2; k++) {
+        double f = k * AUDIO_SAMPLE_RATE_EXACT / FRAME;
+        if (f >= low && f < high) {
+          ex += px[k];
+          ey += py[k];
+        }
+      }
+      if (ex <= 0 || ey <= 0) continue;
+      double deviation = 10 * log10(ey / ex);
+      worst = fmax(worst, fabs(deviation));
+      if (verbose) printf("channel %d %6.0f Hz %+.3f dB\n", channel, low, deviation);
+    }
+  }
+  printf("largest third octave band deviation: %.3f dB (limit %.2f dB)\n", worst, limit);
+  if (error > 0) printf("waveform difference: %.1f dB below the signal\n", 10 * log10(signal / error));
+  else printf("waveforms identical\n");
+  return worst > limit;
+}
@@ -0,0 +1,72 @@
+// host stand-in for the parts of the Teensy core used by the libraries under test
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <sys/types.h>
+typedef uint8_t byte;
+typedef unsigned int uint;
+#define DMAMEM
+#define FLASHMEM
+#define PROGMEM
+#define FASTRUN
+#define EXTMEM
+#define PI 3.1415926535897932384626433832795
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define F(x) (x)
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+uint32_t millis();
+uint32_t micros();
+inline void delay(uint32_t) {}
+inline void delayMicroseconds(uint32_t) {}
+inline void analogWrite(int, int) {}
+inline void digitalWrite(int, int) {}
+inline int digitalRead(int) { return 0; }
+inline int analogRead(int) { return 0; }
+inline void pinMode(int, int) {}
+inline long random(long n) { return n > 0 ? rand() % n : 0; }
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+using std::min; using std::max;
+template<class T> T map(T x, T in_min, T in_max, T out_min, T out_max) { return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min; }
+inline long map(long x, long a, long b, long c, long d) { return (x - a) * (d - c) / (b - a) + c; }
+class String {
+public:
+  std::string s;
+  String() {}
+  String(const char *c) : s(c) {}
+  String(const std::string &c) : s(c) {}
+  String(int v) : s(std::to_string(v)) {}
+  String(unsigned v) : s(std::to_string(v)) {}
+  String(long v) : s(std::to_string(v)) {}
+  String(unsigned long v) : s(std::to_string(v)) {}
+  String(float v) : s(std::to_string(v)) {}
+  String &operator+=(const String &o) { s += o.s; return *this; }
+  String &operator+=(const char *o) { s += o; return *this; }
+  String &operator+=(char o) { s += o; return *this; }
+  unsigned length() const { return s.size(); }
+  const char *c_str() const { return s.c_str(); }
+  void toCharArray(char *b, unsigned n) const { strncpy(b, s.c_str(), n); if (n) b[n-1] = 0; }
+};
+class Print {
+public:
+  virtual ~Print() {}
+  template<class T> void print(T) {}
+  template<class T> void println(T) {}
+  template<class T, class U> void print(T, U) {}
+  void println() {}
+  template<class... A> void printf(const char *f, A... a) { ::printf(f, a...); }
+};
+class SerialStub : public Print { public: void begin(int) {} operator bool() { return true; } };
+extern SerialStub Serial;
+class elapsedMillis { uint32_t ms; public: elapsedMillis(uint32_t v = 0) { ms = millis() - v; } operator uint32_t() const { return millis() - ms; } elapsedMillis &operator=(uint32_t v) { ms = millis() - v; return *this; } };
+class elapsedMicros { uint32_t us; public: elapsedMicros(uint32_t v = 0) { us = micros() - v; } operator uint32_t() const { return micros() - us; } elapsedMicros &operator=(uint32_t v) { us = micros() - v; return *this; } };
+class IntervalTimer { public: template<class F> bool begin(F, uint32_t) { return true; } void end() {} void update(uint32_t) {} void priority(int) {} };
@@ -0,0 +1,17 @@
+// host stand-in for the Teensy audio library header, only the waveform types and the sine table
+#pragma once
+#include "AudioStream.h"
+#define WAVEFORM_SINE              0
+#define WAVEFORM_SAWTOOTH          1
+#define WAVEFORM_SQUARE            2
+#define WAVEFORM_TRIANGLE          3
+#define WAVEFORM_ARBITRARY         4
+#define WAVEFORM_PULSE             5
+#define WAVEFORM_SAWTOOTH_REVERSE  6
+#define WAVEFORM_SAMPLE_HOLD       7
+#define WAVEFORM_TRIANGLE_VARIABLE 8
+#define WAVEFORM_BANDLIMIT_SAWTOOTH  9
+#define WAVEFORM_BANDLIMIT_SAWTOOTH_REVERSE 10
+#define WAVEFORM_BANDLIMIT_SQUARE 11
+#define WAVEFORM_BANDLIMIT_PULSE 12
+extern "C" const int16_t AudioWaveformSine[257];
@@ -0,0 +1,55 @@
+// host stand-in for AudioStream: there is no graph, a test sets inputQueue directly, calls update() and reads out[]
+#pragma once
+#include "Arduino.h"
+#ifndef AUDIO_BLOCK_SAMPLES
+#define AUDIO_BLOCK_SAMPLES 128
+#endif
+#define AUDIO_SAMPLE_RATE_EXACT 44117.64706f
+#define AUDIO_SAMPLE_RATE AUDIO_SAMPLE_RATE_EXACT
+#ifndef __ARM_ARCH_7EM__
+#define __ARM_ARCH_7EM__ 1
+#endif
+#define STUB_TRANSMITTED 0xEE // ref_count of the copies kept in out[], which release() leaves alone
+
+typedef struct audio_block_struct {
+  uint8_t ref_count;
+  uint8_t reserved1;
+  uint16_t memory_pool_index;
+  int16_t data[AUDIO_BLOCK_SAMPLES];
+} audio_block_t;
+
+class AudioStream {
+public:
+  AudioStream(unsigned char ninput, audio_block_t **iqueue) : num_inputs(ninput), inputQueue(iqueue) {
+    for (int i = 0; i < ninput; i++) iqueue[i] = nullptr;
+  }
+  virtual void update() = 0;
+  // copy of the last block transmitted on each output, kept until the test deletes it
+  audio_block_t *out[8] = {nullptr};
+  unsigned char num_inputs;
+  audio_block_t **inputQueue;
+  bool active = false;
+  static inline int memory_used = 0; // blocks allocated and not released
+  static audio_block_t *allocate() { memory_used++; return new audio_block_t(); }
+  // a block given to inputQueue is owned by the object once received, as with a ref_count of 1
+  static void release(audio_block_t *b) {
+    if (!b || b->ref_count == STUB_TRANSMITTED) return;
+    memory_used--;
+    delete b;
+  }
+  void transmit(audio_block_t *b, unsigned char index = 0) {
+    if (!out[index]) out[index] = new audio_block_t();
+    *out[index] = *b;
+    out[index]->ref_count = STUB_TRANSMITTED;
+  }
+  audio_block_t *receiveReadOnly(unsigned int index = 0) {
+    audio_block_t *b = inputQueue[index];
+    inputQueue[index] = nullptr;
+    return b;
+  }
+  audio_block_t *receiveWritable(unsigned int index = 0) { return receiveReadOnly(index); }
+  float processorUsage() { return 0; }
+};
+#define AudioNoInterrupts()
+#define AudioInterrupts()
+#define AudioMemoryUsage() (AudioStream::memory_used)
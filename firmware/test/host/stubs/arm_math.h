@@ -0,0 +1,6 @@
+// host stand-in for the CMSIS conversions used by the libraries under test
+#pragma once
+#include <stdint.h>
+typedef float float32_t; typedef int16_t q15_t; typedef int32_t q31_t;
+inline void arm_q15_to_float(const q15_t *s, float32_t *d, uint32_t n) { for (uint32_t i=0;i<n;i++) d[i]=(float32_t)s[i]/32768.0f; }
+inline void arm_float_to_q15(const float32_t *s, q15_t *d, uint32_t n) { for (uint32_t i=0;i<n;i++){ float v=s[i]*32768.0f; v = v>32767?32767:(v<-32768?-32768:v); d[i]=(q15_t)v; } }
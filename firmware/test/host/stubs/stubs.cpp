@@ -0,0 +1,7 @@
+// definitions of the host stand-ins of Arduino.h
+#include "Arduino.h"
+#include <chrono>
+SerialStub Serial;
+static auto t0 = std::chrono::steady_clock::now();
+uint32_t millis() { return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count(); }
+uint32_t micros() { return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count(); }
@@ -0,0 +1,36 @@
+// host versions of the DSP instructions of the Teensy audio library, same results as the Cortex-M7 ones
+// the ones after the first block are only used by the library sources built by the library_equivalence target
+#pragma once
+#include <stdint.h>
+static inline int32_t signed_saturate_rshift(int32_t val, int bits, int rshift) { int32_t out, max; out = val >> rshift; max = 1 << (bits - 1); if (out >= 0) { if (out > max - 1) out = max - 1; } else { if (out < -max) out = -max; } return out; }
+static inline int32_t multiply_32x32_rshift32(int32_t a, int32_t b) { return ((int64_t)a * (int64_t)b) >> 32; }
+static inline int32_t multiply_32x32_rshift32_rounded(int32_t a, int32_t b) { return (((int64_t)a * (int64_t)b) + 0x80000000LL) >> 32; }
+static inline int32_t signed_multiply_32x16b(int32_t a, uint32_t b) { return ((int64_t)a * (int16_t)(b & 0xFFFF)) >> 16; }
+static inline int32_t signed_multiply_32x16t(int32_t a, uint32_t b) { return ((int64_t)a * (int16_t)(b >> 16)) >> 16; }
+static inline uint32_t pack_16b_16b(int32_t a, int32_t b) { return ((uint32_t)a << 16) | ((uint32_t)b & 0xFFFF); }
+static inline uint32_t signed_add_16_and_16(uint32_t a, uint32_t b) {
+  int32_t lo = (int16_t)(a & 0xFFFF) + (int16_t)(b & 0xFFFF); int32_t hi = (int16_t)(a >> 16) + (int16_t)(b >> 16);
+  lo = lo > 32767 ? 32767 : lo < -32768 ? -32768 : lo; hi = hi > 32767 ? 32767 : hi < -32768 ? -32768 : hi;
+  return ((uint32_t)hi << 16) | ((uint32_t)lo & 0xFFFF); }
+
+static inline int32_t multiply_accumulate_32x32_rshift32_rounded(int32_t sum, int32_t a, int32_t b) { return (int32_t)((((int64_t)sum << 32) + (int64_t)a * b + 0x80000000LL) >> 32); }
+static inline int32_t multiply_subtract_32x32_rshift32_rounded(int32_t sum, int32_t a, int32_t b) { return (int32_t)((((int64_t)sum << 32) - (int64_t)a * b + 0x80000000LL) >> 32); }
+static inline int32_t signed_multiply_accumulate_32x16b(int32_t sum, int32_t a, uint32_t b) { return sum + (int32_t)(((int64_t)a * (int16_t)(b & 0xFFFF)) >> 16); }
+static inline int32_t signed_multiply_accumulate_32x16t(int32_t sum, int32_t a, uint32_t b) { return sum + (int32_t)(((int64_t)a * (int16_t)(b >> 16)) >> 16); }
+static inline uint32_t pack_16t_16t(int32_t a, int32_t b) { return ((uint32_t)a & 0xFFFF0000) | ((uint32_t)b >> 16); }
+static inline uint32_t pack_16t_16b(int32_t a, int32_t b) { return ((uint32_t)a & 0xFFFF0000) | ((uint32_t)b & 0xFFFF); }
+static inline uint32_t signed_subtract_16_and_16(uint32_t a, uint32_t b) {
+  int32_t lo = (int16_t)(a & 0xFFFF) - (int16_t)(b & 0xFFFF); int32_t hi = (int16_t)(a >> 16) - (int16_t)(b >> 16);
+  lo = lo > 32767 ? 32767 : lo < -32768 ? -32768 : lo; hi = hi > 32767 ? 32767 : hi < -32768 ? -32768 : hi;
+  return ((uint32_t)hi << 16) | ((uint32_t)lo & 0xFFFF); }
+static inline int32_t signed_halving_add_16_and_16(int32_t a, int32_t b) { return (int32_t)pack_16b_16b(((int16_t)(a >> 16) + (int16_t)(b >> 16)) >> 1, ((int16_t)a + (int16_t)b) >> 1); }
+static inline int32_t signed_halving_subtract_16_and_16(int32_t a, int32_t b) { return (int32_t)pack_16b_16b(((int16_t)(a >> 16) - (int16_t)(b >> 16)) >> 1, ((int16_t)a - (int16_t)b) >> 1); }
+static inline int32_t multiply_16bx16b(uint32_t a, uint32_t b) { return (int16_t)a * (int16_t)b; }
+static inline int32_t multiply_16bx16t(uint32_t a, uint32_t b) { return (int16_t)a * (int16_t)(b >> 16); }
+static inline int32_t multiply_16tx16b(uint32_t a, uint32_t b) { return (int16_t)(a >> 16) * (int16_t)b; }
+static inline int32_t multiply_16tx16t(uint32_t a, uint32_t b) { return (int16_t)(a >> 16) * (int16_t)(b >> 16); }
+static inline int32_t multiply_16tx16t_add_16bx16b(uint32_t a, uint32_t b) { return multiply_16tx16t(a, b) + multiply_16bx16b(a, b); }
+static inline int32_t multiply_16tx16b_add_16bx16t(uint32_t a, uint32_t b) { return multiply_16tx16b(a, b) + multiply_16bx16t(a, b); }
+static inline uint32_t logical_and(uint32_t a, uint32_t b) { return a & b; }
+static inline int32_t substract_32_saturate(int32_t a, int32_t b) { int64_t d = (int64_t)a - b; return d > INT32_MAX ? INT32_MAX : d < INT32_MIN ? INT32_MIN : (int32_t)d; }
+static inline int32_t substract_int32_then_divide_int32(int32_t a, int32_t b, int32_t c) { return (int32_t)((uint32_t)a - (uint32_t)b) / c; }
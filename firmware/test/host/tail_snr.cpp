@@ -0,0 +1,64 @@
+// signal to noise ratio of a render of reverb_render against a reference render of the same performance
+// over the whole render, over the tails (input silent) and over the late tails (from 100 blocks after the input stopped)
+// usage: tail_snr reference.raw test.raw [tail_minimum_dB [late_tail_minimum_dB]]
+// fails when the tail SNR or the late tail SNR is below its minimum, if one is given,
+// the whole render is dominated by the loud parts where the storage noise is masked anyway
+#include "AudioStream.h"
+#include "reverb_performance.h"
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#define LATE_TAIL_BLOCKS 100
+
+struct snr_sum {
+  double signal = 0;
+  double error = 0;
+  void add(int16_t reference, int16_t test)
+  {
+    signal += (double)reference * reference;
+    error += (double)(reference - test) * (reference - test);
+  }
+  double db() { return error > 0 ? 10 * log10(signal / error) : INFINITY; }
+};
+
+static std::vector<int16_t> load(const char *path)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    exit(2);
+  }
+  std::vector<int16_t> samples;
+  int16_t block[2 * AUDIO_BLOCK_SAMPLES];
+  while (fread(block, sizeof(block), 1, f) == 1) samples.insert(samples.end(), block, block + 2 * AUDIO_BLOCK_SAMPLES);
+  fclose(f);
+  return samples;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s reference.raw test.raw [tail_minimum_dB [late_tail_minimum_dB]]\n", argv[0]);
+    return 2;
+  }
+  std::vector<int16_t> reference = load(argv[1]), test = load(argv[2]);
+  if (reference.size() != test.size()) {
+    fprintf(stderr, "the renders have different lengths\n");
+    return 2;
+  }
+  snr_sum whole, tail, late_tail;
+  int blocks = reference.size() / (2 * AUDIO_BLOCK_SAMPLES);
+  for (int b = 0; b < blocks; b++) {
+    int since = blocks_since_input(b);
+    for (int i = b * 2 * AUDIO_BLOCK_SAMPLES; i < (b + 1) * 2 * AUDIO_BLOCK_SAMPLES; i++) {
+      whole.add(reference[i], test[i]);
+      if (since >= 0) tail.add(reference[i], test[i]);
+      if (since >= LATE_TAIL_BLOCKS) late_tail.add(reference[i], test[i]);
+    }
+  }
+  printf("%s against %s: whole render SNR %.1f dB, tail SNR %.1f dB, late tail SNR %.1f dB\n", argv[2], argv[1], whole.db(), tail.db(), late_tail.db());
+  bool failed = (argc > 3 && tail.db() < atof(argv[3])) || (argc > 4 && late_tail.db() < atof(argv[4]));
+  if (failed) printf("tail_snr: below the minimum of %s dB for the tail, %s dB for the late tail\n", argv[3], argc > 4 ? argv[4] : "no minimum");
+  return failed;
+}